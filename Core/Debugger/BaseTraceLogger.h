@@ -14,6 +14,8 @@
 #include "Debugger/ExpressionEvaluator.h"
 #include "Debugger/TraceLogFileSaver.h"
 #include "Utilities/HexUtilities.h"
+#include "Utilities/MemoryMappedFile.h"
+#include "Utilities/FolderUtilities.h"
 #include "Shared/Emulator.h"
 #include "Shared/EmuSettings.h"
 
@@ -102,6 +104,14 @@ struct TraceLogPpuState
 	uint32_t FrameCount;
 };
 
+//Effective address and memory value, captured when the row is logged (used when the row is formatted later)
+struct TraceLogMemoryState
+{
+	bool Captured;
+	EffectiveAddressInfo EffectiveAddress;
+	uint16_t MemoryValue;
+};
+
 struct RowPart
 {
 	RowDataType DataType;
@@ -114,7 +124,17 @@ template<typename TraceLoggerType, typename CpuStateType>
 class BaseTraceLogger : public ITraceLogger
 {
 protected:
-	static constexpr int ExecutionLogSize = 30000;
+	//Default number of rows kept in memory - larger history sizes are stored in a memory-mapped file
+	static constexpr uint32_t ExecutionLogSize = 30000;
+
+	//Binary row sent to the TraceLogFileSaver, formatted to text on its thread
+	struct FileRecord
+	{
+		CpuStateType CpuState;
+		TraceLogPpuState PpuState;
+		DisassemblyInfo Disassembly;
+		TraceLogMemoryState MemoryState;
+	};
 
 	TraceLoggerOptions _options;
 	IConsole* _console;
@@ -127,18 +147,27 @@ protected:
 	MemoryType _cpuMemoryType = MemoryType::SnesMemory;
 
 	vector<RowPart> _rowParts;
+	bool _captureMemoryState = false;
 
 	uint32_t _currentPos = 0;
+	uint32_t _logSize = 0;
+	uint32_t _rowCount = 0;
 
 	bool _pendingLog = false;
 	CpuStateType _lastState = {};
 	DisassemblyInfo _lastDisassemblyInfo = {};
 
+	//All 4 arrays point to either _heapBuffer or _mappedFile.
+	//The row IDs are kept in a separate array to act as an index - finding a row by ID only
+	//needs to binary search the IDs, without touching the (much larger) state arrays.
 	CpuStateType* _cpuState = nullptr;
 	DisassemblyInfo *_disassemblyCache = nullptr;
 	uint64_t* _rowIds = nullptr;
 	TraceLogPpuState* _ppuState = nullptr;
 
+	vector<uint8_t> _heapBuffer;
+	MemoryMappedFile _mappedFile;
+
 	unique_ptr<ExpressionEvaluator> _expEvaluator;
 	ExpressionData _conditionData;
 
@@ -171,9 +200,9 @@ protected:
 		}
 	}
 	
-	void WriteEffectiveAddress(DisassemblyInfo& info, RowPart& rowPart, void* cpuState, string& output, MemoryType cpuMemoryType, CpuType cpuType)
+	void WriteEffectiveAddress(DisassemblyInfo& info, RowPart& rowPart, void* cpuState, string& output, MemoryType cpuMemoryType, CpuType cpuType, TraceLogMemoryState* memState)
 	{
-		EffectiveAddressInfo effectiveAddress = info.GetEffectiveAddress(_debugger, cpuState, cpuType);
+		EffectiveAddressInfo effectiveAddress = memState && memState->Captured ? memState->EffectiveAddress : info.GetEffectiveAddress(_debugger, cpuState, cpuType);
 		if(effectiveAddress.ShowAddress && effectiveAddress.Address >= 0) {
 			if(_options.UseLabels) {
 				AddressInfo addr { effectiveAddress.Address, cpuMemoryType };
@@ -188,11 +217,12 @@ protected:
 		}
 	}
 
-	void WriteMemoryValue(DisassemblyInfo& info, RowPart& rowPart, void* cpuState, string& output, MemoryType memType, CpuType cpuType)
+	void WriteMemoryValue(DisassemblyInfo& info, RowPart& rowPart, void* cpuState, string& output, MemoryType memType, CpuType cpuType, TraceLogMemoryState* memState)
 	{
-		EffectiveAddressInfo effectiveAddress = info.GetEffectiveAddress(_debugger, cpuState, cpuType);
+		bool captured = memState && memState->Captured;
+		EffectiveAddressInfo effectiveAddress = captured ? memState->EffectiveAddress : info.GetEffectiveAddress(_debugger, cpuState, cpuType);
 		if(effectiveAddress.Address >= 0 && effectiveAddress.ValueSize > 0) {
-			uint16_t value = info.GetMemoryValue(effectiveAddress, _memoryDumper, memType);
+			uint16_t value = captured ? memState->MemoryValue : info.GetMemoryValue(effectiveAddress, _memoryDumper, memType);
 			if(rowPart.DisplayInHex) {
 				output += "= $";
 				if(effectiveAddress.ValueSize == 2) {
@@ -264,27 +294,83 @@ protected:
 
 		_pendingLog = false;
 
-		if(_debugger->GetTraceLogFileSaver()->IsEnabled()) {
-			string row;
-			row.reserve(300);
-			
-			//Display PC
-			RowPart rowPart = {};
-			rowPart.DisplayInHex = true;
-			rowPart.MinWidth = DebugUtilities::GetProgramCounterSize(_cpuType);
-			WriteIntValue(row, ((TraceLoggerType*)this)->GetProgramCounter(cpuState), rowPart);
-			row += "  ";
-
-			((TraceLoggerType*)this)->GetTraceRow(row, cpuState, _ppuState[_currentPos], disassemblyInfo);
-			_debugger->GetTraceLogFileSaver()->Log(row);
+		TraceLogFileSaver* fileSaver = _debugger->GetTraceLogFileSaver();
+		if(fileSaver->IsEnabled()) {
+			//Only copy the row's data here, it is converted to text on the file saver's thread
+			FileRecord record;
+			record.CpuState = cpuState;
+			record.PpuState = _ppuState[_currentPos];
+			record.Disassembly = disassemblyInfo;
+			record.MemoryState = {};
+			if(_captureMemoryState) {
+				//Memory may have changed by the time the row is formatted, read the values now
+				TraceLogMemoryState& memState = record.MemoryState;
+				memState.Captured = true;
+				memState.EffectiveAddress = disassemblyInfo.GetEffectiveAddress(_debugger, &cpuState, _cpuType);
+				if(memState.EffectiveAddress.Address >= 0 && memState.EffectiveAddress.ValueSize > 0) {
+					memState.MemoryValue = disassemblyInfo.GetMemoryValue(memState.EffectiveAddress, _memoryDumper, _cpuMemoryType);
+				}
+			}
+			fileSaver->Log(this, &record, sizeof(record));
+		}
+
+		_currentPos = (_currentPos + 1) % _logSize;
+		if(_rowCount < _logSize) {
+			_rowCount++;
 		}
+	}
 
-		_currentPos = (_currentPos + 1) % ExecutionLogSize;
+	__forceinline uint32_t GetIndex(uint32_t offset)
+	{
+		return (uint32_t)(((uint64_t)_currentPos + _logSize - 1 - offset) % _logSize);
+	}
+
+	void AllocateBuffers(uint32_t size)
+	{
+		size = std::max(size, BaseTraceLogger::ExecutionLogSize);
+		if(size == _logSize) {
+			return;
+		}
+
+		auto align = [](size_t size) { return (size + 63) & ~(size_t)63; };
+		size_t rowIdSize = align(sizeof(uint64_t) * size);
+		size_t ppuStateSize = align(sizeof(TraceLogPpuState) * size);
+		size_t disassemblySize = align(sizeof(DisassemblyInfo) * size);
+		size_t cpuStateSize = align(sizeof(CpuStateType) * size);
+		size_t totalSize = rowIdSize + ppuStateSize + disassemblySize + cpuStateSize;
+
+		_mappedFile.Close();
+		_heapBuffer = vector<uint8_t>();
+
+		uint8_t* buffer = nullptr;
+		if(size > BaseTraceLogger::ExecutionLogSize) {
+			string filename = "TraceLog_" + std::to_string((int)_cpuType) + ".tmp";
+			if(_mappedFile.Open(FolderUtilities::CombinePath(FolderUtilities::GetDebuggerFolder(), filename), totalSize)) {
+				buffer = _mappedFile.GetData();
+			} else {
+				_debugger->Log("[Trace Logger] Could not create a " + std::to_string(totalSize / (1024 * 1024)) + " MB trace log file, using the default size instead.");
+				return AllocateBuffers(BaseTraceLogger::ExecutionLogSize);
+			}
+		} else {
+			_heapBuffer.resize(totalSize, 0);
+			buffer = _heapBuffer.data();
+		}
+
+		_rowIds = (uint64_t*)buffer;
+		_ppuState = (TraceLogPpuState*)(buffer + rowIdSize);
+		_disassemblyCache = (DisassemblyInfo*)(buffer + rowIdSize + ppuStateSize);
+		_cpuState = (CpuStateType*)(buffer + rowIdSize + ppuStateSize + disassemblySize);
+
+		_logSize = size;
+		_currentPos = 0;
+		_rowCount = 0;
+		_pendingLog = false;
 	}
 
 	void ParseFormatString(string format)
 	{
 		_rowParts.clear();
+		_captureMemoryState = false;
 
 		std::regex formatRegex = std::regex("(\\[\\s*([^[]*?)\\s*(,\\s*([\\d]*)\\s*(h){0,1}){0,1}\\s*\\])|([^[]*)", std::regex_constants::icase);
 		std::sregex_iterator start = std::sregex_iterator(format.cbegin(), format.cend(), formatRegex);
@@ -314,6 +400,9 @@ protected:
 					}
 				}
 				part.DisplayInHex = match.str(5) == "h";
+				if(part.DataType == RowDataType::EffectiveAddress || part.DataType == RowDataType::MemoryValue) {
+					_captureMemoryState = true;
+				}
 
 				_rowParts.push_back(part);
 			}
@@ -351,14 +440,14 @@ protected:
 
 	virtual RowDataType GetFormatTagType(string& tag) = 0;
 
-	void ProcessSharedTag(RowPart& rowPart, string& output, CpuStateType& cpuState, TraceLogPpuState& ppuState, DisassemblyInfo& disassemblyInfo)
+	void ProcessSharedTag(RowPart& rowPart, string& output, CpuStateType& cpuState, TraceLogPpuState& ppuState, DisassemblyInfo& disassemblyInfo, TraceLogMemoryState* memState)
 	{
 		switch(rowPart.DataType) {
 			case RowDataType::Text: output += rowPart.Text; break;
 			case RowDataType::ByteCode: WriteByteCode(disassemblyInfo, rowPart, output); break;
 			case RowDataType::Disassembly: WriteDisassembly(disassemblyInfo, rowPart, ((TraceLoggerType*)this)->GetStackPointer(cpuState), ((TraceLoggerType*)this)->GetProgramCounter(cpuState), output); break;
-			case RowDataType::EffectiveAddress: WriteEffectiveAddress(disassemblyInfo, rowPart, &cpuState, output, _cpuMemoryType, _cpuType); break;
-			case RowDataType::MemoryValue: WriteMemoryValue(disassemblyInfo, rowPart, &cpuState, output, _cpuMemoryType, _cpuType); break;
+			case RowDataType::EffectiveAddress: WriteEffectiveAddress(disassemblyInfo, rowPart, &cpuState, output, _cpuMemoryType, _cpuType, memState); break;
+			case RowDataType::MemoryValue: WriteMemoryValue(disassemblyInfo, rowPart, &cpuState, output, _cpuMemoryType, _cpuType, memState); break;
 			case RowDataType::Align: WriteAlign(0, rowPart, output); break;
 
 			case RowDataType::Cycle: WriteIntValue(output, ppuState.Cycle, rowPart); break;
@@ -383,35 +472,22 @@ public:
 		_currentPos = 0;
 		_pendingLog = false;
 
-		_disassemblyCache = new DisassemblyInfo[BaseTraceLogger::ExecutionLogSize];
-		_rowIds = new uint64_t[BaseTraceLogger::ExecutionLogSize];
-		memset(_disassemblyCache, 0, sizeof(DisassemblyInfo) * BaseTraceLogger::ExecutionLogSize);
-		memset(_rowIds, 0, sizeof(uint64_t) * BaseTraceLogger::ExecutionLogSize);
-
-		_ppuState = new TraceLogPpuState[BaseTraceLogger::ExecutionLogSize];
-		memset(_ppuState, 0, sizeof(TraceLogPpuState) * BaseTraceLogger::ExecutionLogSize);
-
-		_cpuState = new CpuStateType[BaseTraceLogger::ExecutionLogSize];
-		memset(_cpuState, 0, sizeof(CpuStateType) * BaseTraceLogger::ExecutionLogSize);
-
 		_cpuType = cpuType;
 		_cpuMemoryType = DebugUtilities::GetCpuMemoryType(cpuType);
 
+		AllocateBuffers(BaseTraceLogger::ExecutionLogSize);
+
 		_expEvaluator.reset(new ExpressionEvaluator(debugger, cpuDebugger, cpuType));
 	}
 
 	virtual ~BaseTraceLogger()
 	{
-		delete[] _disassemblyCache;
-		delete[] _rowIds;
-		delete[] _ppuState;
-		delete[] _cpuState;
 	}
 
 	void Clear() override
 	{
 		_currentPos = 0;
-		memset(_rowIds, 0, sizeof(uint64_t) * BaseTraceLogger::ExecutionLogSize);
+		_rowCount = 0;
 	}
 
 	void LogNonExec(MemoryOperationInfo& operation, AddressInfo& addressInfo)
@@ -446,9 +522,15 @@ public:
 	void SetOptions(TraceLoggerOptions options) override
 	{
 		DebugBreakHelper helper(_debugger);
+
+		//Rows that were already logged to the file must be formatted with the previous options
+		_debugger->GetTraceLogFileSaver()->WaitForFormatting();
+
 		_options = options;
 
 		_enabled = options.Enabled;
+		//Only map the (potentially multi-GB) history file for the loggers that are actually enabled
+		AllocateBuffers(options.Enabled ? options.HistorySize : BaseTraceLogger::ExecutionLogSize);
 
 		string condition = _options.Condition;
 		string format = _options.Format;
@@ -469,12 +551,40 @@ public:
 
 	int64_t GetRowId(uint32_t offset) override
 	{
-		int32_t pos = ((int32_t)_currentPos - (int32_t)offset);
-		int32_t i = (pos > 0 ? pos : BaseTraceLogger::ExecutionLogSize + pos) - 1;
-		if(!_disassemblyCache[i].IsInitialized()) {
+		if(offset >= _rowCount) {
 			return -1;
 		}
-		return _rowIds[i];
+		return _rowIds[GetIndex(offset)];
+	}
+
+	int64_t FindOffset(int64_t rowId) override
+	{
+		//Row IDs increase as rows are added (they decrease as the offset increases), binary search for the first row with an ID <= rowId
+		if(_rowCount == 0 || (int64_t)_rowIds[GetIndex(_rowCount - 1)] > rowId) {
+			return -1;
+		}
+
+		uint32_t start = 0;
+		uint32_t end = _rowCount - 1;
+		while(start < end) {
+			uint32_t mid = start + (end - start) / 2;
+			if((int64_t)_rowIds[GetIndex(mid)] <= rowId) {
+				end = mid;
+			} else {
+				start = mid + 1;
+			}
+		}
+		return start;
+	}
+
+	uint32_t GetRowCount() override
+	{
+		return _rowCount;
+	}
+
+	bool IsFull() override
+	{
+		return _rowCount == _logSize;
 	}
 
 	bool ConditionMatches(DisassemblyInfo &disassemblyInfo, MemoryOperationInfo &operationInfo, AddressInfo& addressInfo)
@@ -488,10 +598,25 @@ public:
 		return true;
 	}
 
+	void FormatFileRecord(uint8_t* data, string& output) override
+	{
+		FileRecord record;
+		memcpy(&record, data, sizeof(record));
+
+		//Display PC
+		RowPart rowPart = {};
+		rowPart.DisplayInHex = true;
+		rowPart.MinWidth = DebugUtilities::GetProgramCounterSize(_cpuType);
+		WriteIntValue(output, ((TraceLoggerType*)this)->GetProgramCounter(record.CpuState), rowPart);
+		output += "  ";
+
+		((TraceLoggerType*)this)->GetTraceRow(output, record.CpuState, record.PpuState, record.Disassembly, &record.MemoryState);
+		output += '\n';
+	}
+
 	void GetExecutionTrace(TraceRow& row, uint32_t offset) override
 	{
-		int pos = ((int)_currentPos - offset);
-		int index = (pos > 0 ? pos : BaseTraceLogger::ExecutionLogSize + pos) - 1;
+		uint32_t index = GetIndex(offset);
 
 		CpuStateType& state = _cpuState[index];
 		string logOutput;
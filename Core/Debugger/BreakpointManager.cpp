@@ -25,6 +25,9 @@ void BreakpointManager::SetBreakpoints(Breakpoint breakpoints[], uint32_t count)
 		_breakpoints[i].clear();
 		_rpnList[i].clear();
 		_hasBreakpointType[i] = false;
+		for(int j = 0; j < BreakpointManager::MemoryTypeCount; j++) {
+			_index[i][j] = {};
+		}
 	}
 
 	_bpExpEval.reset(new ExpressionEvaluator(_debugger, _cpuDebugger, _cpuType));
@@ -39,6 +42,7 @@ void BreakpointManager::SetBreakpoints(Breakpoint breakpoints[], uint32_t count)
 					continue;
 				}
 
+				AddToIndex(_index[i][(int)bp.GetMemoryType()], bp, (uint32_t)_breakpoints[i].size());
 				_breakpoints[i].push_back(bp);
 
 				if(bp.HasCondition()) {
@@ -56,6 +60,37 @@ void BreakpointManager::SetBreakpoints(Breakpoint breakpoints[], uint32_t count)
 	}
 }
 
+void BreakpointManager::AddToIndex(BreakpointAddressIndex& index, Breakpoint& bp, uint32_t bpIndex)
+{
+	index.Breakpoints.push_back(bpIndex);
+
+	if(bp.GetEndAddress() > BreakpointManager::MaxIndexedAddress) {
+		index.HasUnindexedRange = true;
+	}
+
+	int32_t start = std::max(0, bp.GetStartAddress());
+	int32_t end = std::min(BreakpointManager::MaxIndexedAddress, bp.GetEndAddress());
+	if(start > end) {
+		return;
+	}
+
+	vector<uint64_t>& bitmap = index.AddressBitmap;
+	if(bitmap.size() <= (size_t)(end >> 6)) {
+		bitmap.resize((end >> 6) + 1, 0);
+	}
+
+	for(int32_t addr = start; addr <= end;) {
+		if((addr & 0x3F) == 0 && end - addr >= 63) {
+			//Fill whole words at once for large ranges
+			bitmap[addr >> 6] = ~0ULL;
+			addr += 64;
+		} else {
+			bitmap[addr >> 6] |= 1ULL << (addr & 0x3F);
+			addr++;
+		}
+	}
+}
+
 BreakpointType BreakpointManager::GetBreakpointType(MemoryOperationType type)
 {
 	switch(type) {
@@ -79,13 +114,30 @@ BreakpointType BreakpointManager::GetBreakpointType(MemoryOperationType type)
 	}
 }
 
-int BreakpointManager::InternalCheckBreakpoint(MemoryOperationInfo operationInfo, AddressInfo &address, bool processMarkedBreakpoints)
+int BreakpointManager::InternalCheckBreakpoint(MemoryOperationInfo operationInfo, AddressInfo &address, bool processMarkedBreakpoints, bool checkRelative, bool checkAbsolute)
 {
 	EvalResultType resultType;
-	vector<Breakpoint> &breakpoints = _breakpoints[(int)operationInfo.Type];
-	for(size_t i = 0, len = breakpoints.size(); i < len; i++) {
+	int opType = (int)operationInfo.Type;
+	vector<Breakpoint> &breakpoints = _breakpoints[opType];
+
+	//Only the breakpoints for the relative and absolute memory types of this access can match -
+	//merge both lists to process the breakpoints in the same order as they were defined in
+	static const vector<uint32_t> emptyList;
+	const vector<uint32_t>& relList = checkRelative ? _index[opType][(int)operationInfo.MemType].Breakpoints : emptyList;
+	const vector<uint32_t>& absList = checkAbsolute ? _index[opType][(int)address.Type].Breakpoints : emptyList;
+	size_t relPos = 0;
+	size_t absPos = 0;
+
+	while(relPos < relList.size() || absPos < absList.size()) {
+		uint32_t i;
+		if(absPos >= absList.size() || (relPos < relList.size() && relList[relPos] < absList[absPos])) {
+			i = relList[relPos++];
+		} else {
+			i = absList[absPos++];
+		}
+
 		if(breakpoints[i].Matches(operationInfo, address)) {
-			if(breakpoints[i].HasCondition() && !_bpExpEval->Evaluate(_rpnList[(int)operationInfo.Type][i], resultType, operationInfo, address)) {
+			if(breakpoints[i].HasCondition() && !_bpExpEval->Evaluate(_rpnList[opType][i], resultType, operationInfo, address)) {
 				continue;
 			}
 
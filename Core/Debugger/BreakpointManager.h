@@ -3,6 +3,7 @@
 #include "Debugger/Breakpoint.h"
 #include "Debugger/DebugTypes.h"
 #include "Debugger/DebugUtilities.h"
+#include "Shared/MemoryType.h"
 
 class ExpressionEvaluator;
 class Debugger;
@@ -11,10 +12,24 @@ class BaseEventManager;
 struct ExpressionData;
 enum class MemoryOperationType;
 
+struct BreakpointAddressIndex
+{
+	//1 bit per address, set when at least one breakpoint's range contains the address
+	vector<uint64_t> AddressBitmap;
+
+	//Set when a breakpoint's range goes past MaxIndexedAddress - addresses above it are not in the bitmap
+	bool HasUnindexedRange = false;
+
+	//Indexes (in _breakpoints) of the breakpoints for this memory type, in their original order
+	vector<uint32_t> Breakpoints;
+};
+
 class BreakpointManager
 {
 private:
 	static constexpr int BreakpointTypeCount = (int)MemoryOperationType::PpuRenderingRead + 1;
+	static constexpr int MemoryTypeCount = (int)MemoryType::None + 1;
+	static constexpr int32_t MaxIndexedAddress = 0xFFFFFF;
 
 	Debugger* _debugger;
 	IDebugger *_cpuDebugger;
@@ -25,11 +40,15 @@ private:
 	vector<ExpressionData> _rpnList[BreakpointTypeCount];
 	bool _hasBreakpoint;
 	bool _hasBreakpointType[BreakpointTypeCount] = {};
+	BreakpointAddressIndex _index[BreakpointTypeCount][MemoryTypeCount];
 
 	unique_ptr<ExpressionEvaluator> _bpExpEval;
 
 	BreakpointType GetBreakpointType(MemoryOperationType type);
-	int InternalCheckBreakpoint(MemoryOperationInfo operationInfo, AddressInfo &address, bool processMarkedBreakpoints);
+	void AddToIndex(BreakpointAddressIndex& index, Breakpoint& bp, uint32_t bpIndex);
+	int InternalCheckBreakpoint(MemoryOperationInfo operationInfo, AddressInfo &address, bool processMarkedBreakpoints, bool checkRelative, bool checkAbsolute);
+
+	__forceinline bool IsAddressIndexed(int opType, MemoryType memType, int32_t address);
 
 public:
 	BreakpointManager(Debugger *debugger, IDebugger* cpuDebugger, CpuType cpuType, BaseEventManager* eventManager);
@@ -46,10 +65,32 @@ __forceinline bool BreakpointManager::HasBreakpointForType(MemoryOperationType o
 	return _hasBreakpointType[(int)opType];
 }
 
+__forceinline bool BreakpointManager::IsAddressIndexed(int opType, MemoryType memType, int32_t address)
+{
+	BreakpointAddressIndex& index = _index[opType][(int)memType];
+	if(address > BreakpointManager::MaxIndexedAddress) {
+		//Let the breakpoints themselves check addresses that are too large for the bitmap
+		return index.HasUnindexedRange;
+	}
+
+	vector<uint64_t>& bitmap = index.AddressBitmap;
+	uint32_t word = (uint32_t)address >> 6;
+	return address >= 0 && word < bitmap.size() && (bitmap[word] & (1ULL << (address & 0x3F)));
+}
+
 __forceinline int BreakpointManager::CheckBreakpoint(MemoryOperationInfo operationInfo, AddressInfo &address, bool processMarkedBreakpoints)
 {
-	if(!_hasBreakpointType[(int)operationInfo.Type]) {
+	int opType = (int)operationInfo.Type;
+	if(!_hasBreakpointType[opType]) {
 		return -1;
 	}
-	return InternalCheckBreakpoint(operationInfo, address, processMarkedBreakpoints);
+
+	//Only look at the breakpoints when the address is covered by at least one of them
+	bool checkRelative = DebugUtilities::IsRelativeMemory(operationInfo.MemType) && IsAddressIndexed(opType, operationInfo.MemType, (int32_t)operationInfo.Address);
+	bool checkAbsolute = IsAddressIndexed(opType, address.Type, address.Address);
+	if(!checkRelative && !checkAbsolute) {
+		return -1;
+	}
+
+	return InternalCheckBreakpoint(operationInfo, address, processMarkedBreakpoints, checkRelative, checkAbsolute);
 }
\ No newline at end of file
@@ -947,8 +947,20 @@ uint32_t Debugger::GetExecutionTrace(TraceRow output[], uint32_t startOffset, ui
 
 	uint32_t offsetsByCpu[(int)DebugUtilities::GetLastCpuType() + 1] = {};
 
+	//Row IDs are shared by all CPUs and have no gaps, so the first row the UI wants to display is
+	//the one with ID "NextRowId - 1 - startOffset" - find it in each trace logger instead of skipping rows
+	int64_t lastRowId = (int64_t)ITraceLogger::NextRowId - startOffset;
+	if(startOffset > 0) {
+		for(CpuType cpuType : _cpuTypes) {
+			ITraceLogger* logger = GetTraceLogger(cpuType);
+			if(logger) {
+				int64_t offset = logger->FindOffset(lastRowId - 1);
+				offsetsByCpu[(int)cpuType] = offset >= 0 ? (uint32_t)offset : logger->GetRowCount();
+			}
+		}
+	}
+
 	uint32_t count = 0;
-	int64_t lastRowId = ITraceLogger::NextRowId;
 	while(count < maxLineCount) {
 		bool added = false;
 		for(CpuType cpuType : _cpuTypes) {
@@ -962,16 +974,11 @@ uint32_t Debugger::GetExecutionTrace(TraceRow output[], uint32_t startOffset, ui
 
 				lastRowId = rowId;
 
-				if(startOffset > 0) {
-					//Skip rows until the part the UI wants to display is reached
-					startOffset--;
-				} else {
-					if(logger->IsEnabled()) {
-						if(output) {
-							logger->GetExecutionTrace(output[count], offset);
-						}
-						count++;
+				if(logger->IsEnabled()) {
+					if(output) {
+						logger->GetExecutionTrace(output[count], offset);
 					}
+					count++;
 				}
 				offset++;
 				added = true;
@@ -986,6 +993,31 @@ uint32_t Debugger::GetExecutionTrace(TraceRow output[], uint32_t startOffset, ui
 	return count;
 }
 
+uint32_t Debugger::GetExecutionTraceSize()
+{
+	DebugBreakHelper helper(this);
+
+	//Rows are only returned while their IDs are contiguous - once a trace logger starts overwriting
+	//its oldest rows, rows older than its oldest remaining row can't be displayed anymore
+	int64_t firstRowId = 0;
+	for(CpuType cpuType : _cpuTypes) {
+		ITraceLogger* logger = GetTraceLogger(cpuType);
+		if(logger && logger->IsFull()) {
+			firstRowId = std::max(firstRowId, logger->GetRowId(logger->GetRowCount() - 1));
+		}
+	}
+
+	uint32_t count = 0;
+	for(CpuType cpuType : _cpuTypes) {
+		ITraceLogger* logger = GetTraceLogger(cpuType);
+		if(logger && logger->IsEnabled()) {
+			int64_t offset = logger->FindOffset(firstRowId - 1);
+			count += offset >= 0 ? (uint32_t)offset : logger->GetRowCount();
+		}
+	}
+	return count;
+}
+
 PpuTools* Debugger::GetPpuTools(CpuType cpuType)
 {
 	if(_debuggers[(int)cpuType].Debugger) {
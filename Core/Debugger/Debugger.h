@@ -174,6 +174,7 @@ public:
 
 	void ClearExecutionTrace();
 	uint32_t GetExecutionTrace(TraceRow output[], uint32_t startOffset, uint32_t maxLineCount);
+	uint32_t GetExecutionTraceSize();
 	
 	CpuType GetMainCpuType() { return _mainCpuType; }
 
@@ -354,7 +354,254 @@ bool ExpressionEvaluator::ToRpn(string expression, ExpressionData &data)
 	return true;
 }
 
+bool ExpressionEvaluator::Compile(ExpressionData &data)
+{
+	//Converts the RPN queue into a flat program that can be evaluated without any token decoding, lookups or allocations:
+	//-Special values are resolved to their opcode (or the CPU-specific getter) once
+	//-Operators whose operands are all constants are evaluated immediately (constant folding)
+	//-Operators whose right (or only) operand is a constant use it directly, instead of pushing it on the stack first
+	vector<ExpressionInstruction>& program = data.Program;
+	program.clear();
+
+	int depth = 0;
+	int maxDepth = 0;
+	for(int64_t token : data.RpnQueue) {
+		ExpressionInstruction instr = { ExpressionOpCode::PushConst, EvalResultType::Numeric, false, token };
+
+		if(token >= EvalValues::RegA) {
+			if(token >= EvalValues::FirstLabelIndex) {
+				//Labels can be moved/renamed and their relative address can change when banks are switched, so they are resolved on each evaluation
+				instr.Op = ExpressionOpCode::PushLabel;
+				instr.Value = token - EvalValues::FirstLabelIndex;
+			} else {
+				switch(token) {
+					case EvalValues::Value: instr.Op = ExpressionOpCode::PushValue; break;
+					case EvalValues::Address: instr.Op = ExpressionOpCode::PushAddress; break;
+					case EvalValues::MemoryAddress: instr.Op = ExpressionOpCode::PushMemoryAddress; break;
+					case EvalValues::IsWrite: instr.Op = ExpressionOpCode::PushIsWrite; break;
+					case EvalValues::IsRead: instr.Op = ExpressionOpCode::PushIsRead; break;
+					case EvalValues::IsDma: instr.Op = ExpressionOpCode::PushIsDma; break;
+					case EvalValues::IsDummy: instr.Op = ExpressionOpCode::PushIsDummy; break;
+					case EvalValues::OpProgramCounter: instr.Op = ExpressionOpCode::PushOpProgramCounter; break;
+
+					default:
+						if(_getTokenValue) {
+							instr.Op = ExpressionOpCode::PushCpuToken;
+						} else {
+							instr.Value = 0;
+						}
+						break;
+				}
+			}
+
+			program.push_back(instr);
+			depth++;
+			maxDepth = std::max(depth, maxDepth);
+		} else if(token >= EvalOperators::Multiplication) {
+			bool isUnary = token > EvalOperators::LogicalOr;
+			if(depth < (isUnary ? 1 : 2)) {
+				//Missing operand, let the RPN evaluation process this expression as before
+				program.clear();
+				return false;
+			}
+
+			switch(token) {
+				case EvalOperators::Multiplication: instr.Op = ExpressionOpCode::Multiplication; break;
+				case EvalOperators::Division: instr.Op = ExpressionOpCode::Division; break;
+				case EvalOperators::Modulo: instr.Op = ExpressionOpCode::Modulo; break;
+				case EvalOperators::Addition: instr.Op = ExpressionOpCode::Addition; break;
+				case EvalOperators::Substration: instr.Op = ExpressionOpCode::Substration; break;
+				case EvalOperators::ShiftLeft: instr.Op = ExpressionOpCode::ShiftLeft; break;
+				case EvalOperators::ShiftRight: instr.Op = ExpressionOpCode::ShiftRight; break;
+				case EvalOperators::SmallerThan: instr.Op = ExpressionOpCode::SmallerThan; instr.ResultType = EvalResultType::Boolean; break;
+				case EvalOperators::SmallerOrEqual: instr.Op = ExpressionOpCode::SmallerOrEqual; instr.ResultType = EvalResultType::Boolean; break;
+				case EvalOperators::GreaterThan: instr.Op = ExpressionOpCode::GreaterThan; instr.ResultType = EvalResultType::Boolean; break;
+				case EvalOperators::GreaterOrEqual: instr.Op = ExpressionOpCode::GreaterOrEqual; instr.ResultType = EvalResultType::Boolean; break;
+				case EvalOperators::Equal: instr.Op = ExpressionOpCode::Equal; instr.ResultType = EvalResultType::Boolean; break;
+				case EvalOperators::NotEqual: instr.Op = ExpressionOpCode::NotEqual; instr.ResultType = EvalResultType::Boolean; break;
+				case EvalOperators::BinaryAnd: instr.Op = ExpressionOpCode::BinaryAnd; break;
+				case EvalOperators::BinaryXor: instr.Op = ExpressionOpCode::BinaryXor; break;
+				case EvalOperators::BinaryOr: instr.Op = ExpressionOpCode::BinaryOr; break;
+				case EvalOperators::LogicalAnd: instr.Op = ExpressionOpCode::LogicalAnd; instr.ResultType = EvalResultType::Boolean; break;
+				case EvalOperators::LogicalOr: instr.Op = ExpressionOpCode::LogicalOr; instr.ResultType = EvalResultType::Boolean; break;
+
+				case EvalOperators::Plus: instr.Op = ExpressionOpCode::Plus; break;
+				case EvalOperators::Minus: instr.Op = ExpressionOpCode::Minus; break;
+				case EvalOperators::BinaryNot: instr.Op = ExpressionOpCode::BinaryNot; break;
+				case EvalOperators::LogicalNot: instr.Op = ExpressionOpCode::LogicalNot; break;
+				case EvalOperators::AbsoluteAddress: instr.Op = ExpressionOpCode::AbsoluteAddress; break;
+				case EvalOperators::Bracket: instr.Op = ExpressionOpCode::ReadByte; break;
+				case EvalOperators::Braces: instr.Op = ExpressionOpCode::ReadWord; break;
+
+				default:
+					program.clear();
+					return false;
+			}
+			instr.Value = 0;
+
+			//The last instruction produced the right operand, and the one before it produced the left operand when it is a push
+			size_t count = program.size();
+			bool rightIsConst = program[count - 1].Op == ExpressionOpCode::PushConst;
+			bool leftIsConst = isUnary || (count >= 2 && program[count - 2].Op == ExpressionOpCode::PushConst);
+			int64_t right = program[count - 1].Value;
+
+			bool readsState = instr.Op == ExpressionOpCode::AbsoluteAddress || instr.Op == ExpressionOpCode::ReadByte || instr.Op == ExpressionOpCode::ReadWord;
+			bool divideBy0 = (instr.Op == ExpressionOpCode::Division || instr.Op == ExpressionOpCode::Modulo) && right == 0;
+
+			if(rightIsConst && leftIsConst && !readsState && !divideBy0) {
+				ExpressionInstruction constProgram[3];
+				size_t operandCount = isUnary ? 1 : 2;
+				std::copy(program.end() - operandCount, program.end(), constProgram);
+				constProgram[operandCount] = instr;
+
+				EvalResultType resultType;
+				MemoryOperationInfo operationInfo = {};
+				AddressInfo addressInfo = {};
+				int64_t result = EvaluateProgram(constProgram, operandCount + 1, data, resultType, operationInfo, addressInfo);
+
+				program.resize(count - operandCount);
+				program.push_back({ ExpressionOpCode::PushConst, resultType, false, result });
+			} else if(rightIsConst) {
+				program.pop_back();
+				instr.ConstOperand = true;
+				instr.Value = right;
+				program.push_back(instr);
+			} else {
+				program.push_back(instr);
+			}
+
+			if(!isUnary) {
+				depth--;
+			}
+		} else {
+			program.push_back(instr);
+			depth++;
+			maxDepth = std::max(depth, maxDepth);
+		}
+	}
+
+	if(depth != 1 || maxDepth >= ExpressionData::MaxStackSize) {
+		program.clear();
+		return false;
+	}
+
+	return true;
+}
+
+int64_t ExpressionEvaluator::GetLabelValue(ExpressionData &data, int64_t labelIndex, EvalResultType &resultType)
+{
+	int64_t value;
+	if((size_t)labelIndex < data.Labels.size()) {
+		value = _labelManager->GetLabelRelativeAddress(data.Labels[(uint32_t)labelIndex], _cpuType);
+		if(value < -1) {
+			//Label doesn't exist, try to find a matching multi-byte label
+			string label = data.Labels[(uint32_t)labelIndex] + "+0";
+			value = _labelManager->GetLabelRelativeAddress(label, _cpuType);
+		}
+	} else {
+		value = -2;
+	}
+
+	if(value < 0) {
+		//Label is no longer valid
+		resultType = value == -1 ? EvalResultType::OutOfScope : EvalResultType::Invalid;
+	}
+	return value;
+}
+
+int64_t ExpressionEvaluator::EvaluateProgram(const ExpressionInstruction* program, size_t count, ExpressionData &data, EvalResultType &resultType, MemoryOperationInfo &operationInfo, AddressInfo& addressInfo)
+{
+	//Compile() validated the stack usage, no bounds checks are needed here
+	int64_t stack[ExpressionData::MaxStackSize];
+	int pos = 0;
+	resultType = EvalResultType::Numeric;
+
+	for(size_t i = 0; i < count; i++) {
+		const ExpressionInstruction& instr = program[i];
+
+		int64_t right = 0;
+		int64_t left = 0;
+		if(instr.Op >= ExpressionOpCode::Multiplication) {
+			right = instr.ConstOperand ? instr.Value : stack[--pos];
+			if(instr.Op <= ExpressionOpCode::LogicalOr) {
+				left = stack[--pos];
+			}
+			resultType = instr.ResultType;
+		}
+
+		int64_t value;
+		switch(instr.Op) {
+			case ExpressionOpCode::PushConst: value = instr.Value; resultType = instr.ResultType; break;
+			case ExpressionOpCode::PushValue: value = operationInfo.Value; break;
+			case ExpressionOpCode::PushAddress: value = operationInfo.Address; break;
+			case ExpressionOpCode::PushMemoryAddress: value = addressInfo.Address; break;
+			case ExpressionOpCode::PushIsWrite: value = operationInfo.Type == MemoryOperationType::Write || operationInfo.Type == MemoryOperationType::DmaWrite || operationInfo.Type == MemoryOperationType::DummyWrite; break;
+			case ExpressionOpCode::PushIsRead: value = operationInfo.Type != MemoryOperationType::Write && operationInfo.Type != MemoryOperationType::DmaWrite && operationInfo.Type != MemoryOperationType::DummyWrite; break;
+			case ExpressionOpCode::PushIsDma: value = operationInfo.Type == MemoryOperationType::DmaRead || operationInfo.Type == MemoryOperationType::DmaWrite; break;
+			case ExpressionOpCode::PushIsDummy: value = operationInfo.Type == MemoryOperationType::DummyRead || operationInfo.Type == MemoryOperationType::DummyWrite; break;
+			case ExpressionOpCode::PushOpProgramCounter: value = _cpuDebugger->GetProgramCounter(true); break;
+			case ExpressionOpCode::PushCpuToken: value = (this->*_getTokenValue)(instr.Value, resultType); break;
+			case ExpressionOpCode::PushLabel:
+				value = GetLabelValue(data, instr.Value, resultType);
+				if(value < 0) {
+					return 0;
+				}
+				break;
+
+			case ExpressionOpCode::Multiplication: value = left * right; break;
+			case ExpressionOpCode::Division:
+				if(right == 0) {
+					resultType = EvalResultType::DivideBy0;
+					return 0;
+				}
+				value = left / right;
+				break;
+			case ExpressionOpCode::Modulo:
+				if(right == 0) {
+					resultType = EvalResultType::DivideBy0;
+					return 0;
+				}
+				value = left % right;
+				break;
+			case ExpressionOpCode::Addition: value = left + right; break;
+			case ExpressionOpCode::Substration: value = left - right; break;
+			case ExpressionOpCode::ShiftLeft: value = left << right; break;
+			case ExpressionOpCode::ShiftRight: value = left >> right; break;
+			case ExpressionOpCode::SmallerThan: value = left < right; break;
+			case ExpressionOpCode::SmallerOrEqual: value = left <= right; break;
+			case ExpressionOpCode::GreaterThan: value = left > right; break;
+			case ExpressionOpCode::GreaterOrEqual: value = left >= right; break;
+			case ExpressionOpCode::Equal: value = left == right; break;
+			case ExpressionOpCode::NotEqual: value = left != right; break;
+			case ExpressionOpCode::BinaryAnd: value = left & right; break;
+			case ExpressionOpCode::BinaryXor: value = left ^ right; break;
+			case ExpressionOpCode::BinaryOr: value = left | right; break;
+			case ExpressionOpCode::LogicalAnd: value = (bool)(left && right); break;
+			case ExpressionOpCode::LogicalOr: value = (bool)(left || right); break;
+
+			case ExpressionOpCode::Plus: value = right; break;
+			case ExpressionOpCode::Minus: value = -right; break;
+			case ExpressionOpCode::BinaryNot: value = ~right; break;
+			case ExpressionOpCode::LogicalNot: value = (bool)!right; break;
+			case ExpressionOpCode::AbsoluteAddress: value = right >= 0 ? _debugger->GetAbsoluteAddress({ (int32_t)right, _cpuMemory }).Address : -1; break;
+			case ExpressionOpCode::ReadByte: value = _debugger->GetMemoryDumper()->GetMemoryValue(_cpuMemory, (uint32_t)right); break;
+			case ExpressionOpCode::ReadWord: value = _debugger->GetMemoryDumper()->GetMemoryValueWord(_cpuMemory, (uint32_t)right); break;
+			default: throw std::runtime_error("Invalid operator");
+		}
+		stack[pos++] = value;
+	}
+	return stack[0];
+}
+
 int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, EvalResultType &resultType, MemoryOperationInfo &operationInfo, AddressInfo& addressInfo)
+{
+	if(!data.Program.empty()) {
+		return (int32_t)EvaluateProgram(data.Program.data(), data.Program.size(), data, resultType, operationInfo, addressInfo);
+	}
+	return EvaluateRpn(data, resultType, operationInfo, addressInfo);
+}
+
+int32_t ExpressionEvaluator::EvaluateRpn(ExpressionData &data, EvalResultType &resultType, MemoryOperationInfo &operationInfo, AddressInfo& addressInfo)
 {
 	if(data.RpnQueue.empty()) {
 		resultType = EvalResultType::Invalid;
@@ -373,20 +620,8 @@ int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, EvalResultType &resu
 		if(token >= EvalValues::RegA) {
 			//Replace value with a special value
 			if(token >= EvalValues::FirstLabelIndex) {
-				int64_t labelIndex = token - EvalValues::FirstLabelIndex;
-				if((size_t)labelIndex < data.Labels.size()) {
-					token = _labelManager->GetLabelRelativeAddress(data.Labels[(uint32_t)labelIndex], _cpuType);
-					if(token < -1) {
-						//Label doesn't exist, try to find a matching multi-byte label
-						string label = data.Labels[(uint32_t)labelIndex] + "+0";
-						token = _labelManager->GetLabelRelativeAddress(label, _cpuType);
-					}
-				} else {
-					token = -2;
-				}
+				token = GetLabelValue(data, token - EvalValues::FirstLabelIndex, resultType);
 				if(token < 0) {
-					//Label is no longer valid
-					resultType = token == -1 ? EvalResultType::OutOfScope : EvalResultType::Invalid;
 					return 0;
 				}
 			} else {
@@ -491,6 +726,20 @@ ExpressionEvaluator::ExpressionEvaluator(Debugger* debugger, IDebugger* cpuDebug
 	_labelManager = debugger->GetLabelManager();
 	_cpuType = cpuType;
 	_cpuMemory = DebugUtilities::GetCpuMemoryType(cpuType);
+
+	if(_cpuDebugger) {
+		switch(_cpuType) {
+			case CpuType::Snes: _getTokenValue = &ExpressionEvaluator::GetSnesTokenValue; break;
+			case CpuType::Spc: _getTokenValue = &ExpressionEvaluator::GetSpcTokenValue; break;
+			case CpuType::NecDsp: _getTokenValue = &ExpressionEvaluator::GetNecDspTokenValue; break;
+			case CpuType::Sa1: _getTokenValue = &ExpressionEvaluator::GetSnesTokenValue; break;
+			case CpuType::Gsu: _getTokenValue = &ExpressionEvaluator::GetGsuTokenValue; break;
+			case CpuType::Cx4: _getTokenValue = &ExpressionEvaluator::GetCx4TokenValue; break;
+			case CpuType::Gameboy: _getTokenValue = &ExpressionEvaluator::GetGameboyTokenValue; break;
+			case CpuType::Nes: _getTokenValue = &ExpressionEvaluator::GetNesTokenValue; break;
+			case CpuType::Pce: _getTokenValue = &ExpressionEvaluator::GetPceTokenValue; break;
+		}
+	}
 }
 
 bool ExpressionEvaluator::ReturnBool(int64_t value, EvalResultType& resultType)
@@ -557,6 +806,7 @@ ExpressionData* ExpressionEvaluator::PrivateGetRpnList(string expression, bool&
 		ExpressionData data;
 		success = ToRpn(fixedExp, data);
 		if(success) {
+			Compile(data);
 			LockHandler lock = _cacheLock.AcquireSafe();
 			_cache[expression] = data;
 			cachedData = &_cache[expression];
@@ -682,6 +932,11 @@ void ExpressionEvaluator::RunTests()
 	test("(5+5)%3", EvalResultType::Numeric, 1);
 	test("11%%10", EvalResultType::Numeric, 1); //11 modulo of 2 in binary (%10)
 
+	test("[$4500] == " + std::to_string(byte4500), EvalResultType::Boolean, true);
+	test("x > 3 && [$4500] == " + std::to_string(byte4500), EvalResultType::Boolean, state.X > 3);
+	test("!(5 > 3)", EvalResultType::Numeric, 0);
+	test("5 / (3 - 3)", EvalResultType::DivideBy0, 0);
+
 	test("[$4500+[$4500]]", EvalResultType::Numeric, indirectByte);
 	test("-($10+[$4500])", EvalResultType::Numeric, -(0x10 + byte4500));
 }
@@ -174,10 +174,74 @@ public:
 	}
 };
 
+enum class ExpressionOpCode : uint8_t
+{
+	//Push a value on the stack
+	PushConst,
+	PushValue,
+	PushAddress,
+	PushMemoryAddress,
+	PushIsWrite,
+	PushIsRead,
+	PushIsDma,
+	PushIsDummy,
+	PushOpProgramCounter,
+	PushCpuToken,
+	PushLabel,
+
+	//Binary operators
+	Multiplication,
+	Division,
+	Modulo,
+	Addition,
+	Substration,
+	ShiftLeft,
+	ShiftRight,
+	SmallerThan,
+	SmallerOrEqual,
+	GreaterThan,
+	GreaterOrEqual,
+	Equal,
+	NotEqual,
+	BinaryAnd,
+	BinaryXor,
+	BinaryOr,
+	LogicalAnd,
+	LogicalOr,
+
+	//Unary operators
+	Plus,
+	Minus,
+	BinaryNot,
+	LogicalNot,
+	AbsoluteAddress,
+	ReadByte,
+	ReadWord,
+};
+
+struct ExpressionInstruction
+{
+	ExpressionOpCode Op;
+
+	//Result type set by this instruction (the type of the last instruction is the expression's type)
+	EvalResultType ResultType;
+
+	//When set, the operator's right (or only) operand is Value instead of the top of the stack
+	bool ConstOperand;
+
+	//Constant, CPU token or label index (push instructions) or constant operand (operators)
+	int64_t Value;
+};
+
 struct ExpressionData
 {
+	static constexpr int MaxStackSize = 100;
+
 	vector<int64_t> RpnQueue;
 	vector<string> Labels;
+
+	//RPN queue compiled into a flat program (constant-folded, tokens resolved) - empty if the RPN queue could not be compiled
+	vector<ExpressionInstruction> Program;
 };
 
 class ExpressionEvaluator
@@ -194,6 +258,7 @@ private:
 	
 	Debugger* _debugger;
 	IDebugger* _cpuDebugger;
+	int64_t (ExpressionEvaluator::*_getTokenValue)(int64_t token, EvalResultType& resultType) = nullptr;
 	LabelManager* _labelManager;
 	CpuType _cpuType;
 	MemoryType _cpuMemory;
@@ -234,6 +299,10 @@ private:
 	string GetNextToken(string expression, size_t &pos, ExpressionData &data, bool &success, bool previousTokenIsOp);
 	bool ProcessSpecialOperator(EvalOperators evalOp, std::stack<EvalOperators> &opStack, std::stack<int> &precedenceStack, vector<int64_t> &outputQueue);
 	bool ToRpn(string expression, ExpressionData &data);
+	bool Compile(ExpressionData &data);
+	int64_t GetLabelValue(ExpressionData &data, int64_t labelIndex, EvalResultType &resultType);
+	int32_t EvaluateRpn(ExpressionData &data, EvalResultType &resultType, MemoryOperationInfo &operationInfo, AddressInfo& addressInfo);
+	int64_t EvaluateProgram(const ExpressionInstruction* program, size_t count, ExpressionData &data, EvalResultType &resultType, MemoryOperationInfo &operationInfo, AddressInfo& addressInfo);
 	int32_t PrivateEvaluate(string expression, EvalResultType &resultType, MemoryOperationInfo &operationInfo, AddressInfo& addressInfo, bool &success);
 	ExpressionData* PrivateGetRpnList(string expression, bool& success);
 
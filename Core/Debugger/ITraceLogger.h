@@ -19,6 +19,7 @@ struct TraceLoggerOptions
 	bool UseLabels;
 	char Condition[1000];
 	char Format[1000];
+	uint32_t HistorySize;
 };
 
 class ITraceLogger
@@ -30,9 +31,20 @@ public:
 	static uint64_t NextRowId;
 
 	virtual int64_t GetRowId(uint32_t offset) = 0;
+
+	//Returns the offset of the most recent row whose ID is <= rowId (or -1 if there is no such row)
+	virtual int64_t FindOffset(int64_t rowId) = 0;
+	virtual uint32_t GetRowCount() = 0;
+
+	//Returns true when older rows are being overwritten by new ones
+	virtual bool IsFull() = 0;
+
 	virtual void GetExecutionTrace(TraceRow& row, uint32_t offset) = 0;
 	virtual void Clear() = 0;
 	virtual void SetOptions(TraceLoggerOptions options) = 0;
 
+	//Converts a row logged to the TraceLogFileSaver to text (called on the file saver's thread)
+	virtual void FormatFileRecord(uint8_t* record, string& output) = 0;
+
 	__forceinline bool IsEnabled() { return _enabled; }
 };
@@ -17,7 +17,6 @@
 #include "Shared/Emulator.h"
 #include "Shared/Video/BaseVideoFilter.h"
 #include "Shared/Video/VideoRenderer.h"
-#include "Shared/Video/DrawScreenBufferCommand.h"
 #include "Shared/Video/DrawStringCommand.h"
 #include "Shared/KeyManager.h"
 #include "Shared/Interfaces/IConsole.h"
@@ -105,6 +104,7 @@ int LuaApi::GetLibrary(lua_State *lua)
 		{ "drawString", LuaApi::DrawString },
 
 		{ "drawPixel", LuaApi::DrawPixel },
+		{ "drawPixels", LuaApi::DrawPixels },
 		{ "drawLine", LuaApi::DrawLine },
 		{ "drawRectangle", LuaApi::DrawRectangle },
 		{ "clearScreen", LuaApi::ClearScreen },
@@ -513,6 +513,35 @@ int LuaApi::DrawPixel(lua_State *lua)
 	return l.ReturnCount();
 }
 
+int LuaApi::DrawPixels(lua_State *lua)
+{
+	LuaCallHelper l(lua);
+	l.ForceParamCount(7);
+	lua_settop(lua, 7);
+	int displayDelay = l.ReadInteger(0);
+	int frameCount = l.ReadInteger(1);
+
+	luaL_checktype(lua, 5, LUA_TTABLE);
+	int height = (int)lua_tointeger(lua, 4);
+	int width = (int)lua_tointeger(lua, 3);
+	int y = (int)lua_tointeger(lua, 2);
+	int x = (int)lua_tointeger(lua, 1);
+	errorCond(width <= 0 || height <= 0 || (int64_t)width * height > 0x400000, "invalid width or height");
+	errorCond(lua_rawlen(lua, 5) < (size_t)(width * height), "pixel array is smaller than width * height");
+
+	vector<uint32_t> pixels(width * height);
+	for(int i = 0, len = width * height; i < len; i++) {
+		lua_rawgeti(lua, 5, i + 1);
+		pixels[i] = (uint32_t)lua_tointeger(lua, -1);
+		lua_pop(lua, 1);
+	}
+
+	int startFrame = _emu->GetFrameCount() + displayDelay;
+	GetHud()->DrawPixels(x, y, width, height, pixels.data(), frameCount, startFrame);
+
+	return l.ReturnCount();
+}
+
 int LuaApi::DrawRectangle(lua_State *lua)
 {
 	LuaCallHelper l(lua);
@@ -635,17 +664,17 @@ int LuaApi::SetScreenBuffer(lua_State *lua)
 	FrameInfo size = InternalGetScreenSize();
 
 	int startFrame = _emu->GetFrameCount();
-	unique_ptr<DrawScreenBufferCommand> cmd(new DrawScreenBufferCommand(size.Width, size.Height, startFrame));
+	vector<uint32_t> screenBuffer(size.Width * size.Height);
 
 	luaL_checktype(lua, 1, LUA_TTABLE);
 	for(int i = 0, len = size.Height * size.Width; i < len; i++) {
 		lua_rawgeti(lua, 1, i+1);
 		uint32_t color = (uint32_t)lua_tointeger(lua, -1);
 		lua_pop(lua, 1);
-		cmd->SetPixel(i, color ^ 0xFF000000);
+		screenBuffer[i] = color ^ 0xFF000000;
 	}
 	
-	_emu->GetDebugHud()->AddCommand(std::move(cmd));
+	_emu->GetDebugHud()->DrawScreenBuffer(screenBuffer.data(), size.Width, size.Height, startFrame);
 	return l.ReturnCount();
 }
 
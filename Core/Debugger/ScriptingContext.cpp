@@ -203,6 +203,7 @@ void ScriptingContext::RegisterMemoryCallback(CallbackType type, int startAddr,
 	}
 
 	_callbacks[(int)type].push_back(callback);
+	RebuildCallbackIndex(type);
 }
 
 void ScriptingContext::RefreshMemoryCallbackFlags()
@@ -236,6 +237,7 @@ void ScriptingContext::UnregisterMemoryCallback(CallbackType type, int startAddr
 
 		if(isMatch) {
 			_callbacks[(int)type].erase(_callbacks[(int)type].begin() + i);
+			RebuildCallbackIndex(type);
 			break;
 		}
 	}
@@ -260,39 +262,101 @@ bool ScriptingContext::IsAddressMatch(MemoryCallback& callback, AddressInfo addr
 	return addr.Type == callback.MemType && addr.Address >= (int32_t)callback.StartAddress && addr.Address <= (int32_t)callback.EndAddress;
 }
 
+void ScriptingContext::RebuildCallbackIndex(CallbackType type)
+{
+	for(int i = 0; i < CpuTypeUtilities::GetCpuTypeCount(); i++) {
+		_callbackIndex[(int)type][i] = {};
+	}
+	for(int i = 0; i < ScriptingContext::MemoryTypeCount; i++) {
+		_callbackPages[(int)type][i].clear();
+	}
+
+	vector<MemoryCallback>& callbacks = _callbacks[(int)type];
+	for(uint32_t i = 0; i < (uint32_t)callbacks.size(); i++) {
+		MemoryCallback& callback = callbacks[i];
+		MemoryCallbackIndex& index = _callbackIndex[(int)type][(int)callback.Cpu];
+		index.Callbacks.push_back(i);
+		if(DebugUtilities::IsRelativeMemory(callback.MemType)) {
+			index.HasRelative = true;
+		} else {
+			index.HasAbsolute = true;
+		}
+
+		vector<uint64_t>& pages = _callbackPages[(int)type][(int)callback.MemType];
+		uint32_t startPage = callback.StartAddress >> ScriptingContext::CallbackPageShift;
+		uint32_t endPage = callback.EndAddress >> ScriptingContext::CallbackPageShift;
+		if(pages.size() <= (endPage >> 6)) {
+			pages.resize((endPage >> 6) + 1);
+		}
+		for(uint32_t page = startPage; page <= endPage; page++) {
+			pages[page >> 6] |= (uint64_t)1 << (page & 0x3F);
+		}
+	}
+}
+
+bool ScriptingContext::IsPageIndexed(CallbackType type, AddressInfo addr)
+{
+	if(addr.Address < 0 || addr.Type > MemoryType::None) {
+		return false;
+	}
+
+	vector<uint64_t>& pages = _callbackPages[(int)type][(int)addr.Type];
+	uint32_t page = (uint32_t)addr.Address >> ScriptingContext::CallbackPageShift;
+	return (page >> 6) < pages.size() && (pages[page >> 6] & ((uint64_t)1 << (page & 0x3F)));
+}
+
 template<typename T>
 void ScriptingContext::InternalCallMemoryCallback(AddressInfo relAddr, T& value, CallbackType type, CpuType cpuType)
 {
-	if(_callbacks[(int)type].empty()) {
+	MemoryCallbackIndex& index = _callbackIndex[(int)type][(int)cpuType];
+	if(index.Callbacks.empty()) {
 		return;
 	}
 
-	_context = this;
-	bool needTimerReset = true;
-	lua_setwatchdogtimer(_lua, ScriptingContext::ExecutionCountHook, 1000);
-	LuaApi::SetContext(this);
-	for(MemoryCallback& callback : _callbacks[(int)type]) {
-		if(callback.Cpu != cpuType) {
-			continue;
-		} 
+	//Check the page bitmaps before doing anything else - most accesses don't match any callback
+	bool checkRelative = index.HasRelative && IsPageIndexed(type, relAddr);
+	AddressInfo absAddr = {};
+	bool checkAbsolute = false;
+	if(index.HasAbsolute) {
+		absAddr = _debugger->GetAbsoluteAddress(relAddr);
+		checkAbsolute = IsPageIndexed(type, absAddr);
+	}
+
+	if(!checkRelative && !checkAbsolute) {
+		return;
+	}
+
+	bool needInit = true;
+
+	//Callbacks can (un)register callbacks, which rebuilds the index - use indexes and re-check the sizes on each iteration
+	for(size_t i = 0; i < index.Callbacks.size(); i++) {
+		uint32_t callbackIndex = index.Callbacks[i];
+		if(callbackIndex >= _callbacks[(int)type].size()) {
+			break;
+		}
 
+		MemoryCallback& callback = _callbacks[(int)type][callbackIndex];
 		if(DebugUtilities::IsRelativeMemory(callback.MemType)) {
-			if(!IsAddressMatch(callback, relAddr)) {
+			if(!checkRelative || !IsAddressMatch(callback, relAddr)) {
 				continue;
 			}
 		} else {
-			if(!IsAddressMatch(callback, _debugger->GetAbsoluteAddress(relAddr))) {
+			if(!checkAbsolute || !IsAddressMatch(callback, absAddr)) {
 				continue;
 			}
 		}
 
-		if(needTimerReset) {
+		if(needInit) {
+			_context = this;
+			lua_setwatchdogtimer(_lua, ScriptingContext::ExecutionCountHook, 1000);
+			LuaApi::SetContext(this);
 			_timer.Reset();
-			needTimerReset = false;
+			needInit = false;
 		}
 
+		int reference = callback.Reference;
 		int top = lua_gettop(_lua);
-		lua_rawgeti(_lua, LUA_REGISTRYINDEX, callback.Reference);
+		lua_rawgeti(_lua, LUA_REGISTRYINDEX, reference);
 		lua_pushinteger(_lua, relAddr.Address);
 		lua_pushinteger(_lua, value);
 		if(lua_pcall(_lua, 2, LUA_MULTRET, 0) != 0) {
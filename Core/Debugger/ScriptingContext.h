@@ -4,6 +4,7 @@
 #include "Utilities/SimpleLock.h"
 #include "Utilities/Timer.h"
 #include "Debugger/DebugTypes.h"
+#include "Shared/MemoryType.h"
 #include "Shared/EventType.h"
 
 class Debugger;
@@ -25,6 +26,14 @@ struct MemoryCallback
 	int Reference;
 };
 
+struct MemoryCallbackIndex
+{
+	//Indexes (in _callbacks) of the callbacks registered for this cpu, in registration order
+	vector<uint32_t> Callbacks;
+	bool HasRelative = false;
+	bool HasAbsolute = false;
+};
+
 enum class ScriptDrawSurface
 {
 	ConsoleScreen,
@@ -49,6 +58,14 @@ private:
 
 	ScriptDrawSurface _drawSurface = ScriptDrawSurface::ConsoleScreen;
 
+	static constexpr int CallbackTypeCount = (int)CallbackType::Exec + 1;
+	static constexpr int MemoryTypeCount = (int)MemoryType::None + 1;
+	static constexpr int CallbackPageShift = 8;
+
+	//Built when callbacks are (un)registered - used to skip accesses outside of all callback ranges without calling into Lua
+	MemoryCallbackIndex _callbackIndex[CallbackTypeCount][CpuTypeUtilities::GetCpuTypeCount()];
+	vector<uint64_t> _callbackPages[CallbackTypeCount][MemoryTypeCount]; //1 bit per 256-byte page
+
 	static void ExecutionCountHook(lua_State* lua);
 	void LuaOpenLibs(lua_State* L, bool allowIoOsAccess);
 
@@ -56,12 +73,14 @@ protected:
 	string _scriptName;
 	bool _initDone = false;
 
-	vector<MemoryCallback> _callbacks[3];
+	vector<MemoryCallback> _callbacks[CallbackTypeCount];
 	vector<int> _eventCallbacks[(int)EventType::LastValue + 1];
 
 	template<typename T> void InternalCallMemoryCallback(AddressInfo relAddr, T& value, CallbackType type, CpuType cpuType);
 
 	bool IsAddressMatch(MemoryCallback& callback, AddressInfo addr);
+	__forceinline bool IsPageIndexed(CallbackType type, AddressInfo addr);
+	void RebuildCallbackIndex(CallbackType type);
 
 public:
 	ScriptingContext(Debugger* debugger);
@@ -2,7 +2,6 @@
 #include "Debugger/StepBackManager.h"
 #include "Debugger/IDebugger.h"
 #include "Shared/Emulator.h"
-#include "Shared/SaveStateManager.h"
 #include "Shared/NotificationManager.h"
 #include "Shared/RewindManager.h"
 
@@ -40,7 +39,7 @@ bool StepBackManager::CheckStepBack()
 				if(_cache.size()) {
 					//If cache isn't empty, load the last state
 					_rewindManager->SetIgnoreLoadState(true);
-					_emu->Deserialize(_cache.back().SaveState, SaveStateManager::FileFormatVersion, true);
+					_emu->DeserializeFromBuffer(_cache.back().SaveState, true);
 					_rewindManager->SetIgnoreLoadState(false);
 
 					_emu->GetRewindManager()->StopRewinding(true);
@@ -64,7 +63,7 @@ bool StepBackManager::CheckStepBack()
 		//Create a save state every instruction for the last X clocks
 		_cache.push_back(StepBackCacheEntry());
 		_cache.back().Clock = clock;
-		_emu->Serialize(_cache.back().SaveState, true, 0);
+		_emu->SerializeToBuffer(_cache.back().SaveState, true);
 	}
 
 	if(clock >= _targetClock) {
@@ -72,7 +71,7 @@ bool StepBackManager::CheckStepBack()
 		if(_cache.size() > 0) {
 			//If it does, load the last state
 			_rewindManager->SetIgnoreLoadState(true);
-			_emu->Deserialize(_cache.back().SaveState, SaveStateManager::FileFormatVersion, true);
+			_emu->DeserializeFromBuffer(_cache.back().SaveState, true);
 			_rewindManager->SetIgnoreLoadState(false);
 		} else if(_allowRetry && clock > _prevClock && (clock - _prevClock) > StepBackManager::DefaultClockLimit) {
 			//Cache is empty, this can happen when a single instruction takes more than X clocks (e.g block transfers, dma)
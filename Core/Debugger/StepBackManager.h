@@ -7,7 +7,7 @@ class IDebugger;
 
 struct StepBackCacheEntry
 {
-	stringstream SaveState;
+	vector<uint8_t> SaveState;
 	uint64_t Clock;
 };
 
@@ -0,0 +1,152 @@
+#include "pch.h"
+#include "Debugger/TraceLogFileSaver.h"
+#include "Debugger/ITraceLogger.h"
+
+TraceLogFileSaver::~TraceLogFileSaver()
+{
+	StopLogging();
+}
+
+void TraceLogFileSaver::StartLogging(string filename)
+{
+	StopLogging();
+
+	_writeBuffer.clear();
+	_writeBuffer.reserve(TraceLogFileSaver::BufferSize);
+	_outputFile.open(filename, ios::out | ios::binary);
+
+	_stopFlag = false;
+	_formatThread = std::thread(&TraceLogFileSaver::FormatThread, this);
+	_enabled = true;
+}
+
+void TraceLogFileSaver::StopLogging()
+{
+	if(_enabled) {
+		_enabled = false;
+
+		{
+			auto lock = _lock.AcquireSafe();
+			SubmitBuffer();
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_stopFlag = true;
+		}
+		_signal.notify_all();
+		_formatThread.join();
+
+		_outputFile.close();
+	}
+}
+
+void TraceLogFileSaver::Log(ITraceLogger* logger, const void* record, uint32_t size)
+{
+	auto lock = _lock.AcquireSafe();
+	if(_writeBuffer.size() + sizeof(RecordHeader) + size > TraceLogFileSaver::BufferSize) {
+		SubmitBuffer();
+	}
+
+	RecordHeader header = { logger, size };
+	size_t pos = _writeBuffer.size();
+	_writeBuffer.resize(pos + sizeof(RecordHeader) + size);
+	memcpy(_writeBuffer.data() + pos, &header, sizeof(RecordHeader));
+	memcpy(_writeBuffer.data() + pos + sizeof(RecordHeader), record, size);
+}
+
+void TraceLogFileSaver::SubmitBuffer()
+{
+	//Caller must hold _lock
+	if(_writeBuffer.empty()) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	//Limit the amount of memory used when the formatting thread can't keep up - the emulation thread waits for it
+	_signal.wait(lock, [this] { return _pendingBuffers.size() < TraceLogFileSaver::MaxPendingBuffers; });
+
+	_pendingBuffers.push_back(std::move(_writeBuffer));
+	if(_freeBuffers.empty()) {
+		_writeBuffer = vector<uint8_t>();
+		_writeBuffer.reserve(TraceLogFileSaver::BufferSize);
+	} else {
+		_writeBuffer = std::move(_freeBuffers.back());
+		_freeBuffers.pop_back();
+	}
+	lock.unlock();
+	_signal.notify_all();
+}
+
+void TraceLogFileSaver::WaitForFormatting()
+{
+	if(!_enabled) {
+		return;
+	}
+
+	{
+		auto lock = _lock.AcquireSafe();
+		SubmitBuffer();
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_signal.wait(lock, [this] { return _pendingBuffers.empty() && !_formatting; });
+}
+
+void TraceLogFileSaver::FormatThread()
+{
+	string output;
+	output.reserve(65536);
+
+	while(true) {
+		vector<uint8_t> buffer;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_signal.wait(lock, [this] { return _stopFlag || !_pendingBuffers.empty(); });
+			if(_pendingBuffers.empty()) {
+				//Stop flag is set and all rows have been written
+				break;
+			}
+			buffer = std::move(_pendingBuffers.front());
+			_pendingBuffers.pop_front();
+			_formatting = true;
+		}
+		_signal.notify_all();
+
+		FormatBuffer(buffer, output);
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			buffer.clear();
+			_freeBuffers.push_back(std::move(buffer));
+			_formatting = false;
+		}
+		_signal.notify_all();
+	}
+
+	_outputFile.flush();
+}
+
+void TraceLogFileSaver::FormatBuffer(vector<uint8_t>& buffer, string& output)
+{
+	size_t pos = 0;
+	while(pos + sizeof(RecordHeader) <= buffer.size()) {
+		RecordHeader header;
+		memcpy(&header, buffer.data() + pos, sizeof(RecordHeader));
+		pos += sizeof(RecordHeader);
+
+		header.Logger->FormatFileRecord(buffer.data() + pos, output);
+		pos += header.Size;
+
+		if(output.size() > 32768) {
+			_outputFile << output;
+			output.clear();
+		}
+	}
+
+	if(!output.empty()) {
+		_outputFile << output;
+		output.clear();
+	}
+}
@@ -1,48 +1,57 @@
 #pragma once
 #include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "Utilities/SimpleLock.h"
 
+class ITraceLogger;
+
+//Saves the trace log to a file.
+//The emulation thread only copies a small binary record (cpu/ppu state, disassembly info, etc.) for each row,
+//the records are converted to text (by the trace logger that logged them) and written to disk on a separate thread.
 class TraceLogFileSaver
 {
 private:
+	struct RecordHeader
+	{
+		ITraceLogger* Logger;
+		uint32_t Size;
+	};
+
+	static constexpr size_t BufferSize = 1024 * 1024;
+	static constexpr size_t MaxPendingBuffers = 8;
+
 	bool _enabled = false;
-	string _outputFilepath;
-	string _outputBuffer;
 	ofstream _outputFile;
 
-public:
-	~TraceLogFileSaver()
-	{
-		StopLogging();
-	}
+	SimpleLock _lock;
+	vector<uint8_t> _writeBuffer;
 
-	void StartLogging(string filename)
-	{
-		_outputBuffer.clear();
-		_outputFile.open(filename, ios::out | ios::binary);
-		_enabled = true;
-	}
+	std::thread _formatThread;
+	std::mutex _mutex;
+	std::condition_variable _signal;
+	std::deque<vector<uint8_t>> _pendingBuffers;
+	vector<vector<uint8_t>> _freeBuffers;
+	bool _formatting = false;
+	bool _stopFlag = false;
 
-	void StopLogging()
-	{
-		if(_enabled) {
-			_enabled = false;
-			if(_outputFile) {
-				if(!_outputBuffer.empty()) {
-					_outputFile << _outputBuffer;
-				}
-				_outputFile.close();
-			}
-		}
-	}
+	void SubmitBuffer();
+	void FormatThread();
+	void FormatBuffer(vector<uint8_t>& buffer, string& output);
+
+public:
+	~TraceLogFileSaver();
+
+	void StartLogging(string filename);
+	void StopLogging();
 
 	__forceinline bool IsEnabled() { return _enabled; }
 
-	void Log(string& log)
-	{
-		_outputBuffer += log + '\n';
-		if(_outputBuffer.size() > 32768) {
-			_outputFile << _outputBuffer;
-			_outputBuffer.clear();
-		}
-	}
-};
\ No newline at end of file
+	void Log(ITraceLogger* logger, const void* record, uint32_t size);
+
+	//Waits until all rows logged so far have been formatted and written to the file
+	//Must be called before changing a trace logger's options, since the formatting thread uses them
+	void WaitForFormatting();
+};
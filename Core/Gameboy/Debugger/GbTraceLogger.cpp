@@ -39,7 +39,7 @@ RowDataType GbTraceLogger::GetFormatTagType(string& tag)
 	}
 }
 
-void GbTraceLogger::GetTraceRow(string &output, GbCpuState &cpuState, TraceLogPpuState &ppuState, DisassemblyInfo &disassemblyInfo)
+void GbTraceLogger::GetTraceRow(string &output, GbCpuState &cpuState, TraceLogPpuState &ppuState, DisassemblyInfo &disassemblyInfo, TraceLogMemoryState* memState)
 {
 	constexpr char activeStatusLetters[4] = { 'Z', 'N', 'H', 'C' };
 	constexpr char inactiveStatusLetters[4] = { 'z', 'n', 'h', 'c' };
@@ -56,7 +56,7 @@ void GbTraceLogger::GetTraceRow(string &output, GbCpuState &cpuState, TraceLogPp
 			case RowDataType::L: WriteIntValue(output, cpuState.L, rowPart); break;
 			case RowDataType::SP: WriteIntValue(output, cpuState.SP, rowPart); break;
 			case RowDataType::PS: GetStatusFlag(activeStatusLetters, inactiveStatusLetters, output, cpuState.Flags >> 4, rowPart, 4); break;
-			default: ProcessSharedTag(rowPart, output, cpuState, ppuState, disassemblyInfo); break;
+			default: ProcessSharedTag(rowPart, output, cpuState, ppuState, disassemblyInfo, memState); break;
 		}
 	}
 }
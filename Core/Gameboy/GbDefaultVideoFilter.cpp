@@ -104,9 +104,20 @@ void GbDefaultVideoFilter::ApplyFilter(uint16_t* ppuOutputBuffer)
 	uint32_t xOffset = overscan.Left;
 	uint32_t yOffset = overscan.Top;
 
+	//Palette lookups can't be vectorized with SSE2/NEON (no gather instructions), keep the loops simple for the compiler
 	for(uint32_t i = 0; i < frameInfo.Height; i++) {
-		for(uint32_t j = 0; j < frameInfo.Width; j++) {
-			out[i * frameInfo.Width + j] = GetPixel(ppuOutputBuffer, i * width + j + yOffset + xOffset);
+		uint32_t offset = i * width + yOffset + xOffset;
+		uint16_t* src = ppuOutputBuffer + offset;
+		uint32_t* dst = out + i * frameInfo.Width;
+		if(_blendFrames) {
+			uint16_t* prev = _prevFrame + offset;
+			for(uint32_t j = 0; j < frameInfo.Width; j++) {
+				dst[j] = BlendPixels(_calculatedPalette[prev[j]], _calculatedPalette[src[j]]);
+			}
+		} else {
+			for(uint32_t j = 0; j < frameInfo.Width; j++) {
+				dst[j] = _calculatedPalette[src[j]];
+			}
 		}
 	}
 
@@ -115,15 +126,6 @@ void GbDefaultVideoFilter::ApplyFilter(uint16_t* ppuOutputBuffer)
 	}
 }
 
-uint32_t GbDefaultVideoFilter::GetPixel(uint16_t* ppuFrame, uint32_t offset)
-{
-	if(_blendFrames) {
-		return BlendPixels(_calculatedPalette[_prevFrame[offset]], _calculatedPalette[ppuFrame[offset]]);
-	} else {
-		return _calculatedPalette[ppuFrame[offset]];
-	}
-}
-
 uint32_t GbDefaultVideoFilter::BlendPixels(uint32_t a, uint32_t b)
 {
 	return ((((a) ^ (b)) & 0xfffefefeL) >> 1) + ((a) & (b));
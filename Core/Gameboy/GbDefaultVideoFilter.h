@@ -18,7 +18,6 @@ private:
 
 	__forceinline static uint8_t To8Bit(uint8_t color);
 	__forceinline static uint32_t BlendPixels(uint32_t a, uint32_t b);
-	__forceinline uint32_t GetPixel(uint16_t* ppuFrame, uint32_t offset);
 
 protected:
 	void OnBeforeApplyFilter() override;
@@ -18,7 +18,7 @@ protected:
 public:
 	NesTraceLogger(Debugger* debugger, IDebugger* cpuDebugger, NesConsole* console);
 	
-	void GetTraceRow(string& output, NesCpuState& cpuState, TraceLogPpuState& ppuState, DisassemblyInfo& disassemblyInfo);
+	void GetTraceRow(string& output, NesCpuState& cpuState, TraceLogPpuState& ppuState, DisassemblyInfo& disassemblyInfo, TraceLogMemoryState* memState = nullptr);
 	void LogPpuState();
 
 	__forceinline uint32_t GetProgramCounter(NesCpuState& state) { return state.PC; }
@@ -40,8 +40,11 @@ void HdAudioDevice::Serialize(Serializer& s)
 		SV(_album); SV(_lastBgmTrack); SV(trackOffset); SV(_sfxVolume); SV(_bgmVolume); SV(_playbackOptions);
 	} else {
 		SV(_album); SV(_lastBgmTrack); SV(trackOffset); SV(_sfxVolume); SV(_bgmVolume); SV(_playbackOptions);
-		if(_lastBgmTrack != -1 && trackOffset > 0) {
-			PlayBgmTrack(_lastBgmTrack, trackOffset);
+		if(_lastBgmTrack != -1) {
+			//Offset 0 is valid (the track started on the frame the state was saved)
+			PlayBgmTrack(_lastBgmTrack, (uint32_t)std::max(trackOffset, 0));
+		} else {
+			_oggMixer->StopBgm();
 		}
 		_oggMixer->SetBgmVolume(_bgmVolume);
 		_oggMixer->SetSfxVolume(_sfxVolume);
@@ -53,10 +56,9 @@ bool HdAudioDevice::PlayBgmTrack(int trackId, uint32_t startOffset)
 {
 	auto result = _hdData->BgmFilesById.find(trackId);
 	if(result != _hdData->BgmFilesById.end()) {
-		if(_oggMixer->Play(result->second.Filename, false, startOffset, result->second.LoopPosition)) {
-			_lastBgmTrack = trackId;
-			return true;
-		}
+		_oggMixer->Play(result->second.Filename, false, startOffset, result->second.LoopPosition);
+		_lastBgmTrack = trackId;
+		return true;
 	} else {
 		MessageManager::Log("[HDPack] Invalid album+track combination: " + std::to_string(_album) + ":" + std::to_string(trackId & 0xFF));
 	}
@@ -67,7 +69,8 @@ bool HdAudioDevice::PlaySfx(uint8_t sfxNumber)
 {
 	auto result = _hdData->SfxFilesById.find(_album * 256 + sfxNumber);
 	if(result != _hdData->SfxFilesById.end()) {
-		return !_oggMixer->Play(result->second, true, 0, 0);
+		_oggMixer->Play(result->second, true, 0, 0);
+		return false;
 	} else {
 		MessageManager::Log("[HDPack] Invalid album+sfx number combination: " + std::to_string(_album) + ":" + std::to_string(sfxNumber));
 		return false;
@@ -6,6 +6,8 @@
 #include "Utilities/HexUtilities.h"
 #include "Utilities/SimpleLock.h"
 #include "Utilities/Timer.h"
+#include "Utilities/ThreadPool.h"
+#include "NES/HdPacks/HdPackImageCache.h"
 
 class BaseHdNesPack;
 
@@ -98,6 +100,14 @@ struct HdPpuTileInfo : public HdTileKey
 	uint8_t SpriteColor = 0;
 	uint8_t PpuBackgroundColor = 0;
 	uint8_t PaletteOffset = 0;
+
+	//Hash of the tile's key, calculated by the PPU when the tile is drawn (must be updated when the key changes)
+	uint32_t Hash = 0;
+
+	void UpdateHash()
+	{
+		Hash = GetHashCode();
+	}
 };
 
 struct HdPpuPixelInfo
@@ -198,6 +208,14 @@ public:
 		
 	}
 
+	//Evaluates the conditions that have the same result for the whole frame (their result is cached until the next frame)
+	void PrecalculateResult()
+	{
+		if(_useCache && _resultCache < 0) {
+			CheckCondition(0, 0, nullptr);
+		}
+	}
+
 protected:
 	int8_t _resultCache = -1;
 	bool _useCache = false;
@@ -208,11 +226,12 @@ protected:
 struct HdPackBitmapInfo
 {
 private:
-	bool _initDone = false;
+	atomic<bool> _initDone = false;
 	SimpleLock _lock;
 
 public:
 	string PngName;
+	string CacheFolder;
 	vector<uint8_t> FileData;
 	vector<uint32_t> PixelData;
 	uint32_t Width;
@@ -229,10 +248,23 @@ public:
 			return;
 		}
 
+		string cacheFilename;
+		if(!CacheFolder.empty()) {
+			cacheFilename = HdPackImageCache::GetCacheFilename(CacheFolder, FileData);
+			if(HdPackImageCache::LoadImage(cacheFilename, PixelData, Width, Height)) {
+				FileData = {};
+				_initDone = true;
+				return;
+			}
+		}
+
 		//Timer tmr;
 		if(PNGHelper::ReadPNG(FileData, PixelData, Width, Height)) {
 			//MessageManager::Log("[HDPack] PNG file loaded: " + PngName + " (" + std::to_string(tmr.GetElapsedMS()) + ")");
 			PremultiplyAlpha();
+			if(!cacheFilename.empty()) {
+				HdPackImageCache::SaveImage(cacheFilename, PixelData, Width, Height);
+			}
 		} else {
 			MessageManager::Log("[HDPack] PNG file " + PngName + " is invalid.");
 		}
@@ -257,7 +289,8 @@ public:
 struct HdPackTileInfo : public HdTileKey
 {
 private:
-	bool _needInit = true;
+	atomic<bool> _needInit = true;
+	SimpleLock _initLock;
 
 public:
 	uint32_t X;
@@ -334,7 +367,12 @@ public:
 
 	__noinline void Init()
 	{
-		_needInit = false;
+		//Tiles can be used by several threads at once (when the screen is drawn in parallel)
+		auto lock = _initLock.AcquireSafe();
+		if(!_needInit) {
+			return;
+		}
+
 		Bitmap->Init();
 
 		uint32_t bitmapOffset = Y * Bitmap->Width + X;
@@ -349,6 +387,7 @@ public:
 		}
 
 		UpdateFlags();
+		_needInit = false;
 	}
 
 	string ToString(int pngIndex)
@@ -459,6 +498,96 @@ struct FallbackTileInfo
 	int32_t FallbackTileIndex;
 };
 
+//Open addressing hash table used to find the HD tiles that match a tile while rendering
+//Built once the pack is loaded - all slots are in a single array, which is much more cache-friendly than unordered_map
+class HdTileTable
+{
+public:
+	struct Entry
+	{
+		HdTileKey Key;
+		vector<HdPackTileInfo*>* Tiles = nullptr;
+
+		//Set when the first tile of the list has no conditions (it always matches)
+		HdPackTileInfo* UnconditionalTile = nullptr;
+	};
+
+private:
+	struct Slot
+	{
+		uint32_t Hash = 0;
+		uint32_t EntryIndex = 0; //0 = empty slot, otherwise index + 1
+	};
+
+	vector<Slot> _slots;
+	vector<Entry> _entries;
+	uint32_t _mask = 0;
+	uint32_t _shift = 0;
+
+	__forceinline uint32_t GetSlotIndex(uint32_t hash)
+	{
+		//The tile key hashes are poorly distributed in their lower bits, use the upper bits of the product instead
+		return (uint32_t)(((uint64_t)hash * 0x9E3779B97F4A7C15ULL) >> _shift);
+	}
+
+public:
+	//The table keeps pointers to the map's lists - the map must not be modified after this is called
+	void Build(unordered_map<HdTileKey, vector<HdPackTileInfo*>>& tilesByKey)
+	{
+		uint32_t bits = 4;
+		while(((size_t)1 << bits) < tilesByKey.size() * 2) {
+			//Keep the load factor under 50%
+			bits++;
+		}
+
+		_slots.clear();
+		_slots.resize((size_t)1 << bits);
+		_mask = (1 << bits) - 1;
+		_shift = 64 - bits;
+
+		_entries.clear();
+		_entries.reserve(tilesByKey.size());
+		for(auto& [key, tiles] : tilesByKey) {
+			Entry entry;
+			entry.Key = key;
+			entry.Tiles = &tiles;
+			if(tiles.size() > 0 && tiles[0]->Conditions.empty()) {
+				entry.UnconditionalTile = tiles[0];
+			}
+			_entries.push_back(entry);
+
+			uint32_t hash = key.GetHashCode();
+			uint32_t index = GetSlotIndex(hash);
+			while(_slots[index].EntryIndex != 0) {
+				index = (index + 1) & _mask;
+			}
+			_slots[index].Hash = hash;
+			_slots[index].EntryIndex = (uint32_t)_entries.size();
+		}
+	}
+
+	__forceinline Entry* Find(const HdTileKey& key, uint32_t hash)
+	{
+		if(_slots.empty()) {
+			return nullptr;
+		}
+
+		uint32_t index = GetSlotIndex(hash);
+		while(true) {
+			Slot& slot = _slots[index];
+			if(slot.EntryIndex == 0) {
+				return nullptr;
+			} else if(slot.Hash == hash) {
+				Entry& entry = _entries[slot.EntryIndex - 1];
+				if(entry.Key == key) {
+					return &entry;
+				}
+			}
+			index = (index + 1) & _mask;
+		}
+	}
+};
+
 struct BgmTrackInfo
 {
 	string Filename;
@@ -468,7 +597,7 @@ struct BgmTrackInfo
 struct HdPackData
 {
 private:
-	bool _cancelLoad = false;
+	atomic<bool> _cancelLoad = false;
 
 public:
 	static constexpr int BgLayerCount = 40;
@@ -482,6 +611,7 @@ public:
 	vector<FallbackTileInfo> FallbackTiles;
 	unordered_set<uint32_t> WatchedMemoryAddresses;
 	unordered_map<HdTileKey, vector<HdPackTileInfo*>> TileByKey;
+	HdTileTable TileTable;
 	unordered_map<string, string> PatchesByHash;
 	unordered_map<int, BgmTrackInfo> BgmFilesById;
 	unordered_map<int, string> SfxFilesById;
@@ -494,6 +624,9 @@ public:
 	uint32_t Version = 0;
 	uint32_t OptionFlags = 0;
 
+	//When set, decoded images are cached in this folder (see HdPackImageCache)
+	string ImageCacheFolder;
+
 	HdPackData() { }
 	~HdPackData() { }
 
@@ -502,18 +635,23 @@ public:
 
 	void LoadAsync()
 	{
+		//Decode all images on a pool of threads - backgrounds are queued first since they are
+		//usually the largest images. Images that are needed before they are decoded here are
+		//decoded on demand by the emulation thread (Init is thread-safe)
+		vector<HdPackBitmapInfo*> bitmaps;
 		for(auto& bitmap : BackgroundFileData) {
-			bitmap->Init();
-			if(_cancelLoad) {
-				return;
-			}
+			bitmaps.push_back(bitmap.get());
 		}
 		for(auto& bitmap : ImageFileData) {
-			bitmap->Init();
-			if(_cancelLoad) {
-				return;
-			}
+			bitmaps.push_back(bitmap.get());
 		}
+
+		ThreadPool pool(ThreadPool::GetDefaultThreadCount());
+		pool.ParallelFor((uint32_t)bitmaps.size(), [&](uint32_t i) {
+			if(!_cancelLoad) {
+				bitmaps[i]->Init();
+			}
+		});
 	}
 
 	void CancelLoad()
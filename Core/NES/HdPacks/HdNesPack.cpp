@@ -10,6 +10,7 @@
 #include "Shared/EmuSettings.h"
 #include "Utilities/FolderUtilities.h"
 #include "Utilities/PNGHelper.h"
+#include "Utilities/ThreadPool.h"
 
 template<uint32_t scale>
 HdNesPack<scale>::HdNesPack(NesConsole* console, EmuSettings* settings, HdPackData* hdData)
@@ -222,16 +223,16 @@ void HdNesPack<scale>::DrawTile(HdPpuTileInfo &tileInfo, HdPackTileInfo &hdPackT
 }
 
 template<uint32_t scale>
-void HdNesPack<scale>::OnLineStart(HdPpuPixelInfo &lineFirstPixel, uint8_t y)
+void HdNesPack<scale>::OnLineStart(HdBandState& band, HdPpuPixelInfo &lineFirstPixel, uint8_t y)
 {
-	_scrollX = ((lineFirstPixel.TmpVideoRamAddr & 0x1F) << 3) | lineFirstPixel.XScroll | ((lineFirstPixel.TmpVideoRamAddr & 0x400) ? 0x100 : 0);
-	_useCachedTile = false;
+	band.ScrollX = ((lineFirstPixel.TmpVideoRamAddr & 0x1F) << 3) | lineFirstPixel.XScroll | ((lineFirstPixel.TmpVideoRamAddr & 0x400) ? 0x100 : 0);
+	band.UseCachedTile = false;
 
 	int32_t scrollY = (((lineFirstPixel.TmpVideoRamAddr & 0x3E0) >> 2) | ((lineFirstPixel.TmpVideoRamAddr & 0x7000) >> 12)) + ((lineFirstPixel.TmpVideoRamAddr & 0x800) ? 240 : 0);
 	
 	for(int layer = 0; layer < 4; layer++) {
 		for(int i = 0; i < _activeBgCount[layer]; i++) {
-			HdBgConfig& cfg = _bgConfig[layer * HdNesPack::PriorityLevelsPerLayer + i];
+			HdBgConfig& cfg = band.BgConfig[layer * HdNesPack::PriorityLevelsPerLayer + i];
 			if(cfg.BackgroundIndex < 0) {
 				continue;
 			}
@@ -239,7 +240,7 @@ void HdNesPack<scale>::OnLineStart(HdPpuPixelInfo &lineFirstPixel, uint8_t y)
 			HdBackgroundInfo& bgInfo = _hdData->BackgroundsByPriority[cfg.BgPriority][cfg.BackgroundIndex];
 			bgInfo.Data->Init();
 
-			cfg.BgScrollX = (int32_t)(_scrollX * bgInfo.HorizontalScrollRatio);
+			cfg.BgScrollX = (int32_t)(band.ScrollX * bgInfo.HorizontalScrollRatio);
 			cfg.BgScrollY = (int32_t)(scrollY * bgInfo.VerticalScrollRatio);
 			if(y >= -cfg.BgScrollY && (y + bgInfo.Top + cfg.BgScrollY + 1) * scale <= bgInfo.Data->Height) {
 				cfg.BgMinX = -cfg.BgScrollX;
@@ -277,6 +278,10 @@ void HdNesPack<scale>::OnBeforeApplyFilter()
 	for(unique_ptr<HdPackCondition>& condition : _hdData->Conditions) {
 		condition->Initialize(_hdScreenInfo, this);
 	}
+	for(unique_ptr<HdPackCondition>& condition : _hdData->Conditions) {
+		//Evaluate the conditions that have the same result for the entire frame before the scanlines are processed in parallel
+		condition->PrecalculateResult();
+	}
 
 	if(_hdData->Palette.size() == 0x40) {
 		memcpy(_palette, _hdData->Palette.data(), 0x40 * sizeof(uint32_t));
@@ -363,67 +368,112 @@ void HdNesPack<scale>::InsertAdditionalSprite(int32_t sourceX, int32_t sourceY,
 			newSprite.TileIndex = additionalSprite.AdditionalTile.TileIndex;
 			newSprite.PaletteColors = additionalSprite.AdditionalTile.PaletteColors;
 			memcpy(newSprite.TileData, additionalSprite.AdditionalTile.TileData, sizeof(newSprite.TileData));
+			newSprite.UpdateHash();
 			pixelInfo.SpriteCount++;
 		}
 	}
 }
 
 template<uint32_t scale>
-HdPackTileInfo* HdNesPack<scale>::GetCachedMatchingTile(uint32_t x, uint32_t y, HdPpuTileInfo* tile)
+HdPackTileInfo* HdNesPack<scale>::GetCachedMatchingTile(HdBandState& band, uint32_t x, uint32_t y, HdPpuTileInfo* tile)
 {
-	if(((_scrollX + x) & 0x07) == 0) {
-		_useCachedTile = false;
+	if(((band.ScrollX + x) & 0x07) == 0) {
+		band.UseCachedTile = false;
 	}
 
 	bool disableCache = false;
 	HdPackTileInfo* hdPackTileInfo;
-	if(_useCachedTile) {
-		hdPackTileInfo = _cachedTile;
+	if(band.UseCachedTile) {
+		hdPackTileInfo = band.CachedTile;
 	} else {
-		hdPackTileInfo = GetMatchingTile(x, y, tile, &disableCache);
+		hdPackTileInfo = GetMatchingTile(band, x, y, tile, &disableCache);
 
 		if(!disableCache && _cacheEnabled) {
 			//Use this tile for the next 8 horizontal pixels
 			//Disable cache if a sprite condition is used, because sprites are not on a 8x8 grid
-			_cachedTile = hdPackTileInfo;
-			_useCachedTile = true;
+			band.CachedTile = hdPackTileInfo;
+			band.UseCachedTile = true;
 		}
 	}
 	return hdPackTileInfo;
 }
 
 template<uint32_t scale>
-HdPackTileInfo* HdNesPack<scale>::GetMatchingTile(uint32_t x, uint32_t y, HdPpuTileInfo* tile, bool* disableCache)
+typename HdNesPack<scale>::HdTileLookup& HdNesPack<scale>::LookupTile(HdBandState& band, HdPpuTileInfo* tile)
 {
-	auto hdTile = _hdData->TileByKey.find(*tile);
-	if(hdTile == _hdData->TileByKey.end()) {
+	//The result of a lookup only depends on the tile's key, so it can be reused until another key with the same index replaces it
+	HdTileLookup& lookup = band.TileLookupCache[tile->Hash & (HdNesPack::TileLookupCacheSize - 1)];
+	if(lookup.Valid && lookup.Hash == tile->Hash && lookup.Key == *tile) {
+		return lookup;
+	}
+
+	lookup.Key = *tile;
+	lookup.Hash = tile->Hash;
+	lookup.Valid = true;
+	lookup.FallbackTileIndex = -1;
+	lookup.Entry = _hdData->TileTable.Find(*tile, tile->Hash);
+	if(!lookup.Entry) {
 		int32_t fallbackTileIndex = GetFallbackTile(tile->TileIndex);
 		if(fallbackTileIndex >= 0) {
-			int32_t orgIndex = tile->TileIndex;
-			tile->TileIndex = fallbackTileIndex;
-			hdTile = _hdData->TileByKey.find(*tile);
-			if(hdTile == _hdData->TileByKey.end()) {
-				tile->TileIndex = orgIndex;
+			HdTileKey fallbackKey = *tile;
+			fallbackKey.TileIndex = fallbackTileIndex;
+			lookup.Entry = _hdData->TileTable.Find(fallbackKey, fallbackKey.GetHashCode());
+			if(lookup.Entry) {
+				lookup.FallbackTileIndex = fallbackTileIndex;
 			}
 		}
-	
-		if(hdTile == _hdData->TileByKey.end()) {
-			hdTile = _hdData->TileByKey.find(tile->GetKey(true));
+
+		if(!lookup.Entry) {
+			HdTileKey defaultKey = tile->GetKey(true);
+			lookup.Entry = _hdData->TileTable.Find(defaultKey, defaultKey.GetHashCode());
 		}
 	}
+	return lookup;
+}
 
-	if(hdTile != _hdData->TileByKey.end()) {
-		for(HdPackTileInfo* hdPackTile : hdTile->second) {
-			if(disableCache != nullptr && hdPackTile->ForceDisableCache) {
-				*disableCache = true;
-			}
+template<uint32_t scale>
+HdPackTileInfo* HdNesPack<scale>::GetMatchingTile(HdBandState& band, uint32_t x, uint32_t y, HdPpuTileInfo* tile, bool* disableCache)
+{
+	HdTileLookup& lookup = LookupTile(band, tile);
+	HdTileTable::Entry* entry = lookup.Entry;
+	if(!entry) {
+		return nullptr;
+	}
 
-			if(hdPackTile->MatchesCondition(x, y, tile)) {
-				if(hdPackTile->NeedInit()) {
-					hdPackTile->Init();
-				}
-				return hdPackTile;
+	if(entry->UnconditionalTile) {
+		HdPackTileInfo* hdPackTile = entry->UnconditionalTile;
+		if(disableCache != nullptr && hdPackTile->ForceDisableCache) {
+			*disableCache = true;
+		}
+		if(hdPackTile->NeedInit()) {
+			hdPackTile->Init();
+		}
+		return hdPackTile;
+	}
+
+	if(lookup.FallbackTileIndex >= 0) {
+		//Check the conditions against a copy of the tile - the screen data can't be modified here because
+		//other bands can read it at the same time (e.g for "tileNearby" conditions)
+		HdPpuTileInfo fallbackTile = *tile;
+		fallbackTile.TileIndex = lookup.FallbackTileIndex;
+		return CheckTileConditions(*entry, x, y, &fallbackTile, disableCache);
+	}
+	return CheckTileConditions(*entry, x, y, tile, disableCache);
+}
+
+template<uint32_t scale>
+HdPackTileInfo* HdNesPack<scale>::CheckTileConditions(HdTileTable::Entry& entry, uint32_t x, uint32_t y, HdPpuTileInfo* tile, bool* disableCache)
+{
+	for(HdPackTileInfo* hdPackTile : *entry.Tiles) {
+		if(disableCache != nullptr && hdPackTile->ForceDisableCache) {
+			*disableCache = true;
+		}
+
+		if(hdPackTile->MatchesCondition(x, y, tile)) {
+			if(hdPackTile->NeedInit()) {
+				hdPackTile->Init();
 			}
+			return hdPackTile;
 		}
 	}
 
@@ -431,9 +481,9 @@ HdPackTileInfo* HdNesPack<scale>::GetMatchingTile(uint32_t x, uint32_t y, HdPpuT
 }
 
 template<uint32_t scale>
-void HdNesPack<scale>::DrawBackgroundLayer(uint8_t priority, uint32_t x, uint32_t y, uint32_t* outputBuffer, uint32_t screenWidth)
+void HdNesPack<scale>::DrawBackgroundLayer(HdBandState& band, uint8_t priority, uint32_t x, uint32_t y, uint32_t* outputBuffer, uint32_t screenWidth)
 {
-	HdBgConfig bgConfig = _bgConfig[(int)priority];
+	HdBgConfig bgConfig = band.BgConfig[(int)priority];
 	if((int32_t)x >= bgConfig.BgMinX && (int32_t)x <= bgConfig.BgMaxX) {
 		HdBackgroundInfo& bgInfo = _hdData->BackgroundsByPriority[bgConfig.BgPriority][bgConfig.BackgroundIndex];
 		switch(bgInfo.BlendMode) {
@@ -445,7 +495,7 @@ void HdNesPack<scale>::DrawBackgroundLayer(uint8_t priority, uint32_t x, uint32_
 }
 
 template<uint32_t scale>
-void HdNesPack<scale>::GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelInfo, uint32_t *outputBuffer, uint32_t screenWidth)
+void HdNesPack<scale>::GetPixels(HdBandState& band, uint32_t x, uint32_t y, HdPpuPixelInfo &pixelInfo, uint32_t *outputBuffer, uint32_t screenWidth)
 {
 	HdPackTileInfo *hdPackTileInfo = nullptr;
 	HdPackTileInfo *hdPackSpriteInfo = nullptr;
@@ -453,7 +503,7 @@ void HdNesPack<scale>::GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelIn
 	bool hasSprite = pixelInfo.SpriteCount > 0;
 	bool renderOriginalTiles = ((_hdData->OptionFlags & (int)HdPackOptions::DontRenderOriginalTiles) == 0);
 	if(pixelInfo.Tile.TileIndex != HdPpuTileInfo::NoTile) {
-		hdPackTileInfo = GetCachedMatchingTile(x, y, &pixelInfo.Tile);
+		hdPackTileInfo = GetCachedMatchingTile(band, x, y, &pixelInfo.Tile);
 	}
 
 	int lowestBgSprite = 999;
@@ -461,7 +511,7 @@ void HdNesPack<scale>::GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelIn
 	DrawColor(_palette[pixelInfo.Tile.PpuBackgroundColor], outputBuffer, screenWidth);
 
 	for(int i = 0; i < _activeBgCount[0]; i++) {
-		DrawBackgroundLayer(HdNesPack::BehindBgSpritesPriority+i, x, y, outputBuffer, screenWidth);
+		DrawBackgroundLayer(band, HdNesPack::BehindBgSpritesPriority+i, x, y, outputBuffer, screenWidth);
 	}
 
 	if(hasSprite) {
@@ -471,7 +521,7 @@ void HdNesPack<scale>::GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelIn
 					lowestBgSprite = k;
 				}
 
-				hdPackSpriteInfo = GetMatchingTile(x, y, &pixelInfo.Sprite[k]);
+				hdPackSpriteInfo = GetMatchingTile(band, x, y, &pixelInfo.Sprite[k]);
 				if(hdPackSpriteInfo) {
 					DrawTile(pixelInfo.Sprite[k], *hdPackSpriteInfo, outputBuffer, screenWidth);
 				} else if(pixelInfo.Sprite[k].SpriteColorIndex != 0) {
@@ -482,7 +532,7 @@ void HdNesPack<scale>::GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelIn
 	}
 	
 	for(int i = 0; i < _activeBgCount[1]; i++) {
-		DrawBackgroundLayer(HdNesPack::BehindBgPriority+i, x, y, outputBuffer, screenWidth);
+		DrawBackgroundLayer(band, HdNesPack::BehindBgPriority+i, x, y, outputBuffer, screenWidth);
 	}
 	
 	if(hdPackTileInfo) {
@@ -495,13 +545,13 @@ void HdNesPack<scale>::GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelIn
 	}
 
 	for(int i = 0; i < _activeBgCount[2]; i++) {
-		DrawBackgroundLayer(HdNesPack::BehindFgSpritesPriority+i, x, y, outputBuffer, screenWidth);
+		DrawBackgroundLayer(band, HdNesPack::BehindFgSpritesPriority+i, x, y, outputBuffer, screenWidth);
 	}
 
 	if(hasSprite) {
 		for(int k = pixelInfo.SpriteCount - 1; k >= 0; k--) {
 			if(!pixelInfo.Sprite[k].BackgroundPriority && lowestBgSprite > k) {
-				hdPackSpriteInfo = GetMatchingTile(x, y, &pixelInfo.Sprite[k]);
+				hdPackSpriteInfo = GetMatchingTile(band, x, y, &pixelInfo.Sprite[k]);
 				if(hdPackSpriteInfo) {
 					DrawTile(pixelInfo.Sprite[k], *hdPackSpriteInfo, outputBuffer, screenWidth);
 				} else if(pixelInfo.Sprite[k].SpriteColorIndex != 0) {
@@ -512,7 +562,46 @@ void HdNesPack<scale>::GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelIn
 	}
 
 	for(int i = 0; i < _activeBgCount[3]; i++) {
-		DrawBackgroundLayer(HdNesPack::ForegroundPriority+i, x, y, outputBuffer, screenWidth);
+		DrawBackgroundLayer(band, HdNesPack::ForegroundPriority+i, x, y, outputBuffer, screenWidth);
+	}
+}
+
+template<uint32_t scale>
+uint32_t HdNesPack<scale>::GetBandCount(uint32_t lineCount)
+{
+	uint32_t threadCount = _settings->GetVideoConfig().FilterThreadCount;
+	if(threadCount == 0) {
+		threadCount = ThreadPool::GetDefaultThreadCount();
+	}
+
+	if(threadCount <= 1) {
+		_threadPool.reset();
+		return 1;
+	}
+
+	if(!_threadPool || _threadPool->GetThreadCount() != threadCount) {
+		_threadPool.reset(new ThreadPool(threadCount));
+	}
+
+	//Use more bands than threads to balance the load when some bands take longer than others (e.g more sprites)
+	return std::max<uint32_t>(1, std::min(threadCount * 2, lineCount / HdNesPack::MinBandHeight));
+}
+
+template<uint32_t scale>
+void HdNesPack<scale>::ProcessLines(HdBandState& band, uint32_t firstLine, uint32_t lastLine, uint32_t* outputBuffer, uint32_t screenWidth, OverscanDimensions& overscan)
+{
+	memcpy(band.BgConfig, _bgConfig, sizeof(_bgConfig));
+
+	for(uint32_t i = firstLine; i < lastLine; i++) {
+		OnLineStart(band, _hdScreenInfo->ScreenTiles[i << 8], i);
+		uint32_t bufferIndex = (i - overscan.Top) * screenWidth * scale;
+		uint32_t lineStartIndex = bufferIndex;
+		for(uint32_t j = overscan.Left, jMax = 256 - overscan.Right; j < jMax; j++) {
+			GetPixels(band, j, i, _hdScreenInfo->ScreenTiles[i * 256 + j], outputBuffer + bufferIndex, screenWidth);
+			bufferIndex += scale;
+		}
+
+		ProcessGrayscaleAndEmphasis(_hdScreenInfo->ScreenTiles[i * 256], outputBuffer + lineStartIndex, screenWidth);
 	}
 }
 
@@ -523,17 +612,22 @@ void HdNesPack<scale>::Process(HdScreenInfo *hdScreenInfo, uint32_t* outputBuffe
 	uint32_t hdScale = GetScale();
 	uint32_t screenWidth = (NesConstants::ScreenWidth - overscan.Left - overscan.Right) * hdScale;
 
+	//Everything that can modify the screen data or the shared state (additional sprites, conditions, etc.) is done here, before the bands are processed
 	OnBeforeApplyFilter();
-	for(uint32_t i = overscan.Top, iMax = 240 - overscan.Bottom; i < iMax; i++) {
-		OnLineStart(hdScreenInfo->ScreenTiles[i << 8], i);
-		uint32_t bufferIndex = (i - overscan.Top) * screenWidth * hdScale;
-		uint32_t lineStartIndex = bufferIndex;
-		for(uint32_t j = overscan.Left, jMax = 256 - overscan.Right; j < jMax; j++) {
-			GetPixels(j, i, hdScreenInfo->ScreenTiles[i * 256 + j], outputBuffer + bufferIndex, screenWidth);
-			bufferIndex += hdScale;
-		}
 
-		ProcessGrayscaleAndEmphasis(hdScreenInfo->ScreenTiles[i * 256], outputBuffer + lineStartIndex, screenWidth);
+	uint32_t firstLine = overscan.Top;
+	uint32_t lineCount = 240 - overscan.Bottom - overscan.Top;
+	uint32_t bandCount = GetBandCount(lineCount);
+	if(_bands.size() < bandCount) {
+		_bands.resize(bandCount);
+	}
+
+	if(bandCount == 1) {
+		ProcessLines(_bands[0], firstLine, firstLine + lineCount, outputBuffer, screenWidth, overscan);
+	} else {
+		_threadPool->ParallelFor(bandCount, [&](uint32_t band) {
+			ProcessLines(_bands[band], firstLine + lineCount * band / bandCount, firstLine + lineCount * (band + 1) / bandCount, outputBuffer, screenWidth, overscan);
+		});
 	}
 }
 
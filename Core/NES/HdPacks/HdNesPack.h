@@ -4,6 +4,7 @@
 
 class NesConsole;
 class EmuSettings;
+class ThreadPool;
 
 class BaseHdNesPack
 {
@@ -46,6 +47,32 @@ private:
 		int16_t BgMaxX = -1;
 	};
 
+	struct HdTileLookup
+	{
+		HdTileKey Key;
+		uint32_t Hash = 0;
+		bool Valid = false;
+		int32_t FallbackTileIndex = -1;
+		HdTileTable::Entry* Entry = nullptr;
+	};
+
+	static constexpr uint32_t TileLookupCacheSize = 0x400;
+	static constexpr uint32_t MinBandHeight = 16;
+
+	//The frame is drawn in bands of scanlines that can be processed in parallel - this is the state used by each band
+	struct HdBandState
+	{
+		HdBgConfig BgConfig[40] = {};
+		HdPackTileInfo* CachedTile = nullptr;
+		bool UseCachedTile = false;
+		int32_t ScrollX = 0;
+
+		//Results of the most recent tile table lookups (including the fallback tile and default tile lookups), indexed by the tile's hash
+		vector<HdTileLookup> TileLookupCache;
+
+		HdBandState() { TileLookupCache.resize(HdNesPack::TileLookupCacheSize); }
+	};
+
 	static constexpr uint8_t PriorityLevelsPerLayer = 10;
 	static constexpr uint8_t BehindBgSpritesPriority = 0 * PriorityLevelsPerLayer;
 	static constexpr uint8_t BehindBgPriority = 1 * PriorityLevelsPerLayer;
@@ -60,13 +87,13 @@ private:
 	HdBgConfig _bgConfig[40] = {};
 
 	uint32_t _palette[512] = {};
-	HdPackTileInfo* _cachedTile = nullptr;
 	bool _cacheEnabled = false;
-	bool _useCachedTile = false;
-	int32_t _scrollX = 0;
 	
 	unordered_map<HdTileKey, vector<HdPackAdditionalSpriteInfo>> _additionalTilesByKey;
 
+	vector<HdBandState> _bands;
+	unique_ptr<ThreadPool> _threadPool;
+
 	template<HdPackBlendMode blendMode>
 	__forceinline void BlendColors(uint8_t output[4], uint8_t input[4]);
 
@@ -74,22 +101,26 @@ private:
 	__forceinline void DrawColor(uint32_t color, uint32_t* outputBuffer, uint32_t screenWidth);
 	__forceinline void DrawTile(HdPpuTileInfo &tileInfo, HdPackTileInfo &hdPackTileInfo, uint32_t* outputBuffer, uint32_t screenWidth);
 	
-	__forceinline HdPackTileInfo* GetCachedMatchingTile(uint32_t x, uint32_t y, HdPpuTileInfo* tile);
-	__forceinline HdPackTileInfo* GetMatchingTile(uint32_t x, uint32_t y, HdPpuTileInfo* tile, bool* disableCache = nullptr);
+	__forceinline HdPackTileInfo* GetCachedMatchingTile(HdBandState& band, uint32_t x, uint32_t y, HdPpuTileInfo* tile);
+	__forceinline HdTileLookup& LookupTile(HdBandState& band, HdPpuTileInfo* tile);
+	__forceinline HdPackTileInfo* GetMatchingTile(HdBandState& band, uint32_t x, uint32_t y, HdPpuTileInfo* tile, bool* disableCache = nullptr);
+	__forceinline HdPackTileInfo* CheckTileConditions(HdTileTable::Entry& entry, uint32_t x, uint32_t y, HdPpuTileInfo* tile, bool* disableCache);
 
-	__forceinline void DrawBackgroundLayer(uint8_t priority, uint32_t x, uint32_t y, uint32_t* outputBuffer, uint32_t screenWidth);
+	__forceinline void DrawBackgroundLayer(HdBandState& band, uint8_t priority, uint32_t x, uint32_t y, uint32_t* outputBuffer, uint32_t screenWidth);
 
 	template<HdPackBlendMode blendMode>
 	__forceinline void DrawCustomBackground(HdBackgroundInfo& bgInfo, uint32_t *outputBuffer, uint32_t x, uint32_t y, uint32_t screenWidth);
 
-	void OnLineStart(HdPpuPixelInfo &lineFirstPixel, uint8_t y);
+	void OnLineStart(HdBandState& band, HdPpuPixelInfo &lineFirstPixel, uint8_t y);
 	int32_t GetLayerIndex(uint8_t priority);
 	void OnBeforeApplyFilter();
 
 	void ProcessAdditionalSprites();
 	void InsertAdditionalSprite(int32_t x, int32_t y, HdPpuTileInfo& sprite, HdPackAdditionalSpriteInfo& additionalSprite);
 
-	__forceinline void GetPixels(uint32_t x, uint32_t y, HdPpuPixelInfo &pixelInfo, uint32_t *outputBuffer, uint32_t screenWidth);
+	__forceinline void GetPixels(HdBandState& band, uint32_t x, uint32_t y, HdPpuPixelInfo &pixelInfo, uint32_t *outputBuffer, uint32_t screenWidth);
+	void ProcessLines(HdBandState& band, uint32_t firstLine, uint32_t lastLine, uint32_t* outputBuffer, uint32_t screenWidth, OverscanDimensions& overscan);
+	uint32_t GetBandCount(uint32_t lineCount);
 	__forceinline void ProcessGrayscaleAndEmphasis(HdPpuPixelInfo &pixelInfo, uint32_t* outputBuffer, uint32_t hdScreenWidth);
 	
 	void InitializeFallbackTiles();
@@ -120,6 +120,7 @@ public:
 						} else {
 							tileInfo.Sprite[j].PaletteColors = _paletteRam[sprite.PaletteOffset + 3] | (_paletteRam[sprite.PaletteOffset + 2] << 8) | (_paletteRam[sprite.PaletteOffset + 1] << 16);
 						}
+						tileInfo.Sprite[j].UpdateHash();
 						if(spriteEx.OffsetY >= 8) {
 							tileInfo.Sprite[j].OffsetY = spriteEx.OffsetY - 8;
 						} else {
@@ -168,6 +169,7 @@ public:
 				} else {
 					tileInfo.Tile.PaletteColors = _paletteRam[tilePalette + 3] | (_paletteRam[tilePalette + 2] << 8) | (_paletteRam[tilePalette + 1] << 16);
 				}
+				tileInfo.Tile.UpdateHash();
 				tileInfo.Tile.OffsetY = lastTileEx.OffsetY;
 				tileInfo.Tile.OffsetX = (_xScroll + ((_cycle - 1) & 0x07)) & 0x07;
 			} else {
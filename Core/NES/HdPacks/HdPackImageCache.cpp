@@ -0,0 +1,120 @@
+#include "pch.h"
+
+#if __has_include(<filesystem>)
+	#include <filesystem>
+	namespace fs = std::filesystem;
+#elif __has_include(<experimental/filesystem>)
+	#include <experimental/filesystem>
+	namespace fs = std::experimental::filesystem;
+#endif
+
+#include <algorithm>
+#include "NES/HdPacks/HdPackImageCache.h"
+#include "Utilities/FolderUtilities.h"
+#include "Utilities/HexUtilities.h"
+#include "Utilities/CRC32.h"
+
+string HdPackImageCache::GetCacheFolder()
+{
+	string folder = FolderUtilities::CombinePath(FolderUtilities::GetHdPackFolder(), "Cache");
+	FolderUtilities::CreateFolder(folder);
+	return folder;
+}
+
+string HdPackImageCache::GetCacheFilename(string& cacheFolder, vector<uint8_t>& pngData)
+{
+	uint32_t crc = CRC32::GetCRC(pngData);
+	return FolderUtilities::CombinePath(cacheFolder, HexUtilities::ToHex(crc, true) + "_" + HexUtilities::ToHex((uint32_t)pngData.size(), true) + ".bin");
+}
+
+void HdPackImageCache::CleanCache(string& cacheFolder)
+{
+	struct CacheFile
+	{
+		fs::path Path;
+		fs::file_time_type LastUsed;
+		uint64_t Size;
+	};
+
+	std::error_code errorCode;
+	vector<CacheFile> files;
+	uint64_t totalSize = 0;
+	for(fs::directory_iterator i(fs::u8path(cacheFolder), errorCode), end; !errorCode && i != end; i.increment(errorCode)) {
+		if(i->path().extension() != ".bin") {
+			continue;
+		}
+
+		CacheFile file = { i->path(), fs::last_write_time(i->path(), errorCode), (uint64_t)fs::file_size(i->path(), errorCode) };
+		if(!errorCode) {
+			totalSize += file.Size;
+			files.push_back(file);
+		}
+		errorCode.clear();
+	}
+
+	if(totalSize <= HdPackImageCache::MaxCacheSize) {
+		return;
+	}
+
+	//Delete the least recently used files until the cache fits in the limit again
+	std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.LastUsed < b.LastUsed; });
+	for(CacheFile& file : files) {
+		if(totalSize <= HdPackImageCache::MaxCacheSize) {
+			break;
+		}
+		if(fs::remove(file.Path, errorCode)) {
+			totalSize -= file.Size;
+		}
+	}
+}
+
+bool HdPackImageCache::LoadImage(string& filename, vector<uint32_t>& pixelData, uint32_t& width, uint32_t& height)
+{
+	ifstream file(filename, ios::in | ios::binary);
+	if(!file) {
+		return false;
+	}
+
+	uint32_t header[4] = {};
+	file.read((char*)header, sizeof(header));
+	if(!file || header[0] != HdPackImageCache::FileSignature || header[1] != HdPackImageCache::FileVersion) {
+		return false;
+	}
+
+	uint64_t pixelCount = (uint64_t)header[2] * header[3];
+	if(pixelCount == 0 || pixelCount > 0x10000000) {
+		return false;
+	}
+
+	//Read the pixels straight into the bitmap's buffer (the file contains the pixels in their final format)
+	pixelData.resize((size_t)pixelCount);
+	file.read((char*)pixelData.data(), pixelCount * sizeof(uint32_t));
+	if(!file || file.gcount() != (std::streamsize)(pixelCount * sizeof(uint32_t))) {
+		//Truncated file (e.g the emulator was closed while it was being written)
+		pixelData = {};
+		return false;
+	}
+
+	width = header[2];
+	height = header[3];
+
+	//Mark the file as recently used, so it is kept when the cache is cleaned up
+	file.close();
+	std::error_code errorCode;
+	fs::last_write_time(fs::u8path(filename), fs::file_time_type::clock::now(), errorCode);
+	return true;
+}
+
+void HdPackImageCache::SaveImage(string& filename, vector<uint32_t>& pixelData, uint32_t width, uint32_t height)
+{
+	if(pixelData.empty() || pixelData.size() != (size_t)width * height) {
+		return;
+	}
+
+	ofstream file(filename, ios::out | ios::binary | ios::trunc);
+	if(file) {
+		uint32_t header[4] = { HdPackImageCache::FileSignature, HdPackImageCache::FileVersion, width, height };
+		file.write((char*)header, sizeof(header));
+		file.write((char*)pixelData.data(), pixelData.size() * sizeof(uint32_t));
+	}
+}
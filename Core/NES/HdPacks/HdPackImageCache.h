@@ -0,0 +1,21 @@
+#pragma once
+#include "pch.h"
+
+//On-disk cache of decoded HD pack images (with premultiplied alpha), to avoid decoding the PNG files every time a pack is loaded
+//Images are identified by the CRC32 and size of their PNG file, so the cache stays valid when a pack is moved or renamed.
+//The cache's size is capped - the least recently used files (based on their modification time) are deleted first.
+class HdPackImageCache
+{
+private:
+	static constexpr uint32_t FileSignature = 0x4344484D; //"MHDC"
+	static constexpr uint32_t FileVersion = 1;
+	static constexpr uint64_t MaxCacheSize = 1024ULL * 1024 * 1024; //1 GB
+
+public:
+	static string GetCacheFolder();
+	static string GetCacheFilename(string& cacheFolder, vector<uint8_t>& pngData);
+	static void CleanCache(string& cacheFolder);
+
+	static bool LoadImage(string& filename, vector<uint32_t>& pixelData, uint32_t& width, uint32_t& height);
+	static void SaveImage(string& filename, vector<uint32_t>& pixelData, uint32_t width, uint32_t height);
+};
@@ -249,6 +249,7 @@ bool HdPackLoader::ProcessImgTag(string src)
 		return false;
 	}
 	bitmapInfo.PngName = src;
+	bitmapInfo.CacheFolder = _data->ImageCacheFolder;
 	return true;
 }
 
@@ -586,6 +587,7 @@ void HdPackLoader::ProcessBackgroundTag(vector<string> &tokens, vector<HdPackCon
 		_data->BackgroundFileData.push_back(unique_ptr<HdPackBitmapInfo>(new HdPackBitmapInfo()));
 		bgFileData = _data->BackgroundFileData.back().get();
 		bgFileData->PngName = tokens[0];
+		bgFileData->CacheFolder = _data->ImageCacheFolder;
 
 		if(!LoadFile(bgFileData->PngName, bgFileData->FileData)) {
 			bgFileData = nullptr;
@@ -805,4 +807,6 @@ void HdPackLoader::InitializeHdPack()
 			_data->TileByKey[tileInfo->GetKey(true)].push_back(tileInfo.get());
 		}
 	}
+
+	_data->TileTable.Build(_data->TileByKey);
 }
@@ -80,19 +80,23 @@ void OggMixer::SetSampleRate(int sampleRate)
 	}
 }
 
-bool OggMixer::Play(string filename, bool isSfx, uint32_t startOffset, uint32_t loopPosition)
+void OggMixer::Play(string filename, bool isSfx, uint32_t startOffset, uint32_t loopPosition)
 {
-	shared_ptr<OggReader> reader(new OggReader());
 	bool loop = !isSfx && (_options & (int)OggPlaybackOptions::Loop) != 0;
-	if(reader->Init(filename, loop, _sampleRate, startOffset, loopPosition)) {
-		if(isSfx) {
-			_sfx.push_back(reader);
-		} else {
-			_bgm = reader;
-		}
-		return true;
+	if(!isSfx && _bgm && _bgm->GetFilename() == filename && _bgm->Seek(startOffset)) {
+		//The requested position is still buffered (e.g when a save state is loaded for run-ahead), keep using the current stream
+		_bgm->SetLoopFlag(loop);
+		return;
+	}
+
+	//The pack loader already checked that the file exists - files that can't be decoded stop playing immediately
+	shared_ptr<OggReader> reader(new OggReader());
+	reader->Init(_streamThread, filename, loop, startOffset, loopPosition);
+	if(isSfx) {
+		_sfx.push_back(reader);
+	} else {
+		_bgm = reader;
 	}
-	return false;
 }
 
 int OggMixer::GetBgmOffset()
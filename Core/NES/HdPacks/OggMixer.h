@@ -1,12 +1,14 @@
 #pragma once
 #include "pch.h"
 #include "Shared/Interfaces/IAudioProvider.h"
+#include "Shared/Audio/StreamingAudioSource.h"
 
 class OggReader;
 
 class OggMixer : public IAudioProvider
 {
 private:
+	AudioStreamThread _streamThread;
 	shared_ptr<OggReader> _bgm;
 	vector<shared_ptr<OggReader>> _sfx;
 
@@ -23,7 +25,7 @@ public:
 	void SetSampleRate(int sampleRate);
 	
 	void Reset(uint32_t sampleRate);
-	bool Play(string filename, bool isSfx, uint32_t startOffset, uint32_t loopPosition);
+	void Play(string filename, bool isSfx, uint32_t startOffset, uint32_t loopPosition);
 	void SetPlaybackOptions(uint8_t options);
 	void SetPausedFlag(bool paused);
 	void StopBgm();
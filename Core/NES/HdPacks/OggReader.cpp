@@ -1,7 +1,95 @@
 #include "pch.h"
 #include "NES/HdPacks/OggReader.h"
+#include "Utilities/VirtualFile.h"
 #include "Utilities/Audio/stb_vorbis.h"
 
+class OggStreamDecoder : public IAudioStreamDecoder
+{
+private:
+	string _filename;
+	vector<uint8_t> _fileData;
+	stb_vorbis* _vorbis = nullptr;
+	uint32_t _startOffset = 0;
+	uint32_t _loopPosition = 0;
+	uint32_t _length = 0;
+	uint32_t _position = 0;
+
+public:
+	OggStreamDecoder(string filename, uint32_t startOffset, uint32_t loopPosition)
+	{
+		_filename = filename;
+		_startOffset = startOffset;
+		_loopPosition = loopPosition;
+	}
+
+	~OggStreamDecoder()
+	{
+		if(_vorbis) {
+			stb_vorbis_close(_vorbis);
+		}
+	}
+
+	bool Open() override
+	{
+		int error;
+		VirtualFile file = _filename;
+		if(!file.ReadFile(_fileData)) {
+			return false;
+		}
+
+		_vorbis = stb_vorbis_open_memory(_fileData.data(), (int)_fileData.size(), &error, nullptr);
+		if(!_vorbis) {
+			return false;
+		}
+
+		_length = stb_vorbis_stream_length_in_samples(_vorbis);
+		if(_loopPosition > 0) {
+			_loopPosition = _loopPosition < _length ? _loopPosition : 0;
+		}
+
+		if(_startOffset > 0) {
+			stb_vorbis_seek(_vorbis, _startOffset);
+			_position = _startOffset;
+		}
+		return true;
+	}
+
+	uint32_t GetSampleRate() override
+	{
+		return stb_vorbis_get_info(_vorbis).sample_rate;
+	}
+
+	uint32_t GetLength() override { return _length; }
+	uint32_t GetLoopPosition() override { return _loopPosition; }
+	uint32_t GetPositionStep() override { return 1; }
+
+	uint32_t Decode(int16_t* samples, uint32_t* positions, uint32_t frameCount, bool loop) override
+	{
+		uint32_t framesRead = 0;
+		bool looped = false;
+		while(framesRead < frameCount) {
+			int count = stb_vorbis_get_samples_short_interleaved(_vorbis, 2, samples + framesRead * 2, (frameCount - framesRead) * 2);
+			if(count <= 0) {
+				if(!loop || looped) {
+					break;
+				}
+				stb_vorbis_seek(_vorbis, _loopPosition);
+				_position = _loopPosition;
+				looped = true;
+				continue;
+			}
+
+			for(int i = 0; i < count; i++) {
+				_position++;
+				positions[framesRead + i] = _position;
+			}
+			framesRead += count;
+			looped = false;
+		}
+		return framesRead;
+	}
+};
+
 OggReader::OggReader()
 {
 	_done = false;
@@ -14,36 +102,34 @@ OggReader::~OggReader()
 	delete[] _oggBuffer;
 	delete[] _outputBuffer;
 
-	if(_vorbis) {
-		stb_vorbis_close(_vorbis);
+	if(_source) {
+		_source->Close();
 	}
 }
 
-bool OggReader::Init(string filename, bool loop, uint32_t sampleRate, uint32_t startOffset, uint32_t loopPosition)
+void OggReader::Init(AudioStreamThread& streamThread, string filename, bool loop, uint32_t startOffset, uint32_t loopPosition)
 {
-	int error;
-	VirtualFile file = filename;
-	_fileData = vector<uint8_t>(100000);
-	if(file.ReadFile(_fileData)) {
-		_vorbis = stb_vorbis_open_memory(_fileData.data(), (int)_fileData.size(), &error, nullptr);
-		if(_vorbis) {
-			_loop = loop;
-			if(loopPosition > 0) {
-				unsigned int sampleCount = stb_vorbis_stream_length_in_samples(_vorbis);
-				_loopPosition = loopPosition < sampleCount ? loopPosition : 0;
-			} else {
-				_loopPosition = 0;
-			}
-			_oggSampleRate = stb_vorbis_get_info(_vorbis).sample_rate;
-			if(startOffset > 0) {
-				stb_vorbis_seek(_vorbis, startOffset);
-			}
-			return true;
-		}
+	//The file is loaded and decoded on the stream thread, to avoid blocking the emulation thread
+	_filename = filename;
+	_source.reset(new StreamingAudioSource(new OggStreamDecoder(filename, startOffset, loopPosition), loop, startOffset));
+	streamThread.Add(_source);
+}
+
+bool OggReader::Seek(uint32_t offset)
+{
+	if(_source->Seek(offset)) {
+		_done = false;
+		_resampler.Reset();
+		return true;
 	}
 	return false;
 }
 
+string OggReader::GetFilename()
+{
+	return _filename;
+}
+
 bool OggReader::IsPlaybackOver()
 {
 	return _done;
@@ -58,28 +144,32 @@ void OggReader::SetSampleRate(int sampleRate)
 
 void OggReader::SetLoopFlag(bool loop)
 {
-	_loop = loop;
+	_source->SetLoopFlag(loop);
 }
 
 void OggReader::ApplySamples(int16_t* buffer, size_t sampleCount, uint8_t volume)
 {
+	if(_source->IsOpened()) {
+		MixSamples(buffer, sampleCount, volume);
+	}
+
+	//The end of the track depends on the number of samples played, not on how far ahead the stream thread is
+	_source->Advance((uint32_t)sampleCount, _sampleRate);
+	_done = _source->IsPlaybackOver();
+}
+
+void OggReader::MixSamples(int16_t* buffer, size_t sampleCount, uint8_t volume)
+{
+	int oggSampleRate = (int)_source->GetSampleRate();
 	int32_t samplesNeeded = (int32_t)sampleCount - _resampler.GetPendingCount();
 	uint32_t samplesRead = 0;
 	if(samplesNeeded > 0) {
-		uint32_t samplesToLoad = samplesNeeded * _oggSampleRate / _sampleRate + 2;
-		uint32_t samplesLoaded = (uint32_t)stb_vorbis_get_samples_short_interleaved(_vorbis, 2, _oggBuffer, samplesToLoad * 2);
-		if(samplesLoaded < samplesToLoad) {
-			if(_loop) {
-				stb_vorbis_seek(_vorbis, _loopPosition);
-				samplesLoaded += stb_vorbis_get_samples_short_interleaved(_vorbis, 2, _oggBuffer + samplesLoaded * 2, samplesToLoad - samplesLoaded);
-			} else {
-				_done = true;
-			}
-		}
-		_resampler.SetSampleRates(_oggSampleRate, _sampleRate);
+		uint32_t samplesToLoad = samplesNeeded * oggSampleRate / _sampleRate + 2;
+		uint32_t samplesLoaded = _source->Read(_oggBuffer, samplesToLoad);
+		_resampler.SetSampleRates(oggSampleRate, _sampleRate);
 		samplesRead = _resampler.Resample<false>(_oggBuffer, samplesLoaded, _outputBuffer, sampleCount);
 	}
-	
+
 	uint32_t samplesToProcess = (uint32_t)samplesRead * 2;
 	for(uint32_t i = 0; i < samplesToProcess; i++) {
 		buffer[i] = std::clamp<int32_t>((int32_t)(_outputBuffer[i] * volume / 255) + buffer[i], INT16_MIN, INT16_MAX);
@@ -88,5 +178,5 @@ void OggReader::ApplySamples(int16_t* buffer, size_t sampleCount, uint8_t volume
 
 uint32_t OggReader::GetOffset()
 {
-	return stb_vorbis_get_file_offset(_vorbis);
+	return _source->GetPosition();
 }
\ No newline at end of file
@@ -1,37 +1,35 @@
 #pragma once
 #include "pch.h"
-#include "Utilities/VirtualFile.h"
 #include "Utilities/Audio/HermiteResampler.h"
-
-struct stb_vorbis;
+#include "Shared/Audio/StreamingAudioSource.h"
 
 class OggReader
 {
 private:
-	stb_vorbis* _vorbis = nullptr;
+	shared_ptr<StreamingAudioSource> _source;
 	int16_t* _outputBuffer = nullptr;
 	int16_t* _oggBuffer = nullptr;
 
 	HermiteResampler _resampler;
 
-	bool _loop = false;
 	bool _done = false;
-	
-	uint32_t _loopPosition = 0;
 
 	int _sampleRate = 0;
-	int _oggSampleRate = 0;
 
-	vector<uint8_t> _fileData;
+	string _filename;
+
+	void MixSamples(int16_t* buffer, size_t sampleCount, uint8_t volume);
 
 public:
 	OggReader();
 	~OggReader();
 
-	bool Init(string filename, bool loop, uint32_t sampleRate, uint32_t startOffset = 0, uint32_t loopPosition = 0);
+	void Init(AudioStreamThread& streamThread, string filename, bool loop, uint32_t startOffset = 0, uint32_t loopPosition = 0);
+	bool Seek(uint32_t offset);
+	string GetFilename();
 	bool IsPlaybackOver();
 	void SetSampleRate(int sampleRate);
 	void SetLoopFlag(bool loop);
 	void ApplySamples(int16_t* buffer, size_t sampleCount, uint8_t volume);
 	uint32_t GetOffset();
-};
+};
\ No newline at end of file
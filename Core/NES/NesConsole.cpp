@@ -13,6 +13,7 @@
 #include "NES/HdPacks/HdData.h"
 #include "NES/HdPacks/HdNesPpu.h"
 #include "NES/HdPacks/HdPackLoader.h"
+#include "NES/HdPacks/HdPackImageCache.h"
 #include "NES/HdPacks/HdPackBuilder.h"
 #include "NES/HdPacks/HdBuilderPpu.h"
 #include "NES/HdPacks/HdVideoFilter.h"
@@ -203,6 +204,10 @@ void NesConsole::LoadHdPack(VirtualFile& romFile)
 	_hdData.reset();
 	if(GetNesConfig().EnableHdPacks) {
 		_hdData.reset(new HdPackData());
+		if(GetNesConfig().CacheHdPackImages) {
+			_hdData->ImageCacheFolder = HdPackImageCache::GetCacheFolder();
+			HdPackImageCache::CleanCache(_hdData->ImageCacheFolder);
+		}
 		if(!HdPackLoader::LoadHdNesPack(romFile, *_hdData.get())) {
 			_hdData.reset();
 		} else {
@@ -170,11 +170,13 @@ void NesDefaultVideoFilter::DecodePpuBuffer(uint16_t* ppuOutputBuffer, uint32_t*
 		NesDefaultVideoFilter::ApplyPalBorder(ppuOutputBuffer);
 	}
 
+	//Palette lookups can't be vectorized with SSE2/NEON (no gather instructions), keep the loop simple for the compiler
 	for(uint32_t i = 0; i < frame.Height; i++) {
+		uint16_t* src = ppuOutputBuffer + (i + overscan.Top) * _baseFrameInfo.Width + overscan.Left;
 		for(uint32_t j = 0; j < frame.Width; j++) {
-			*out = _calculatedPalette[ppuOutputBuffer[(i + overscan.Top) * _baseFrameInfo.Width + j + overscan.Left]];
-			out++;
+			out[j] = _calculatedPalette[src[j]];
 		}
+		out += frame.Width;
 	}
 }
 
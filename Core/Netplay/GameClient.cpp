@@ -5,6 +5,7 @@
 #include "Shared/MessageManager.h"
 #include "Shared/Emulator.h"
 #include "Shared/NotificationManager.h"
+#include "Shared/PerformanceCounters.h"
 #include "Utilities/Socket.h"
 
 GameClient::GameClient(Emulator* emu)
@@ -28,7 +29,7 @@ void GameClient::Connect(ClientConnectionData &connectionData)
 	_stop = false;
 	unique_ptr<Socket> socket(new Socket());
 	if(socket->Connect(connectionData.Host.c_str(), connectionData.Port)) {
-		_connection.reset(new GameClientConnection(_emu, std::move(socket), connectionData));
+		_connection.reset(new GameClientConnection(_emu, std::move(socket), &_poller, connectionData));
 		_connected = true;
 		_clientThread.reset(new thread(&GameClient::Exec, this));
 		_emu->GetNotificationManager()->RegisterNotificationListener(shared_from_this());
@@ -42,6 +43,7 @@ void GameClient::Disconnect()
 {
 	_stop = true;
 	_connected = false;
+	_poller.Wake();
 	if(_clientThread) {
 		_clientThread->join();
 		_clientThread.reset();
@@ -53,12 +55,18 @@ void GameClient::Exec()
 	if(_connected) {
 		while(!_stop) {
 			if(!_connection->ConnectionError()) {
+				PERF_TIMER(_emu->GetPerformanceCounters(), Netplay);
 				_connection->ProcessMessages();
 				_connection->SendInput();
+				_connection->SendPendingData();
 			} else {
 				break;
 			}
-			std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(1));
+
+			//Wait until the server sends data, the socket can accept more data, or the emulation thread has inputs to send
+			_poller.Clear();
+			_poller.Add(_connection->GetSocket(), _connection->HasPendingData());
+			_poller.Wait(_connection->GetWaitTimeout());
 		}
 		_connected = false;
 		_connection->Shutdown();
@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "Shared/Interfaces/INotificationListener.h"
 #include "Netplay/NetplayTypes.h"
+#include "Utilities/SocketPoller.h"
 
 class Socket;
 class GameClientConnection;
@@ -14,6 +15,7 @@ private:
 	Emulator* _emu;
 	unique_ptr<thread> _clientThread;
 	unique_ptr<GameClientConnection> _connection;
+	SocketPoller _poller;
 
 	atomic<bool> _stop;
 	atomic<bool> _connected;
@@ -11,18 +11,22 @@
 #include "Netplay/ForceDisconnectMessage.h"
 #include "Netplay/ServerInformationMessage.h"
 #include "Netplay/GameServer.h"
+#include "Netplay/RollbackInputMessage.h"
+#include "Netplay/RollbackManager.h"
+#include "Netplay/StateAckMessage.h"
 #include "Shared/BaseControlManager.h"
 #include "Shared/Emulator.h"
 #include "Shared/EmuSettings.h"
 #include "Shared/NotificationManager.h"
 #include "Shared/RomFinder.h"
 
-GameClientConnection::GameClientConnection(Emulator* emu, unique_ptr<Socket> socket, ClientConnectionData &connectionData) : GameConnection(emu, std::move(socket))
+GameClientConnection::GameClientConnection(Emulator* emu, unique_ptr<Socket> socket, SocketPoller* poller, ClientConnectionData &connectionData) : GameConnection(emu, std::move(socket), poller)
 {
 	_connectionData = connectionData;
 	_shutdown = false;
 	_enableControllers = false;
 	_minimumQueueSize = 3;
+	_rollbackEnabled = false;
 	_controllerType = ControllerType::None;
 
 	MessageManager::DisplayMessage("NetPlay", "ConnectedToServer");
@@ -40,6 +44,10 @@ void GameClientConnection::Shutdown()
 		DisableControllers();
 
 		_emu->UnregisterInputProvider(this);
+		if(_rollbackEnabled) {
+			_emu->GetRollbackManager()->Stop();
+			_rollbackEnabled = false;
+		}
 
 		MessageManager::DisplayMessage("NetPlay", "ConnectionLost");
 		_emu->GetSettings()->ClearFlag(EmulationFlags::MaximumSpeed);
@@ -79,15 +87,7 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 			break;
 
 		case MessageType::SaveState:
-			if(_gameLoaded) {
-				DisableControllers();
-
-				auto lock = _emu->AcquireLock();
-				ClearInputData();
-				((SaveStateMessage*)message)->LoadState(_emu);
-				_enableControllers = true;
-				InitControlDevice();
-			}
+			LoadState((SaveStateMessage*)message);
 			break;
 
 		case MessageType::MovieData:
@@ -96,6 +96,17 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 			}
 			break;
 
+		case MessageType::RollbackInput:
+			if(_gameLoaded && _rollbackEnabled && ((RollbackInputMessage*)message)->IsValid()) {
+				RollbackFrameInput& input = ((RollbackInputMessage*)message)->GetInput();
+				for(RollbackControllerInput& controllerInput : input.Inputs) {
+					if(!_emu->GetRollbackManager()->AddRemoteInput(input.Frame, controllerInput.Controller, controllerInput.State)) {
+						MessageManager::Log("[Netplay] Input received too late, waiting for server to resynchronize.");
+					}
+				}
+			}
+			break;
+
 		case MessageType::ForceDisconnect:
 			MessageManager::DisplayMessage("NetPlay", ((ForceDisconnectMessage*)message)->GetMessage());
 			break;
@@ -121,6 +132,19 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 			if(!_gameLoaded) {
 				_emu->Stop(true);
 			} else {
+				{
+					auto lock = _emu->AcquireLock();
+					RollbackManager* rollback = _emu->GetRollbackManager();
+					_rollbackEnabled = gameInfo->IsRollbackEnabled();
+					if(_rollbackEnabled) {
+						//All controllers are controlled by other players, except the one selected by this client
+						rollback->Start(true, _poller);
+						rollback->SetRemote(_controllerPort, false);
+					} else {
+						rollback->Stop();
+					}
+				}
+
 				_emu->UnregisterInputProvider(this);
 				_emu->RegisterInputProvider(this);
 				if(gameInfo->IsPaused()) {
@@ -135,6 +159,44 @@ void GameClientConnection::ProcessMessage(NetMessage* message)
 	}
 }
 
+void GameClientConnection::LoadState(SaveStateMessage* message)
+{
+	if(message->GetBaseStateId() != 0 && message->GetBaseStateId() != _lastStateId) {
+		//The state was sent as a delta against a state this client doesn't have, ask for the full state
+		MessageManager::Log("[Netplay] Could not apply state received from server, requesting full state.");
+		_lastStateId = 0;
+		_lastState.clear();
+		StateAckMessage ack(0);
+		SendNetMessage(ack);
+		return;
+	}
+
+	if(_gameLoaded) {
+		DisableControllers();
+
+		auto lock = _emu->AcquireLock();
+		ClearInputData();
+		if(message->LoadState(_emu, _lastState)) {
+			_lastStateId = message->GetStateId();
+		} else {
+			//The state is invalid or incomplete, ask for the full state
+			MessageManager::Log("[Netplay] Could not load state received from server, requesting full state.");
+			_lastStateId = 0;
+			_lastState.clear();
+		}
+		if(_rollbackEnabled) {
+			//Inputs and states from before the state was loaded can't be used anymore
+			_emu->GetRollbackManager()->Reset();
+		}
+		_enableControllers = true;
+		InitControlDevice();
+	}
+
+	//The server waits for this before sending another state, and sends it as a delta against the last state that was loaded
+	StateAckMessage ack(_lastStateId);
+	SendNetMessage(ack);
+}
+
 bool GameClientConnection::AttemptLoadGame(string filename, uint32_t crc32)
 {
 	if(filename.size() > 0) {
@@ -171,6 +233,13 @@ void GameClientConnection::DisableControllers()
 
 bool GameClientConnection::SetInput(BaseControlDevice *device)
 {
+	if(_enableControllers && _rollbackEnabled) {
+		//Local input is used right away, the other players' inputs are predicted until they are received
+		SetLocalInput(device);
+		_emu->GetRollbackManager()->SetInput(device);
+		return true;
+	}
+
 	if(_enableControllers) {
 		uint8_t port = device->GetPort();
 		while(_inputSize[port] == 0) {
@@ -232,24 +301,73 @@ void GameClientConnection::ProcessNotification(ConsoleNotificationType type, voi
 	}
 }
 
-void GameClientConnection::SendInput()
+bool GameClientConnection::ReadLocalInput(ControlDeviceState& inputState)
 {
-	if(_gameLoaded) {
-		if(!_controlDevice || _controllerType != _controlDevice->GetControllerType()) {
-			//Pretend we are using port 0 (to use player 1's keybindings during netplay)
-			shared_ptr<IConsole> console = _emu->GetConsole();
-			if(!console) {
-				return;
-			}
-			_controlDevice = console->GetControlManager()->CreateControllerDevice(_controllerType, 0);
+	if(!_controlDevice || _controllerType != _controlDevice->GetControllerType()) {
+		//Pretend we are using port 0 (to use player 1's keybindings during netplay)
+		shared_ptr<IConsole> console = _emu->GetConsole();
+		if(!console) {
+			return false;
 		}
+		_controlDevice = console->GetControlManager()->CreateControllerDevice(_controllerType, 0);
+	}
+
+	inputState = {};
+	if(_controlDevice) {
+		_controlDevice->SetStateFromInput();
+		inputState = _controlDevice->GetRawState();
+	}
+	return true;
+}
+
+void GameClientConnection::SetLocalInput(BaseControlDevice* device)
+{
+	if(device->GetPort() != _controllerPort.Port) {
+		return;
+	}
 
-		ControlDeviceState inputState;
-		if(_controlDevice) {
-			_controlDevice->SetStateFromInput();
-			inputState = _controlDevice->GetRawState();
+	ControlDeviceState inputState;
+	if(!ReadLocalInput(inputState) || inputState.State.empty()) {
+		return;
+	}
+
+	IControllerHub* hub = dynamic_cast<IControllerHub*>(device);
+	if(hub) {
+		shared_ptr<BaseControlDevice> hubController = _controllerPort.SubPort < hub->GetHubPortCount() ? hub->GetController(_controllerPort.SubPort) : nullptr;
+		if(hubController) {
+			hubController->SetRawState(inputState);
 		}
-		
+	} else if(_controllerPort.SubPort == 0) {
+		device->SetRawState(inputState);
+	}
+}
+
+void GameClientConnection::SendRollbackInputs()
+{
+	RollbackManager* rollback = _emu->GetRollbackManager();
+	RollbackFrameInput input;
+	while(rollback->GetLocalInput(input)) {
+		RollbackInputMessage message(input);
+		SendNetMessage(message);
+	}
+
+	//Catch up to the server when running behind (e.g after receiving the server's state)
+	if(rollback->GetFramesBehind() > 2) {
+		_emu->GetSettings()->SetFlag(EmulationFlags::MaximumSpeed);
+	} else {
+		_emu->GetSettings()->ClearFlag(EmulationFlags::MaximumSpeed);
+	}
+}
+
+void GameClientConnection::SendInput()
+{
+	if(_gameLoaded && _rollbackEnabled) {
+		SendRollbackInputs();
+		return;
+	}
+
+	ControlDeviceState inputState;
+	if(_gameLoaded && ReadLocalInput(inputState)) {
 		if(_lastInputSent != inputState) {
 			InputDataMessage message(inputState);
 			SendNetMessage(message);
@@ -258,6 +376,17 @@ void GameClientConnection::SendInput()
 	}
 }
 
+int GameClientConnection::GetWaitTimeout()
+{
+	if(IsLatencySimulated() || (_gameLoaded && !_rollbackEnabled && _controllerPort.Port != GameConnection::SpectatorPort)) {
+		//Without rollback, the player's input is read and sent by the network thread - keep polling it
+		return 1;
+	}
+
+	//Otherwise, the emulation thread wakes up the network thread when there are inputs to send
+	return 100;
+}
+
 void GameClientConnection::SelectController(NetplayControllerInfo controller)
 {
 	SendControllerSelection(controller);
@@ -12,6 +12,7 @@
 #include "Netplay/NetplayTypes.h"
 
 class Emulator;
+class SaveStateMessage;
 
 class GameClientConnection final : public GameConnection, public INotificationListener, public IInputProvider
 {
@@ -23,6 +24,7 @@ private:
 	atomic<bool> _shutdown;
 	atomic<bool> _enableControllers;
 	atomic<uint32_t> _minimumQueueSize;
+	atomic<bool> _rollbackEnabled;
 
 	vector<PlayerInfo> _playerList;
 
@@ -34,6 +36,10 @@ private:
 	ClientConnectionData _connectionData = {};
 	string _serverSalt;
 
+	//Last state received from the server - the next states are sent as a delta against it
+	vector<uint8_t> _lastState;
+	uint32_t _lastStateId = 0;
+
 private:
 	void SendHandshake();
 	void SendControllerSelection(NetplayControllerInfo controller);
@@ -41,12 +47,16 @@ private:
 	void PushControllerState(uint8_t port, ControlDeviceState state);
 	void DisableControllers();
 	bool AttemptLoadGame(string filename, uint32_t crc32);
+	void LoadState(SaveStateMessage* message);
+	bool ReadLocalInput(ControlDeviceState& inputState);
+	void SetLocalInput(BaseControlDevice* device);
+	void SendRollbackInputs();
 
 protected:
 	void ProcessMessage(NetMessage* message) override;
 
 public:
-	GameClientConnection(Emulator* emu, unique_ptr<Socket> socket, ClientConnectionData &connectionData);
+	GameClientConnection(Emulator* emu, unique_ptr<Socket> socket, SocketPoller* poller, ClientConnectionData &connectionData);
 	virtual ~GameClientConnection();
 
 	void Shutdown();
@@ -56,6 +66,7 @@ public:
 	bool SetInput(BaseControlDevice *device) override;
 	void InitControlDevice();
 	void SendInput();
+	int GetWaitTimeout();
 
 	void SelectController(NetplayControllerInfo controller);
 	vector<NetplayControllerUsageInfo> GetControllerList();
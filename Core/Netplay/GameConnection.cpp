@@ -10,10 +10,18 @@
 #include "Netplay/ClientConnectionData.h"
 #include "Netplay/ForceDisconnectMessage.h"
 #include "Netplay/ServerInformationMessage.h"
+#include "Netplay/RollbackInputMessage.h"
+#include "Netplay/StateAckMessage.h"
+#include "Utilities/Socket.h"
+#include "Utilities/SocketPoller.h"
 
-GameConnection::GameConnection(Emulator* emu, unique_ptr<Socket> socket)
+atomic<uint32_t> GameConnection::_simulatedLatency(0);
+atomic<uint32_t> GameConnection::_simulatedJitter(0);
+
+GameConnection::GameConnection(Emulator* emu, unique_ptr<Socket> socket, SocketPoller* poller)
 {
 	_emu = emu;
+	_poller = poller;
 	_socket.swap(socket);
 }
 
@@ -25,28 +33,56 @@ GameConnection::~GameConnection()
 void GameConnection::ReadSocket()
 {
 	auto lock = _socketLock.AcquireSafe();
-	int bytesReceived = _socket->Recv((char*)_readBuffer + _readPosition, GameConnection::MaxMsgLength - _readPosition, 0);
+
+	if(_readOffset > 0) {
+		//Move the incomplete message (if any) to the start of the buffer
+		memmove(_readBuffer.data(), _readBuffer.data() + _readOffset, _readPosition - _readOffset);
+		_readPosition -= _readOffset;
+		_readOffset = 0;
+	}
+
+	size_t requiredSize = _readPosition + GameConnection::ReadChunkSize;
+	if(_readPosition >= sizeof(uint32_t)) {
+		//Make room for the whole message at once (e.g save states), invalid lengths are rejected by ExtractMessage
+		uint32_t messageLength = _readBuffer[0] | (_readBuffer[1] << 8) | (_readBuffer[2] << 16) | (_readBuffer[3] << 24);
+		requiredSize = std::max<size_t>(requiredSize, std::min(messageLength, GameConnection::MaxMsgLength) + sizeof(uint32_t));
+	}
+
+	if(_readBuffer.size() < requiredSize) {
+		_readBuffer.resize(requiredSize);
+	} else if(_readBuffer.size() > requiredSize * 2) {
+		//Release the memory used by a large message once it has been processed
+		_readBuffer.resize(requiredSize);
+		_readBuffer.shrink_to_fit();
+	}
+
+	int bytesReceived = _socket->Recv((char*)_readBuffer.data() + _readPosition, (int)(_readBuffer.size() - _readPosition), 0);
 	if(bytesReceived > 0) {
 		_readPosition += bytesReceived;
 	}
 }
 
-bool GameConnection::ExtractMessage(void *buffer, uint32_t &messageLength)
+bool GameConnection::ExtractMessage(uint8_t* &message, uint32_t &messageLength)
 {
-	messageLength = _readBuffer[0] | (_readBuffer[1] << 8) | (_readBuffer[2] << 16) | (_readBuffer[3] << 24);
+	if(_readPosition - _readOffset < sizeof(messageLength)) {
+		return false;
+	}
+
+	uint8_t* data = _readBuffer.data() + _readOffset;
+	messageLength = data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
 
-	if(messageLength > GameConnection::MaxMsgLength) {
+	if(messageLength == 0 || messageLength > GameConnection::MaxMsgLength) {
 		MessageManager::Log("[Netplay] Invalid data received, closing connection.");
 		Disconnect();
 		return false;
 	}
 
-	int packetLength = messageLength + sizeof(messageLength);
+	uint32_t packetLength = messageLength + sizeof(messageLength);
 
-	if(_readPosition >= packetLength) {
-		memcpy(buffer, _readBuffer+sizeof(messageLength), messageLength);
-		memmove(_readBuffer, _readBuffer + packetLength, _readPosition - packetLength);
-		_readPosition -= packetLength;
+	if(_readPosition - _readOffset >= packetLength) {
+		//The message's data stays valid until the next call to ReadSocket
+		message = data + sizeof(messageLength);
+		_readOffset += packetLength;
 		return true;
 	}
 	return false;
@@ -56,34 +92,95 @@ NetMessage* GameConnection::ReadMessage()
 {
 	ReadSocket();
 
-	if(_readPosition > 4) {
-		uint32_t messageLength;
-		if(ExtractMessage(_messageBuffer, messageLength)) {
-			switch((MessageType)_messageBuffer[0]) {
-				case MessageType::HandShake: return new HandShakeMessage(_messageBuffer, messageLength);
-				case MessageType::SaveState: return new SaveStateMessage(_messageBuffer, messageLength);
-				case MessageType::InputData: return new InputDataMessage(_messageBuffer, messageLength);
-				case MessageType::MovieData: return new MovieDataMessage(_messageBuffer, messageLength);
-				case MessageType::GameInformation: return new GameInformationMessage(_messageBuffer, messageLength);
-				case MessageType::PlayerList: return new PlayerListMessage(_messageBuffer, messageLength);
-				case MessageType::SelectController: return new SelectControllerMessage(_messageBuffer, messageLength);
-				case MessageType::ForceDisconnect: return new ForceDisconnectMessage(_messageBuffer, messageLength);
-				case MessageType::ServerInformation: return new ServerInformationMessage(_messageBuffer, messageLength);
-			}
+	uint8_t* data;
+	uint32_t messageLength;
+	if(ExtractMessage(data, messageLength)) {
+		switch((MessageType)data[0]) {
+			case MessageType::HandShake: return new HandShakeMessage(data, messageLength);
+			case MessageType::SaveState: return new SaveStateMessage(data, messageLength);
+			case MessageType::InputData: return new InputDataMessage(data, messageLength);
+			case MessageType::MovieData: return new MovieDataMessage(data, messageLength);
+			case MessageType::GameInformation: return new GameInformationMessage(data, messageLength);
+			case MessageType::PlayerList: return new PlayerListMessage(data, messageLength);
+			case MessageType::SelectController: return new SelectControllerMessage(data, messageLength);
+			case MessageType::ForceDisconnect: return new ForceDisconnectMessage(data, messageLength);
+			case MessageType::ServerInformation: return new ServerInformationMessage(data, messageLength);
+			case MessageType::RollbackInput: return new RollbackInputMessage(data, messageLength);
+			case MessageType::StateAck: return new StateAckMessage(data, messageLength);
 		}
 	}
 	return nullptr;
 }
 
 void GameConnection::SendNetMessage(NetMessage &message)
+{
+	{
+		auto lock = _socketLock.AcquireSafe();
+		if(_holdMessages) {
+			vector<uint8_t> packet;
+			message.Encode(packet);
+			_heldMessages.insert(_heldMessages.end(), packet.begin(), packet.end());
+			return;
+		}
+		message.Send(*_socket.get());
+	}
+
+	//Wake up the network thread to send the data right away - messages queued until then are sent together
+	_poller->Wake();
+}
+
+void GameConnection::SendPacket(vector<uint8_t>& packet)
+{
+	{
+		auto lock = _socketLock.AcquireSafe();
+		_socket->BufferedSend((char*)packet.data(), (int)packet.size());
+	}
+	_poller->Wake();
+}
+
+void GameConnection::HoldMessages()
+{
+	auto lock = _socketLock.AcquireSafe();
+	_holdMessages = true;
+}
+
+void GameConnection::ReleaseMessages()
+{
+	{
+		auto lock = _socketLock.AcquireSafe();
+		_holdMessages = false;
+		if(!_heldMessages.empty()) {
+			_socket->BufferedSend((char*)_heldMessages.data(), (int)_heldMessages.size());
+			_heldMessages.clear();
+		}
+	}
+	_poller->Wake();
+}
+
+void GameConnection::SendPendingData()
+{
+	auto lock = _socketLock.AcquireSafe();
+	_socket->SendBuffer();
+	if(_socket->GetBufferedSize() > GameConnection::MaxBufferedSize) {
+		//Connection seems dead (or is too slow to keep up), close it
+		MessageManager::Log("[Netplay] Unable to send data, closing connection.");
+		_socket->Close();
+	}
+}
+
+bool GameConnection::HasPendingData()
 {
 	auto lock = _socketLock.AcquireSafe();
-	message.Send(*_socket.get());
+	return _socket->GetBufferedSize() > 0;
 }
 
 void GameConnection::Disconnect()
 {
 	auto lock = _socketLock.AcquireSafe();
+	if(!_socket->ConnectionError()) {
+		//Try to send any remaining data (e.g ForceDisconnect messages) before closing
+		_socket->SendBuffer();
+	}
 	_socket->Close();
 }
 
@@ -92,13 +189,40 @@ bool GameConnection::ConnectionError()
 	return _socket->ConnectionError();
 }
 
+void GameConnection::SetSimulatedLatency(uint32_t latency, uint32_t jitter)
+{
+	_simulatedLatency = latency;
+	_simulatedJitter = jitter;
+}
+
 void GameConnection::ProcessMessages()
 {
 	NetMessage* message;
 	while((message = ReadMessage()) != nullptr) {
 		//Loop until all messages have been processed
 		message->Initialize();
-		ProcessMessage(message);
-		delete message;
-	}		
+		if(_simulatedLatency > 0 || _simulatedJitter > 0 || !_delayedMessages.empty()) {
+			//Delay the message to simulate a slower connection - messages stay in order, like they would with TCP
+			double processTime = _delayTimer.GetElapsedMS() + _simulatedLatency + (_simulatedJitter > 0 ? _jitterRandom() % (_simulatedJitter + 1) : 0);
+			if(!_delayedMessages.empty()) {
+				processTime = std::max(processTime, _delayedMessages.back().ProcessTime);
+			}
+			_delayedMessages.push_back({ processTime, unique_ptr<NetMessage>(message) });
+		} else {
+			ProcessMessage(message);
+			delete message;
+		}
+	}
+
+	ProcessDelayedMessages();
+}
+
+void GameConnection::ProcessDelayedMessages()
+{
+	double now = _delayTimer.GetElapsedMS();
+	while(!_delayedMessages.empty() && _delayedMessages.front().ProcessTime <= now) {
+		unique_ptr<NetMessage> message = std::move(_delayedMessages.front().Message);
+		_delayedMessages.pop_front();
+		ProcessMessage(message.get());
+	}
 }
\ No newline at end of file
@@ -1,29 +1,56 @@
 #pragma once
 #include "pch.h"
+#include <deque>
+#include <random>
 #include "Utilities/SimpleLock.h"
+#include "Utilities/Timer.h"
 
 class Socket;
+class SocketPoller;
 class NetMessage;
 class Emulator;
 
 class GameConnection
 {
 protected:
-	static constexpr int MaxMsgLength = 1500000;
+	static constexpr uint32_t MaxMsgLength = 1500000;
+	static constexpr uint32_t ReadChunkSize = 0x4000;
+	static constexpr size_t MaxBufferedSize = 16 * 1024 * 1024;
 
 	unique_ptr<Socket> _socket;
+	SocketPoller* _poller;
 	Emulator* _emu;
 
-	uint8_t _readBuffer[GameConnection::MaxMsgLength] = {};
-	uint8_t _messageBuffer[GameConnection::MaxMsgLength] = {};
-	int _readPosition = 0;
+	//Grows to fit the message being received, and shrinks back once it has been processed
+	vector<uint8_t> _readBuffer;
+	uint32_t _readPosition = 0;
+	uint32_t _readOffset = 0;
 	SimpleLock _socketLock;
 
+	//Messages sent while _holdMessages is set are kept here until ReleaseMessages is called
+	bool _holdMessages = false;
+	vector<uint8_t> _heldMessages;
+
+	//Simulated network conditions (for testing), applied to received messages
+	static atomic<uint32_t> _simulatedLatency;
+	static atomic<uint32_t> _simulatedJitter;
+
+	struct DelayedMessage
+	{
+		double ProcessTime;
+		unique_ptr<NetMessage> Message;
+	};
+
+	std::deque<DelayedMessage> _delayedMessages;
+	Timer _delayTimer;
+	std::mt19937 _jitterRandom;
+
 private:
 	void ReadSocket();
 
-	bool ExtractMessage(void *buffer, uint32_t &messageLength);
+	bool ExtractMessage(uint8_t* &message, uint32_t &messageLength);
 	NetMessage* ReadMessage();
+	void ProcessDelayedMessages();
 
 	virtual void ProcessMessage(NetMessage* message) = 0;
 
@@ -32,10 +59,26 @@ protected:
 
 public:
 	static constexpr uint8_t SpectatorPort = 0xFF;
-	GameConnection(Emulator* emu, unique_ptr<Socket> socket);
+	GameConnection(Emulator* emu, unique_ptr<Socket> socket, SocketPoller* poller);
 	virtual ~GameConnection();
 
+	static void SetSimulatedLatency(uint32_t latency, uint32_t jitter);
+	static bool IsLatencySimulated() { return _simulatedLatency > 0 || _simulatedJitter > 0; }
+
+	Socket* GetSocket() { return _socket.get(); }
+
 	bool ConnectionError();
 	void ProcessMessages();
+
+	//Can be called from any thread - the message is buffered and sent by the network thread
 	void SendNetMessage(NetMessage &message);
+	void SendPacket(vector<uint8_t>& packet);
+
+	//Used to queue a packet ahead of the messages that are sent after HoldMessages is called
+	//SendPacket isn't affected by HoldMessages - ReleaseMessages sends the held messages after the packets that were sent in the meantime
+	void HoldMessages();
+	void ReleaseMessages();
+
+	void SendPendingData();
+	bool HasPendingData();
 };
\ No newline at end of file
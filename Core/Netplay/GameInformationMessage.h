@@ -12,22 +12,24 @@ private:
 	uint32_t _crc32 = 0;
 	NetplayControllerInfo _controller = {};
 	bool _paused = false;
+	bool _rollback = false;
 
 protected:
 	void Serialize(Serializer &s) override
 	{
-		SV(_romFilename); SV(_crc32); SV(_controller.Port); SV(_controller.SubPort); SV(_paused);
+		SV(_romFilename); SV(_crc32); SV(_controller.Port); SV(_controller.SubPort); SV(_paused); SV(_rollback);
 	}
 
 public:
 	GameInformationMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
 
-	GameInformationMessage(string filepath, uint32_t crc32, NetplayControllerInfo controller, bool paused) : NetMessage(MessageType::GameInformation)
+	GameInformationMessage(string filepath, uint32_t crc32, NetplayControllerInfo controller, bool paused, bool rollback) : NetMessage(MessageType::GameInformation)
 	{
 		_romFilename = FolderUtilities::GetFilename(filepath, true);
 		_crc32 = crc32;
 		_controller = controller;
 		_paused = paused;
+		_rollback = rollback;
 	}
 	
 	NetplayControllerInfo GetPort()
@@ -49,4 +51,9 @@ public:
 	{
 		return _paused;
 	}
+
+	bool IsRollbackEnabled()
+	{
+		return _rollback;
+	}
 };
\ No newline at end of file
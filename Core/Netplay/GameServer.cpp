@@ -2,12 +2,14 @@
 #include "Netplay/GameServer.h"
 #include "Netplay/GameServerConnection.h"
 #include "Netplay/PlayerListMessage.h"
+#include "Netplay/NetplayState.h"
 #include "Shared/Emulator.h"
 #include "Shared/BaseControlManager.h"
 #include "Shared/NotificationManager.h"
 #include "Shared/MessageManager.h"
 #include "Utilities/Socket.h"
 #include "Shared/ControllerHub.h"
+#include "Shared/PerformanceCounters.h"
 
 GameServer::GameServer(Emulator* emu)
 {
@@ -54,6 +56,12 @@ void GameServer::UpdateConnections()
 
 bool GameServer::SetInput(BaseControlDevice *device)
 {
+	if(_rollbackEnabled) {
+		//Remote players' inputs are predicted until they are received, local inputs are sent to the clients at the end of the frame
+		_emu->GetRollbackManager()->SetInput(device);
+		return true;
+	}
+
 	uint8_t port = device->GetPort();
 	IControllerHub* hub = dynamic_cast<IControllerHub*>(device);
 	if(hub) {
@@ -84,6 +92,11 @@ bool GameServer::SetInput(BaseControlDevice *device)
 
 void GameServer::RecordInput(vector<shared_ptr<BaseControlDevice>> devices)
 {
+	if(_rollbackEnabled) {
+		//Clients run their own emulation in rollback mode, only the inputs are sent (see SendRollbackInputs)
+		return;
+	}
+
 	for(shared_ptr<BaseControlDevice> &device : devices) {
 		for(unique_ptr<GameServerConnection>& connection : _openConnections) {
 			if(!connection->ConnectionError()) {
@@ -94,6 +107,11 @@ void GameServer::RecordInput(vector<shared_ptr<BaseControlDevice>> devices)
 	}
 }
 
+void GameServer::DiscardInputs(uint32_t pollCount)
+{
+	//Only called for rollbacks - inputs are not sent by RecordInput in rollback mode
+}
+
 void GameServer::ProcessNotification(ConsoleNotificationType type, void * parameter)
 {
 	for(unique_ptr<GameServerConnection>& connection : _openConnections) {
@@ -116,17 +134,134 @@ void GameServer::Exec()
 	MessageManager::DisplayMessage("NetPlay" , "ServerStarted", std::to_string(_port));
 
 	while(!_stop) {
+		//Wait until a client connects/sends data, a socket can accept more data, or the emulation thread has data to send
+		_poller.Clear();
+		_poller.Add(_listener.get(), false);
+		for(unique_ptr<GameServerConnection>& connection : _openConnections) {
+			_poller.Add(connection->GetSocket(), connection->HasPendingData());
+		}
+		_poller.Wait(GameConnection::IsLatencySimulated() ? 1 : 100);
+
+		PERF_TIMER(_emu->GetPerformanceCounters(), Netplay);
 		AcceptConnections();
 		UpdateConnections();
+		SendStateSync();
+		SendRollbackInputs();
+		SendPendingData();
+	}
+}
 
-		std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(1));
+void GameServer::SendStateSync()
+{
+	//Requests made after this point are handled on the next iteration, with a newer state
+	vector<GameServerConnection*> connections;
+	for(unique_ptr<GameServerConnection>& connection : _openConnections) {
+		if(connection->StartStateSync()) {
+			connections.push_back(connection.get());
+		}
+	}
+
+	if(connections.empty()) {
+		return;
+	}
+
+	//Save the state once for all the connections that need it, no matter how many clients are connected
+	shared_ptr<NetplayState> state;
+	{
+		auto lock = _emu->AcquireLock();
+		if(_emu->IsRunning()) {
+			state.reset(new NetplayState(_emu, ++_lastStateId));
+
+			//The movie data the emulation thread sends for the next frames must reach the clients after the state,
+			//hold it until the state has been encoded and queued (the emulation doesn't wait for the encoding)
+			for(GameServerConnection* connection : connections) {
+				connection->HoldMessages();
+			}
+		}
+	}
+
+	//Clients that acknowledged the same state receive the same data, only build each packet once
+	unordered_map<uint32_t, vector<uint8_t>> packets;
+	for(GameServerConnection* connection : connections) {
+		NetplayState* baseState = connection->GetAckedState();
+		vector<uint8_t>& packet = packets[baseState ? baseState->GetId() : 0];
+		if(state && packet.empty()) {
+			state->Encode(baseState, packet);
+		}
+		connection->SendStateSync(state, packet);
+	}
+}
+
+void GameServer::SendPendingData()
+{
+	for(unique_ptr<GameServerConnection>& connection : _openConnections) {
+		if(!connection->ConnectionError()) {
+			connection->SendPendingData();
+		}
 	}
 }
 
-void GameServer::StartServer(uint16_t port, string password)
+void GameServer::SendRollbackInputs()
+{
+	if(!_rollbackEnabled) {
+		return;
+	}
+
+	RollbackFrameInput input;
+	while(_emu->GetRollbackManager()->GetLocalInput(input)) {
+		for(unique_ptr<GameServerConnection>& connection : _openConnections) {
+			connection->SendRollbackInput(input);
+		}
+	}
+}
+
+void GameServer::ProcessRollbackInput(GameServerConnection* connection, RollbackFrameInput& input)
+{
+	//Only accept inputs for the controller the client is using
+	NetplayControllerInfo port = connection->GetControllerPort();
+	RollbackFrameInput validInput;
+	validInput.Frame = input.Frame;
+	for(RollbackControllerInput& controllerInput : input.Inputs) {
+		if(controllerInput.Controller.Port == port.Port && controllerInput.Controller.SubPort == port.SubPort) {
+			validInput.Inputs.push_back(controllerInput);
+		}
+	}
+
+	if(validInput.Inputs.empty()) {
+		return;
+	}
+
+	bool inSync = true;
+	for(RollbackControllerInput& controllerInput : validInput.Inputs) {
+		inSync &= _emu->GetRollbackManager()->AddRemoteInput(validInput.Frame, controllerInput.Controller, controllerInput.State);
+	}
+
+	//Forward the input to the other clients
+	for(unique_ptr<GameServerConnection>& otherConnection : _openConnections) {
+		if(otherConnection.get() != connection) {
+			otherConnection->SendRollbackInput(validInput);
+		}
+	}
+
+	if(!inSync) {
+		//Input arrived too late to roll back, send the current state to all clients to get everyone back in sync
+		MessageManager::Log("[Netplay] Input received too late, resynchronizing clients.");
+		for(unique_ptr<GameServerConnection>& otherConnection : _openConnections) {
+			otherConnection->RequestStateSync();
+		}
+	}
+}
+
+void GameServer::StartServer(uint16_t port, string password, bool rollback)
 {
 	_port = port;
 	_password = password;
+	_rollbackEnabled = rollback;
+
+	if(_rollbackEnabled) {
+		auto lock = _emu->AcquireLock();
+		_emu->GetRollbackManager()->Start(false, &_poller);
+	}
 
 	_emu->GetNotificationManager()->RegisterNotificationListener(shared_from_this());
 
@@ -143,6 +278,7 @@ void GameServer::StopServer()
 	}
 
 	_stop = true;
+	_poller.Wake();
 
 	if(_serverThread) {
 		_serverThread->join();
@@ -156,6 +292,11 @@ void GameServer::StopServer()
 
 	_emu->UnregisterInputRecorder(this);
 	_emu->UnregisterInputProvider(this);
+
+	if(_rollbackEnabled) {
+		_emu->GetRollbackManager()->Stop();
+		_rollbackEnabled = false;
+	}
 }
 
 bool GameServer::Started()
@@ -257,7 +398,14 @@ void GameServer::SendPlayerList()
 
 void GameServer::RegisterNetPlayDevice(GameServerConnection* device, NetplayControllerInfo controller)
 {
+	if(controller.Port == GameConnection::SpectatorPort) {
+		return;
+	}
+
 	_netPlayDevices[controller.Port][controller.SubPort] = device;
+	if(_rollbackEnabled) {
+		_emu->GetRollbackManager()->SetRemote(controller, true);
+	}
 }
 
 void GameServer::UnregisterNetPlayDevice(GameServerConnection* device)
@@ -267,6 +415,10 @@ void GameServer::UnregisterNetPlayDevice(GameServerConnection* device)
 			for(int j = 0; j < IControllerHub::MaxSubPorts; j++) {
 				if(_netPlayDevices[i][j] == device) {
 					_netPlayDevices[i][j] = nullptr;
+					if(_rollbackEnabled) {
+						//The host takes control of the controller again
+						_emu->GetRollbackManager()->SetRemote(NetplayControllerInfo { (uint8_t)i, (uint8_t)j }, false);
+					}
 					return;
 				}
 			}
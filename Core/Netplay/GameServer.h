@@ -3,10 +3,12 @@
 #include <thread>
 #include "Netplay/GameServerConnection.h"
 #include "Netplay/NetplayTypes.h"
+#include "Netplay/RollbackManager.h"
 #include "Shared/Interfaces/INotificationListener.h"
 #include "Shared/Interfaces/IInputProvider.h"
 #include "Shared/Interfaces/IInputRecorder.h"
 #include "Shared/IControllerHub.h"
+#include "Utilities/SocketPoller.h"
 
 class Emulator;
 
@@ -16,9 +18,12 @@ private:
 	Emulator* _emu;
 	unique_ptr<thread> _serverThread;
 	unique_ptr<Socket> _listener;
+	SocketPoller _poller;
 	atomic<bool> _stop;
 	uint16_t _port = 0;
 	string _password;
+	bool _rollbackEnabled = false;
+	uint32_t _lastStateId = 0;
 	vector<unique_ptr<GameServerConnection>> _openConnections;
 	bool _initialized = false;
 	
@@ -28,6 +33,9 @@ private:
 
 	void AcceptConnections();
 	void UpdateConnections();
+	void SendStateSync();
+	void SendRollbackInputs();
+	void SendPendingData();
 
 	void Exec();
 
@@ -37,9 +45,11 @@ public:
 
 	void RegisterServerInput();
 
-	void StartServer(uint16_t port, string password);
+	void StartServer(uint16_t port, string password, bool rollback);
 	void StopServer();
 	bool Started();
+	bool IsRollbackEnabled() { return _rollbackEnabled; }
+	SocketPoller* GetPoller() { return &_poller; }
 
 	NetplayControllerInfo GetHostControllerPort();
 	void SetHostControllerPort(NetplayControllerInfo controller);
@@ -51,6 +61,7 @@ public:
 
 	bool SetInput(BaseControlDevice *device) override;
 	void RecordInput(vector<shared_ptr<BaseControlDevice>> devices) override;
+	void DiscardInputs(uint32_t pollCount) override;
 
 	// Inherited via INotificationListener
 	virtual void ProcessNotification(ConsoleNotificationType type, void * parameter) override;
@@ -59,4 +70,6 @@ public:
 	void UnregisterNetPlayDevice(GameServerConnection* device);
 	NetplayControllerInfo GetFirstFreeControllerPort();
 	GameServerConnection* GetNetPlayDevice(NetplayControllerInfo controller);
+
+	void ProcessRollbackInput(GameServerConnection* connection, RollbackFrameInput& input);
 };
\ No newline at end of file
@@ -12,17 +12,21 @@
 #include "Netplay/GameServer.h"
 #include "Netplay/ForceDisconnectMessage.h"
 #include "Netplay/ServerInformationMessage.h"
+#include "Netplay/RollbackInputMessage.h"
+#include "Netplay/StateAckMessage.h"
+#include "Netplay/NetplayState.h"
 #include "Netplay/NetplayTypes.h"
 #include "Shared/MessageManager.h"
 #include "Shared/Emulator.h"
 #include "Shared/EmuSettings.h"
 #include "Shared/BaseControlDevice.h"
 
-GameServerConnection::GameServerConnection(GameServer* gameServer, Emulator* emu, unique_ptr<Socket> socket, string serverPassword) : GameConnection(emu, std::move(socket))
+GameServerConnection::GameServerConnection(GameServer* gameServer, Emulator* emu, unique_ptr<Socket> socket, string serverPassword) : GameConnection(emu, std::move(socket), gameServer->GetPoller())
 {
 	//Server-side connection
 	_server = gameServer;
 	_serverPassword = serverPassword;
+	_stateSyncPending = false;
 	_controllerPort = NetplayControllerInfo { GameConnection::SpectatorPort, 0 };
 	SendServerInformation();
 }
@@ -50,14 +54,49 @@ void GameServerConnection::SendServerInformation()
 	SendNetMessage(message);
 }
 
-void GameServerConnection::SendGameInformation()
+void GameServerConnection::RequestStateSync()
 {
-	auto lock = _emu->AcquireLock();
-	RomInfo romInfo = _emu->GetRomInfo();
-	GameInformationMessage gameInfo(romInfo.RomFile.GetFileName(), _emu->GetCrc32(), _controllerPort, _emu->IsPaused());
-	SendNetMessage(gameInfo);
-	SaveStateMessage saveState(_emu);
-	SendNetMessage(saveState);
+	//Requests from multiple connections (and multiple notifications) are combined and sent by the server thread,
+	//to only pause the emulation and save the state once
+	_stateSyncPending = true;
+	_poller->Wake();
+}
+
+void GameServerConnection::SendStateSync(shared_ptr<NetplayState> state, vector<uint8_t>& statePacket)
+{
+	if(!state) {
+		//No game is running
+		return;
+	}
+
+	//The messages sent by the emulation thread since the state was saved are held (see GameServer::SendStateSync),
+	//queue the game information and state first, and then release them
+	GameInformationMessage gameInfo(state->GetRomFilename(), state->GetCrc32(), _controllerPort, state->IsPaused(), _server->IsRollbackEnabled());
+	vector<uint8_t> gameInfoPacket;
+	gameInfo.Encode(gameInfoPacket);
+	SendPacket(gameInfoPacket);
+	SendPacket(statePacket);
+	ReleaseMessages();
+
+	//Wait for the client to acknowledge this state before sending another one
+	_sentState = state;
+	_waitingForAck = true;
+}
+
+void GameServerConnection::ProcessStateAck(uint32_t stateId)
+{
+	if(_sentState && _sentState->GetId() == stateId) {
+		_ackedState = _sentState;
+	} else if(!_ackedState || _ackedState->GetId() != stateId) {
+		//Client doesn't have any state the server knows about (e.g it could not apply the delta), the next state is sent in full
+		_ackedState.reset();
+		if(stateId == 0) {
+			_stateSyncPending = true;
+		}
+	}
+
+	_sentState.reset();
+	_waitingForAck = false;
 }
 
 void GameServerConnection::SendMovieData(uint8_t port, ControlDeviceState state)
@@ -68,6 +107,14 @@ void GameServerConnection::SendMovieData(uint8_t port, ControlDeviceState state)
 	}
 }
 
+void GameServerConnection::SendRollbackInput(RollbackFrameInput& input)
+{
+	if(_handshakeCompleted) {
+		RollbackInputMessage message(input);
+		SendNetMessage(message);
+	}
+}
+
 void GameServerConnection::SendForceDisconnectMessage(string disconnectMessage)
 {
 	ForceDisconnectMessage message(disconnectMessage);
@@ -103,7 +150,7 @@ void GameServerConnection::ProcessHandshakeResponse(HandShakeMessage* message)
 			MessageManager::DisplayMessage("NetPlay", "Player connected.");
 
 			if(_emu->IsRunning()) {
-				SendGameInformation();
+				RequestStateSync();
 			}
 
 			_handshakeCompleted = true;
@@ -133,6 +180,17 @@ void GameServerConnection::ProcessMessage(NetMessage* message)
 			PushState(((InputDataMessage*)message)->GetInputState());
 			break;
 
+		case MessageType::RollbackInput:
+			if(!_handshakeCompleted) {
+				SendForceDisconnectMessage("Handshake has not been completed - invalid packet");
+				return;
+			} else if(!((RollbackInputMessage*)message)->IsValid()) {
+				SendForceDisconnectMessage("Invalid rollback input message");
+				return;
+			}
+			_server->ProcessRollbackInput(this, ((RollbackInputMessage*)message)->GetInput());
+			break;
+
 		case MessageType::SelectController:
 			if(!_handshakeCompleted) {
 				SendForceDisconnectMessage("Handshake has not been completed - invalid packet");
@@ -141,6 +199,14 @@ void GameServerConnection::ProcessMessage(NetMessage* message)
 			SelectControllerPort(((SelectControllerMessage*)message)->GetController());
 			break;
 
+		case MessageType::StateAck:
+			if(!_handshakeCompleted) {
+				SendForceDisconnectMessage("Handshake has not been completed - invalid packet");
+				return;
+			}
+			ProcessStateAck(((StateAckMessage*)message)->GetStateId());
+			break;
+
 		default:
 			break;
 	}
@@ -166,7 +232,7 @@ void GameServerConnection::SelectControllerPort(NetplayControllerInfo controller
 			//Another player is using this port, we can't use it
 		}
 	}
-	SendGameInformation();
+	RequestStateSync();
 	_server->SendPlayerList();
 }
 
@@ -180,7 +246,7 @@ void GameServerConnection::ProcessNotification(ConsoleNotificationType type, voi
 		case ConsoleNotificationType::StateLoaded:
 		case ConsoleNotificationType::CheatsChanged:
 		case ConsoleNotificationType::ConfigChanged:
-			SendGameInformation();
+			RequestStateSync();
 			break;
 		
 		case ConsoleNotificationType::PpuFrameDone: {
@@ -193,7 +259,7 @@ void GameServerConnection::ProcessNotification(ConsoleNotificationType type, voi
 			s.SaveTo(currentConfig, 0);
 
 			if(_previousConfig != currentConfig.str()) {
-				SendGameInformation();
+				RequestStateSync();
 			}
 			_previousConfig = currentConfig.str();
 			break;
@@ -201,7 +267,7 @@ void GameServerConnection::ProcessNotification(ConsoleNotificationType type, voi
 
 		case ConsoleNotificationType::BeforeEmulationStop: {
 			//Make clients unload the current game
-			GameInformationMessage gameInfo("", 0, _controllerPort, true);
+			GameInformationMessage gameInfo("", 0, _controllerPort, true, _server->IsRollbackEnabled());
 			SendNetMessage(gameInfo);
 			break;
 		}
@@ -10,6 +10,8 @@
 
 class HandShakeMessage;
 class GameServer;
+class NetplayState;
+struct RollbackFrameInput;
 
 class GameServerConnection final : public GameConnection, public INotificationListener
 {
@@ -26,14 +28,20 @@ private:
 	string _serverPassword;
 	bool _handshakeCompleted = false;
 
+	//States are sent as a delta against the last state the client acknowledged
+	atomic<bool> _stateSyncPending;
+	bool _waitingForAck = false;
+	shared_ptr<NetplayState> _sentState;
+	shared_ptr<NetplayState> _ackedState;
+
 	void PushState(ControlDeviceState state);
 	void SendServerInformation();
-	void SendGameInformation();
 	void SelectControllerPort(NetplayControllerInfo port);
 
 	void SendForceDisconnectMessage(string disconnectMessage);
 
 	void ProcessHandshakeResponse(HandShakeMessage* message);
+	void ProcessStateAck(uint32_t stateId);
 
 protected:
 	void ProcessMessage(NetMessage* message) override;
@@ -44,6 +52,13 @@ public:
 
 	ControlDeviceState GetState();
 	void SendMovieData(uint8_t port, ControlDeviceState state);
+	void SendRollbackInput(RollbackFrameInput& input);
+
+	//Can be called from any thread - the game information and state are sent by the server thread (see GameServer::SendStateSync)
+	void RequestStateSync();
+	bool StartStateSync() { return !_waitingForAck && _stateSyncPending.exchange(false); }
+	NetplayState* GetAckedState() { return _ackedState.get(); }
+	void SendStateSync(shared_ptr<NetplayState> state, vector<uint8_t>& statePacket);
 
 	NetplayControllerInfo GetControllerPort();
 
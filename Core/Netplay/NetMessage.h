@@ -40,7 +40,8 @@ public:
 		return _type;
 	}
 
-	void Send(Socket &socket)
+	//Serializes the message, including its header - the result can be sent to any number of connections
+	void Encode(vector<uint8_t>& packet)
 	{
 		Serializer s(SaveStateManager::FileFormatVersion, true);
 		Serialize(s);
@@ -50,8 +51,18 @@ public:
 
 		string data = out.str();
 		uint32_t messageLength = (uint32_t)data.size() + 1;
-		data = string((char*)&messageLength, 4) + (char)_type + data;
-		socket.Send((char*)data.c_str(), (int)data.size(), 0);
+		packet.resize(data.size() + 5);
+		memcpy(packet.data(), &messageLength, 4);
+		packet[4] = (uint8_t)_type;
+		memcpy(packet.data() + 5, data.data(), data.size());
+	}
+
+	//Queues the message in the socket's send buffer (GameConnection::SendPendingData sends it)
+	void Send(Socket &socket)
+	{
+		vector<uint8_t> packet;
+		Encode(packet);
+		socket.BufferedSend((char*)packet.data(), (int)packet.size());
 	}
 
 protected:
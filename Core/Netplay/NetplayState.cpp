@@ -0,0 +1,32 @@
+#include "pch.h"
+#include "Netplay/NetplayState.h"
+#include "Netplay/SaveStateMessage.h"
+#include "Shared/Emulator.h"
+#include "Shared/RewindData.h"
+
+NetplayState::NetplayState(Emulator* emu, uint32_t id)
+{
+	_id = id;
+	_romFilename = emu->GetRomInfo().RomFile.GetFileName();
+	_crc32 = emu->GetCrc32();
+	_paused = emu->IsPaused();
+	_activeCheats = emu->GetCheatManager()->GetCheats();
+
+	//Saved without compression, to be able to compare it with previous states
+	//(the message containing the state is compressed before being sent)
+	stringstream state;
+	emu->Serialize(state, true, 0);
+
+	string data = state.str();
+	_stateData.assign(data.begin(), data.end());
+}
+
+void NetplayState::Encode(NetplayState* baseState, vector<uint8_t>& packet)
+{
+	vector<uint8_t> noBaseState;
+	vector<uint8_t> pageData;
+	RewindData::GetDirtyPages(_stateData.data(), (uint32_t)_stateData.size(), baseState ? baseState->_stateData : noBaseState, pageData);
+
+	SaveStateMessage message(_id, baseState ? baseState->GetId() : 0, pageData, _activeCheats);
+	message.Encode(packet);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "pch.h"
+#include "Shared/CheatManager.h"
+
+class Emulator;
+
+//Emulator state captured by the server to resynchronize clients - captured once and shared by all
+//connections that need to be updated at the same time
+class NetplayState
+{
+private:
+	uint32_t _id = 0;
+	string _romFilename;
+	uint32_t _crc32 = 0;
+	bool _paused = false;
+	vector<CheatCode> _activeCheats;
+	vector<uint8_t> _stateData;
+
+public:
+	//Must be called while the emulation is paused (emulator lock held)
+	NetplayState(Emulator* emu, uint32_t id);
+
+	uint32_t GetId() { return _id; }
+	string GetRomFilename() { return _romFilename; }
+	uint32_t GetCrc32() { return _crc32; }
+	bool IsPaused() { return _paused; }
+
+	//Builds the SaveState message's packet - only contains the parts of the state that differ from baseState (if not null)
+	void Encode(NetplayState* baseState, vector<uint8_t>& packet);
+};
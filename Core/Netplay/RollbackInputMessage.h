@@ -0,0 +1,54 @@
+#pragma once
+#include "pch.h"
+#include "Netplay/NetMessage.h"
+#include "Netplay/RollbackManager.h"
+#include "Shared/BaseControlDevice.h"
+#include "Shared/IControllerHub.h"
+
+class RollbackInputMessage : public NetMessage
+{
+private:
+	RollbackFrameInput _input;
+	bool _valid = true;
+
+protected:
+	void Serialize(Serializer &s) override
+	{
+		SV(_input.Frame);
+
+		uint32_t inputCount = (uint32_t)_input.Inputs.size();
+		SV(inputCount);
+		if(!s.IsSaving()) {
+			if(inputCount > BaseControlDevice::PortCount * IControllerHub::MaxSubPorts) {
+				//Can't be a valid message, don't allocate memory based on the count sent by the other side
+				_valid = false;
+				inputCount = 0;
+			}
+			_input.Inputs.resize(inputCount);
+		}
+
+		for(uint32_t i = 0; i < inputCount; i++) {
+			SVI(_input.Inputs[i].Controller.Port);
+			SVI(_input.Inputs[i].Controller.SubPort);
+			SVVectorI(_input.Inputs[i].State.State);
+		}
+	}
+
+public:
+	RollbackInputMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
+
+	RollbackInputMessage(RollbackFrameInput& input) : NetMessage(MessageType::RollbackInput)
+	{
+		_input = input;
+	}
+
+	bool IsValid()
+	{
+		return _valid;
+	}
+
+	RollbackFrameInput& GetInput()
+	{
+		return _input;
+	}
+};
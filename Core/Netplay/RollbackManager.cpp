@@ -0,0 +1,378 @@
+#include "pch.h"
+#include "Netplay/RollbackManager.h"
+#include "Shared/Emulator.h"
+#include "Shared/MessageManager.h"
+#include "Utilities/SocketPoller.h"
+
+RollbackManager::RollbackManager(Emulator* emu)
+{
+	_emu = emu;
+	_enabled = false;
+	ClearHistory();
+}
+
+void RollbackManager::Start(bool remoteByDefault, SocketPoller* poller)
+{
+	auto lock = _lock.AcquireSafe();
+	_poller = poller;
+	for(int i = 0; i < RollbackManager::ControllerCount; i++) {
+		_isRemote[i] = remoteByDefault;
+	}
+	ClearHistory();
+	_enabled = true;
+}
+
+void RollbackManager::Stop()
+{
+	_enabled = false;
+
+	{
+		auto lock = _lock.AcquireSafe();
+		ClearHistory();
+	}
+	WakeUp();
+}
+
+void RollbackManager::Reset()
+{
+	//Called after a state is loaded (e.g when the server sends its state to the client)
+	{
+		auto lock = _lock.AcquireSafe();
+		ClearHistory();
+	}
+	WakeUp();
+}
+
+void RollbackManager::ClearHistory()
+{
+	_frames.clear();
+	_pendingInputs.clear();
+	for(uint32_t i = 0; i < RollbackManager::SnapshotCount; i++) {
+		_snapshotFrames[i] = -1;
+	}
+	for(int i = 0; i < RollbackManager::ControllerCount; i++) {
+		_isUsed[i] = false;
+		_isActive[i] = false;
+		_confirmedFrame[i] = -1;
+		_confirmedState[i] = {};
+		_localState[i] = {};
+	}
+	_currentFrame = -1;
+	_emulatedFrame = -1;
+	_rollbackFrame = -1;
+}
+
+void RollbackManager::SetRemote(NetplayControllerInfo controller, bool remote)
+{
+	if(controller.Port >= BaseControlDevice::PortCount || controller.SubPort >= IControllerHub::MaxSubPorts) {
+		return;
+	}
+
+	auto lock = _lock.AcquireSafe();
+	int index = GetIndex(controller);
+	_isRemote[index] = remote;
+	_isActive[index] = false;
+	_isUsed[index] = false;
+
+	//The remote player's input is expected starting from the next frame
+	_confirmedFrame[index] = _currentFrame;
+	_confirmedState[index] = {};
+	_inputSignal.Signal();
+}
+
+RollbackManager::FrameInputs* RollbackManager::GetFrame(int64_t frame, bool create)
+{
+	if(frame < 0) {
+		return nullptr;
+	}
+
+	if(_frames.empty()) {
+		if(!create) {
+			return nullptr;
+		}
+		_frames.emplace_back();
+		_frames.back().Frame = (uint32_t)frame;
+	}
+
+	if(create) {
+		while(frame < _frames.front().Frame) {
+			uint32_t firstFrame = _frames.front().Frame;
+			_frames.emplace_front();
+			_frames.front().Frame = firstFrame - 1;
+		}
+		while(frame > _frames.back().Frame) {
+			uint32_t lastFrame = _frames.back().Frame;
+			_frames.emplace_back();
+			_frames.back().Frame = lastFrame + 1;
+		}
+	}
+
+	if(frame < _frames.front().Frame || frame > _frames.back().Frame) {
+		return nullptr;
+	}
+	return &_frames[(size_t)(frame - _frames.front().Frame)];
+}
+
+void RollbackManager::SetInput(BaseControlDevice* device)
+{
+	auto lock = _lock.AcquireSafe();
+
+	uint8_t port = device->GetPort();
+	IControllerHub* hub = dynamic_cast<IControllerHub*>(device);
+	if(hub) {
+		for(int i = 0, len = hub->GetHubPortCount(); i < len; i++) {
+			shared_ptr<BaseControlDevice> hubController = hub->GetController(i);
+			if(hubController) {
+				ApplyInput(hubController.get(), NetplayControllerInfo { port, (uint8_t)i });
+			}
+		}
+		hub->RefreshHubState();
+	} else {
+		ApplyInput(device, NetplayControllerInfo { port, 0 });
+	}
+}
+
+void RollbackManager::ApplyInput(BaseControlDevice* device, NetplayControllerInfo controller)
+{
+	if(controller.Port >= BaseControlDevice::PortCount || controller.SubPort >= IControllerHub::MaxSubPorts) {
+		return;
+	}
+
+	FrameInputs* frame = GetFrame(_emulatedFrame, true);
+	if(!frame) {
+		return;
+	}
+
+	int index = GetIndex(controller);
+	ControllerFrameInput& input = frame->Controllers[index];
+	if(_isRemote[index]) {
+		if(input.Confirmed) {
+			device->SetRawState(input.State);
+		} else if(!_confirmedState[index].State.empty()) {
+			//Input hasn't been received yet for this frame, assume the player is still pressing the same buttons
+			device->SetRawState(_confirmedState[index]);
+		}
+		_isUsed[index] = true;
+	} else {
+		if(input.Confirmed) {
+			device->SetRawState(input.State);
+		} else {
+			//The first time the controller is polled in a frame, its current state becomes the input for the frame
+			input.State = device->GetRawState();
+			input.Confirmed = true;
+			_localState[index] = input.State;
+			_isActive[index] = true;
+		}
+	}
+
+	input.UsedState = device->GetRawState();
+	input.Used = true;
+}
+
+void RollbackManager::BeginFrame(uint32_t frame, bool isRollback)
+{
+	auto lock = _lock.AcquireSafe();
+
+	if(!isRollback) {
+		if(_currentFrame >= 0 && frame != _currentFrame + 1) {
+			//Frame counter changed (reset, state loaded, etc.), the inputs/states saved so far can't be used anymore
+			ClearHistory();
+		}
+
+		if(_currentFrame < 0) {
+			for(int i = 0; i < RollbackManager::ControllerCount; i++) {
+				if(_isRemote[i] && _confirmedFrame[i] < 0) {
+					_confirmedFrame[i] = (int64_t)frame - 1;
+				}
+			}
+		}
+
+		_currentFrame = frame;
+
+		while(!_frames.empty() && (int64_t)_frames.front().Frame + RollbackManager::SnapshotCount <= _currentFrame) {
+			_frames.pop_front();
+		}
+	}
+
+	_emulatedFrame = frame;
+	GetFrame(frame, true);
+}
+
+void RollbackManager::EndFrame(uint32_t frame)
+{
+	auto lock = _lock.AcquireSafe();
+
+	FrameInputs* frameInputs = GetFrame(frame, true);
+	if(!frameInputs) {
+		return;
+	}
+
+	//Send the input of all local controllers for this frame - controllers that weren't polled keep their previous state
+	RollbackFrameInput localInput;
+	localInput.Frame = frame;
+	for(int i = 0; i < RollbackManager::ControllerCount; i++) {
+		if(_isRemote[i] || !_isActive[i]) {
+			continue;
+		}
+
+		ControllerFrameInput& input = frameInputs->Controllers[i];
+		if(!input.Confirmed) {
+			input.State = _localState[i];
+			input.Confirmed = true;
+		}
+		localInput.Inputs.push_back({ NetplayControllerInfo { (uint8_t)(i / IControllerHub::MaxSubPorts), (uint8_t)(i % IControllerHub::MaxSubPorts) }, input.State });
+	}
+
+	if(localInput.Inputs.size()) {
+		if(_pendingInputs.size() >= 600) {
+			//Nothing is sending the inputs (no connection), don't let the queue grow forever
+			_pendingInputs.pop_front();
+		}
+		_pendingInputs.push_back(std::move(localInput));
+		if(_poller) {
+			_poller->Wake();
+		}
+	}
+}
+
+bool RollbackManager::NeedsToWait(uint32_t frame)
+{
+	auto lock = _lock.AcquireSafe();
+	for(int i = 0; i < RollbackManager::ControllerCount; i++) {
+		if(_isRemote[i] && _isUsed[i] && (int64_t)frame > _confirmedFrame[i] + RollbackManager::MaxPredictionFrames) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void RollbackManager::WaitForInput()
+{
+	//The timeout is only a fallback, AddRemoteInput and WakeUp signal the event
+	_inputSignal.Wait(100);
+}
+
+void RollbackManager::WakeUp()
+{
+	_inputSignal.Signal();
+}
+
+bool RollbackManager::GetRollbackFrame(uint32_t currentFrame, uint32_t& rollbackFrame)
+{
+	auto lock = _lock.AcquireSafe();
+	if(_rollbackFrame < 0) {
+		return false;
+	}
+
+	int64_t frame = _rollbackFrame;
+	_rollbackFrame = -1;
+	if(frame >= currentFrame) {
+		//Frame hasn't been emulated yet, nothing to do
+		return false;
+	}
+
+	if(_snapshotFrames[frame % RollbackManager::SnapshotCount] != frame) {
+		MessageManager::Log("[Netplay] Could not roll back to frame " + std::to_string(frame) + " (state is not available)");
+		return false;
+	}
+
+	//The inputs used in these frames are recorded again when the frames are emulated again
+	for(int64_t i = frame; i < currentFrame; i++) {
+		FrameInputs* frameInputs = GetFrame(i, false);
+		if(frameInputs) {
+			for(int j = 0; j < RollbackManager::ControllerCount; j++) {
+				frameInputs->Controllers[j].Used = false;
+			}
+		}
+	}
+
+	rollbackFrame = (uint32_t)frame;
+	return true;
+}
+
+vector<uint8_t>& RollbackManager::GetSnapshot(uint32_t frame)
+{
+	uint32_t index = frame % RollbackManager::SnapshotCount;
+	_snapshotFrames[index] = frame;
+	return _snapshots[index];
+}
+
+bool RollbackManager::AddRemoteInput(uint32_t frame, NetplayControllerInfo controller, ControlDeviceState& state)
+{
+	if(controller.Port >= BaseControlDevice::PortCount || controller.SubPort >= IControllerHub::MaxSubPorts) {
+		return true;
+	}
+
+	auto lock = _lock.AcquireSafe();
+
+	int index = GetIndex(controller);
+	if(!_enabled || !_isRemote[index] || (int64_t)frame <= _confirmedFrame[index]) {
+		return true;
+	}
+
+	if(!_frames.empty() && frame < _frames.front().Frame) {
+		//Input was received too late, the frame can't be emulated again
+		return false;
+	}
+
+	if(_currentFrame >= 0 && (int64_t)frame > _currentFrame + RollbackManager::MaxFramesAhead) {
+		//Input is for a different timeline (e.g the frame counter was reset), ignore it
+		return true;
+	}
+
+	_confirmedFrame[index] = frame;
+	_confirmedState[index] = state;
+
+	//The emulation thread may be waiting for this input (NeedsToWait)
+	_inputSignal.Signal();
+
+	FrameInputs* frameInputs = GetFrame(frame, true);
+	frameInputs->Controllers[index].State = state;
+	frameInputs->Controllers[index].Confirmed = true;
+
+	//Check if the input that was used for this frame (and the predictions for the following frames) matches the actual input
+	for(int64_t i = frame; i <= _currentFrame; i++) {
+		FrameInputs* usedFrame = GetFrame(i, false);
+		if(!usedFrame) {
+			continue;
+		}
+
+		ControllerFrameInput& input = usedFrame->Controllers[index];
+		if(input.Used && input.UsedState != (input.Confirmed ? input.State : state)) {
+			if(_rollbackFrame < 0 || i < _rollbackFrame) {
+				_rollbackFrame = i;
+			}
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool RollbackManager::GetLocalInput(RollbackFrameInput& input)
+{
+	auto lock = _lock.AcquireSafe();
+	if(_pendingInputs.empty()) {
+		return false;
+	}
+
+	input = std::move(_pendingInputs.front());
+	_pendingInputs.pop_front();
+	return true;
+}
+
+int32_t RollbackManager::GetFramesBehind()
+{
+	auto lock = _lock.AcquireSafe();
+	int64_t lastFrame = -1;
+	for(int i = 0; i < RollbackManager::ControllerCount; i++) {
+		if(_isRemote[i]) {
+			lastFrame = std::max(lastFrame, _confirmedFrame[i]);
+		}
+	}
+
+	if(_currentFrame < 0 || lastFrame <= _currentFrame) {
+		return 0;
+	}
+	return (int32_t)(lastFrame - _currentFrame);
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "pch.h"
+#include <deque>
+#include "Netplay/NetplayTypes.h"
+#include "Shared/BaseControlDevice.h"
+#include "Shared/ControlDeviceState.h"
+#include "Shared/IControllerHub.h"
+#include "Utilities/SimpleLock.h"
+#include "Utilities/AutoResetEvent.h"
+
+class Emulator;
+class SocketPoller;
+
+struct RollbackControllerInput
+{
+	NetplayControllerInfo Controller = {};
+	ControlDeviceState State = {};
+};
+
+//Inputs for all of the controllers owned by a player, for a specific frame
+struct RollbackFrameInput
+{
+	uint32_t Frame = 0;
+	vector<RollbackControllerInput> Inputs;
+};
+
+//Rollback netplay - the local player's input is used immediately and the other players' input is predicted
+//(by repeating their last known input) until their actual input is received. When a prediction turns out to be
+//wrong, the state saved at the start of that frame is reloaded and the following frames are emulated again.
+class RollbackManager
+{
+public:
+	//Max number of frames the emulation can run ahead of the last input received from another player
+	static constexpr uint32_t MaxPredictionFrames = 12;
+	static constexpr uint32_t SnapshotCount = MaxPredictionFrames + 4;
+
+private:
+	static constexpr int64_t MaxFramesAhead = 3600;
+	static constexpr int ControllerCount = BaseControlDevice::PortCount * IControllerHub::MaxSubPorts;
+
+	struct ControllerFrameInput
+	{
+		ControlDeviceState State;
+		ControlDeviceState UsedState;
+		bool Confirmed = false;
+		bool Used = false;
+	};
+
+	struct FrameInputs
+	{
+		uint32_t Frame = 0;
+		ControllerFrameInput Controllers[RollbackManager::ControllerCount];
+	};
+
+	Emulator* _emu = nullptr;
+	SocketPoller* _poller = nullptr;
+	SimpleLock _lock;
+	atomic<bool> _enabled;
+
+	//Signaled when remote input is received (or when the emulation thread needs to stop waiting for it)
+	AutoResetEvent _inputSignal;
+
+	//Inputs for consecutive frames, starting with the oldest frame that can still be rolled back to
+	std::deque<FrameInputs> _frames;
+
+	vector<uint8_t> _snapshots[RollbackManager::SnapshotCount];
+	int64_t _snapshotFrames[RollbackManager::SnapshotCount] = {};
+
+	bool _isRemote[RollbackManager::ControllerCount] = {};
+	bool _isUsed[RollbackManager::ControllerCount] = {};
+	int64_t _confirmedFrame[RollbackManager::ControllerCount] = {};
+	ControlDeviceState _confirmedState[RollbackManager::ControllerCount] = {};
+
+	bool _isActive[RollbackManager::ControllerCount] = {};
+	ControlDeviceState _localState[RollbackManager::ControllerCount] = {};
+	std::deque<RollbackFrameInput> _pendingInputs;
+
+	int64_t _currentFrame = -1; //Most recent frame (excluding frames that are emulated again after a rollback)
+	int64_t _emulatedFrame = -1; //Frame being emulated
+	int64_t _rollbackFrame = -1;
+
+	int GetIndex(NetplayControllerInfo controller) { return controller.Port * IControllerHub::MaxSubPorts + controller.SubPort; }
+	FrameInputs* GetFrame(int64_t frame, bool create);
+
+	void ClearHistory();
+	void ApplyInput(BaseControlDevice* device, NetplayControllerInfo controller);
+
+public:
+	RollbackManager(Emulator* emu);
+
+	bool IsEnabled() { return _enabled; }
+
+	//remoteByDefault: true for clients (only the client's own controller is local), false for the server
+	//poller: woken up when local inputs are ready to be sent
+	void Start(bool remoteByDefault, SocketPoller* poller);
+	void Stop();
+	void Reset();
+
+	void SetRemote(NetplayControllerInfo controller, bool remote);
+
+	//Emulation thread
+	void SetInput(BaseControlDevice* device);
+	void BeginFrame(uint32_t frame, bool isRollback);
+	void EndFrame(uint32_t frame);
+	bool NeedsToWait(uint32_t frame);
+	void WaitForInput();
+	bool GetRollbackFrame(uint32_t currentFrame, uint32_t& rollbackFrame);
+	vector<uint8_t>& GetSnapshot(uint32_t frame);
+
+	//Network thread
+	bool AddRemoteInput(uint32_t frame, NetplayControllerInfo controller, ControlDeviceState& state);
+	bool GetLocalInput(RollbackFrameInput& input);
+	int32_t GetFramesBehind();
+
+	//Any thread - wakes up the emulation thread if it's in WaitForInput
+	void WakeUp();
+};
@@ -5,44 +5,70 @@
 #include "Shared/EmuSettings.h"
 #include "Shared/CheatManager.h"
 #include "Shared/SaveStateManager.h"
+#include "Shared/RewindData.h"
 
 class SaveStateMessage : public NetMessage
 {
 private:
+	static constexpr uint32_t MaxStateSize = 10 * 1024 * 1024;
+
 	vector<CheatCode> _activeCheats;
+	uint32_t _stateId = 0;
+	uint32_t _baseStateId = 0;
+
+	//Pages of the state that differ from the base state (all pages when there is no base state)
 	vector<uint8_t> _stateData;
 
 protected:
 	void Serialize(Serializer &s) override
 	{
+		SV(_stateId);
+		SV(_baseStateId);
 		SVVector(_stateData);
 		SVVector(_activeCheats);
 	}
 
 public:
 	SaveStateMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
-	
-	SaveStateMessage(Emulator* emu) : NetMessage(MessageType::SaveState)
-	{
-		//Used when sending state to clients
-		stringstream state;
-		{
-			auto lock = emu->AcquireLock();
-			_activeCheats = emu->GetCheatManager()->GetCheats();
-			emu->Serialize(state, true);
-		}
 
-		uint32_t dataSize = (uint32_t)state.tellp();
-		_stateData.resize(dataSize);
-		state.read((char*)_stateData.data(), dataSize);
+	SaveStateMessage(uint32_t stateId, uint32_t baseStateId, vector<uint8_t>& pageData, vector<CheatCode>& activeCheats) : NetMessage(MessageType::SaveState)
+	{
+		//Used when sending state to clients (see NetplayState)
+		_stateId = stateId;
+		_baseStateId = baseStateId;
+		_stateData = std::move(pageData);
+		_activeCheats = activeCheats;
 	}
-	
-	void LoadState(Emulator* emu)
+
+	uint32_t GetStateId() { return _stateId; }
+	uint32_t GetBaseStateId() { return _baseStateId; }
+
+	//baseState: the state matching GetBaseStateId(), replaced by the state that was loaded
+	bool LoadState(Emulator* emu, vector<uint8_t>& baseState)
 	{
+		uint32_t stateSize = 0;
+		if(_stateData.size() >= sizeof(uint32_t)) {
+			memcpy(&stateSize, _stateData.data(), sizeof(uint32_t));
+		}
+
+		if(stateSize == 0 || stateSize > SaveStateMessage::MaxStateSize) {
+			return false;
+		}
+
+		vector<uint8_t> noBaseState;
+		vector<uint8_t> state;
+		if(!RewindData::ApplyDirtyPages(_stateData, _baseStateId ? baseState : noBaseState, state)) {
+			return false;
+		}
+
 		std::stringstream ss;
-		ss.write((char*)_stateData.data(), _stateData.size());
-		emu->Deserialize(ss, SaveStateManager::FileFormatVersion, true);
+		ss.write((char*)state.data(), state.size());
+		if(!emu->Deserialize(ss, SaveStateManager::FileFormatVersion, true)) {
+			return false;
+		}
 
 		emu->GetCheatManager()->SetCheats(_activeCheats);
+		baseState = std::move(state);
+		return true;
 	}
-};
\ No newline at end of file
+};
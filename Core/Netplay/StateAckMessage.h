@@ -0,0 +1,30 @@
+#pragma once
+#include "pch.h"
+#include "Netplay/NetMessage.h"
+
+//Sent by the client after processing a save state - the server sends the next states as a delta against this one
+class StateAckMessage : public NetMessage
+{
+private:
+	uint32_t _stateId = 0;
+
+protected:
+	void Serialize(Serializer &s) override
+	{
+		SV(_stateId);
+	}
+
+public:
+	StateAckMessage(void* buffer, uint32_t length) : NetMessage(buffer, length) { }
+
+	//stateId: id of the last state loaded by the client (0 = client needs a full state)
+	StateAckMessage(uint32_t stateId) : NetMessage(MessageType::StateAck)
+	{
+		_stateId = stateId;
+	}
+
+	uint32_t GetStateId()
+	{
+		return _stateId;
+	}
+};
@@ -187,6 +187,10 @@ void PceScsiBus::CmdRead()
 	_state.Sector = sector;
 	_state.SectorsToRead = sectorsToRead;
 
+	//Start loading the sectors (and the ones after them, since games usually read sequentially)
+	//while the seek delay is being emulated, to avoid stalling the emulation if the disc image is on slow storage
+	_disc->PrefetchSectors(sector, sectorsToRead + PceScsiBus::ReadAheadSectorCount);
+
 	_cdrom->GetAudioPlayer().SetIdle();
 	LogDebug("[SCSI] Read sector: " + std::to_string(_state.Sector) + " to " + std::to_string(_state.Sector + _state.SectorsToRead - 1));
 }
@@ -44,6 +44,7 @@ class PceScsiBus : public ISerializable
 {
 private:
 	constexpr static int ReadBytesPerSecond = 153600; //75 frames/sectors of 2048 bytes per second, like audio
+	constexpr static uint32_t ReadAheadSectorCount = 256;
 
 	DiscInfo* _disc = nullptr;
 	PceConsole* _console = nullptr;
@@ -20,14 +20,12 @@ PceVpc::PceVpc(Emulator* emu, PceConsole* console, PceVce* vce)
 	_console = console;
 	_vce = vce;
 
-	//Add an extra line to the buffer - this is used to store clock divider values for each row
-	uint32_t bufferSize = PceConstants::MaxScreenWidth * (PceConstants::ScreenHeight + 1);
-	_outBuffer[0] = new uint16_t[bufferSize];
-	_outBuffer[1] = new uint16_t[bufferSize];
+	_outBuffer[0] = new uint16_t[PceVpc::OutBufferSize];
+	_outBuffer[1] = new uint16_t[PceVpc::OutBufferSize];
 	_currentOutBuffer = _outBuffer[0];
 
-	memset(_outBuffer[0], 0, bufferSize * sizeof(uint16_t));
-	memset(_outBuffer[1], 0, bufferSize * sizeof(uint16_t));
+	memset(_outBuffer[0], 0, PceVpc::OutBufferSize * sizeof(uint16_t));
+	memset(_outBuffer[1], 0, PceVpc::OutBufferSize * sizeof(uint16_t));
 }
 
 PceVpc::~PceVpc()
@@ -264,9 +262,11 @@ void PceVpc::SendFrame(PceVdc* vdc)
 	if(!_skipRender) {
 		if(_console->GetRomFormat() == RomFormat::PceHes) {
 			RenderedFrame frame(_currentOutBuffer, 256, 240, 1.0, _vdc1->GetState().FrameCount, _console->GetControlManager()->GetPortStates());
+			frame.BufferSize = PceVpc::OutBufferSize;
 			_emu->GetVideoDecoder()->UpdateFrame(frame, forRewind, forRewind);
 		} else {
 			RenderedFrame frame(_currentOutBuffer, PceConstants::InternalOutputWidth, PceConstants::InternalOutputHeight, 1.0 / PceConstants::InternalResMultipler, _vdc1->GetState().FrameCount, _console->GetControlManager()->GetPortStates());
+			frame.BufferSize = PceVpc::OutBufferSize;
 			_emu->GetVideoDecoder()->UpdateFrame(frame, forRewind, forRewind);
 		}
 	}
@@ -294,6 +294,7 @@ void PceVpc::DebugSendFrame()
 	}
 
 	RenderedFrame frame(_currentOutBuffer, PceConstants::InternalOutputWidth, PceConstants::InternalOutputHeight, 0.25, _vdc1->GetState().FrameCount);
+	frame.BufferSize = PceVpc::OutBufferSize;
 	_emu->GetVideoDecoder()->UpdateFrame(frame, false, false);
 }
 
@@ -15,6 +15,9 @@ public:
 	static constexpr uint16_t SpritePixelFlag = 0x8000;
 	static constexpr uint16_t TransparentPixelFlag = 0x4000;
 
+	//Add an extra line to the buffer - this is used to store clock divider values for each row
+	static constexpr uint32_t OutBufferSize = PceConstants::MaxScreenWidth * (PceConstants::ScreenHeight + 1);
+
 private:
 	PceVdc* _vdc1 = nullptr;
 	PceVdc* _vdc2 = nullptr;
@@ -5,6 +5,7 @@
 #include "Shared/Audio/SoundMixer.h"
 #include "Utilities/Serializer.h"
 #include "Utilities/FolderUtilities.h"
+#include "Utilities/StringUtilities.h"
 
 Msu1* Msu1::Init(Emulator* emu, VirtualFile& romFile, Spc* spc)
 {
@@ -40,6 +41,11 @@ Msu1::Msu1(Emulator* emu, VirtualFile& romFile, Spc* spc)
 		_dataSize = 0;
 	}
 
+	//List the track files once, so that starting a track doesn't need to access the disk
+	for(string& file : FolderUtilities::GetFilesInFolder(_romFolder, { ".pcm" }, false)) {
+		_availableTracks.emplace(StringUtilities::ToLower(FolderUtilities::GetFilename(file, true)));
+	}
+
 	_emu->GetSoundMixer()->RegisterAudioProvider(this);
 }
 
@@ -113,7 +119,13 @@ void Msu1::MixAudio(int16_t* buffer, uint32_t sampleCount, uint32_t sampleRate)
 
 void Msu1::LoadTrack(uint32_t startOffset)
 {
-	_trackMissing = !_pcmReader.Init(_trackPath + "-" + std::to_string(_trackSelect) + ".pcm", _repeat, startOffset);
+	string filename = _trackPath + "-" + std::to_string(_trackSelect) + ".pcm";
+	_trackMissing = _availableTracks.find(StringUtilities::ToLower(FolderUtilities::GetFilename(filename, true))) == _availableTracks.end();
+	if(_trackMissing) {
+		_pcmReader.Stop();
+	} else {
+		_pcmReader.Init(filename, _repeat, startOffset);
+	}
 }
 
 void Msu1::Serialize(Serializer &s)
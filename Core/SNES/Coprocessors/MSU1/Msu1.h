@@ -21,6 +21,7 @@ private:
 	string _romName;
 	string _romFolder;
 	string _trackPath;
+	unordered_set<string> _availableTracks;
 
 	bool _repeat = false;
 	bool _paused = false;
@@ -71,7 +71,7 @@ RowDataType Cx4TraceLogger::GetFormatTagType(string& tag)
 	}
 }
 
-void Cx4TraceLogger::GetTraceRow(string& output, Cx4State& cpuState, TraceLogPpuState& ppuState, DisassemblyInfo& disassemblyInfo)
+void Cx4TraceLogger::GetTraceRow(string& output, Cx4State& cpuState, TraceLogPpuState& ppuState, DisassemblyInfo& disassemblyInfo, TraceLogMemoryState* memState)
 {
 	for(RowPart& rowPart : _rowParts) {
 		switch(rowPart.DataType) {
@@ -109,7 +109,7 @@ void Cx4TraceLogger::GetTraceRow(string& output, Cx4State& cpuState, TraceLogPpu
 			case RowDataType::PB: WriteIntValue(output, cpuState.PB, rowPart); break;
 			case RowDataType::P: WriteIntValue(output, cpuState.P, rowPart); break;
 
-			default: ProcessSharedTag(rowPart, output, cpuState, ppuState, disassemblyInfo); break;
+			default: ProcessSharedTag(rowPart, output, cpuState, ppuState, disassemblyInfo, memState); break;
 		}
 	}
 }
@@ -20,7 +20,7 @@ protected:
 public:
 	SpcTraceLogger(Debugger* debugger, IDebugger* cpuDebugger, SnesPpu* ppu, SnesMemoryManager* memoryManager);
 
-	void GetTraceRow(string &output, SpcState &cpuState, TraceLogPpuState &ppuState, DisassemblyInfo &disassemblyInfo);
+	void GetTraceRow(string &output, SpcState &cpuState, TraceLogPpuState &ppuState, DisassemblyInfo &disassemblyInfo, TraceLogMemoryState* memState = nullptr);
 	void LogPpuState();
 	
 	__forceinline uint32_t GetProgramCounter(SpcState& state) { return state.PC; }
@@ -103,36 +103,36 @@ void SnesDefaultVideoFilter::ApplyFilter(uint16_t *ppuOutputBuffer)
 	uint32_t xOffset = overscan.Left;
 	uint32_t yOffset = overscan.Top * width;
 
+	//Palette lookups can't be vectorized with SSE2/NEON (no gather instructions), keep the loops simple for the compiler
 	if(_baseFrameInfo.Width == 256 && _forceFixedRes) {
 		for(uint32_t i = 0; i < frameInfo.Height; i++) {
+			uint16_t* src = ppuOutputBuffer + i / 2 * width + yOffset + xOffset;
+			uint32_t* dst = out + i * frameInfo.Width;
 			for(uint32_t j = 0; j < frameInfo.Width; j++) {
-				out[i * frameInfo.Width + j] = GetPixel(ppuOutputBuffer, i / 2 * width + j / 2 + yOffset + xOffset);
+				dst[j] = _calculatedPalette[src[j / 2]];
 			}
 		}
 	} else {
 		for(uint32_t i = 0; i < frameInfo.Height; i++) {
+			uint16_t* src = ppuOutputBuffer + i * width + yOffset + xOffset;
+			uint32_t* dst = out + i * frameInfo.Width;
 			for(uint32_t j = 0; j < frameInfo.Width; j++) {
-				out[i*frameInfo.Width+j] = GetPixel(ppuOutputBuffer, i * width + j + yOffset + xOffset);
+				dst[j] = _calculatedPalette[src[j]];
 			}
 		}
 	}
 
 	if(_baseFrameInfo.Width == 512 && _blendHighRes) {
 		//Very basic blend effect for high resolution modes
-		for(uint32_t i = 0; i < frameInfo.Height; i++) {
-			for(uint32_t j = 0; j < frameInfo.Width; j++) {
-				uint32_t &pixel1 = out[i*frameInfo.Width + j];
-				pixel1 = BlendPixels(pixel1, out[i * frameInfo.Width + j + 1]);
-			}
+		//Each pixel is blended with the next (not yet blended) one - this is simple enough for the compiler to auto-vectorize
+		//(the last pixel has no next pixel and is left as-is)
+		uint32_t pixelCount = frameInfo.Height * frameInfo.Width;
+		for(uint32_t i = 0; i + 1 < pixelCount; i++) {
+			out[i] = BlendPixels(out[i], out[i + 1]);
 		}
 	}
 }
 
-uint32_t SnesDefaultVideoFilter::GetPixel(uint16_t* ppuFrame, uint32_t offset)
-{
-	return _calculatedPalette[ppuFrame[offset]];
-}
-
 uint32_t SnesDefaultVideoFilter::BlendPixels(uint32_t a, uint32_t b)
 {
 	return ((((a) ^ (b)) & 0xfffefefeL) >> 1) + ((a) & (b));
@@ -1,28 +1,34 @@
 #include "pch.h"
 #include "Shared/Audio/PcmReader.h"
-#include "Utilities/VirtualFile.h"
 #include "Utilities/Audio/HermiteResampler.h"
 
-PcmReader::PcmReader()
+//Reads the .pcm files used by MSU-1 (8-byte header followed by 16-bit stereo samples at 44.1kHz)
+class PcmStreamDecoder : public IAudioStreamDecoder
 {
-	_done = true;
-	_loopOffset = 8;
-	_outputBuffer = new int16_t[20000];
-}
-
-PcmReader::~PcmReader()
-{
-	delete[] _outputBuffer;
-}
-
-bool PcmReader::Init(string filename, bool loop, uint32_t startOffset)
-{
-	if(_file) {
-		_file.close();
+private:
+	string _filename;
+	ifstream _file;
+	uint32_t _fileOffset = 0;
+	uint32_t _fileSize = 0;
+	uint32_t _loopOffset = 0;
+	uint32_t _length = 0;
+	uint32_t _loopPosition = 0;
+	vector<uint8_t> _readBuffer;
+
+public:
+	PcmStreamDecoder(string filename, uint32_t startOffset)
+	{
+		_filename = filename;
+		_fileOffset = startOffset;
 	}
 
-	_file.open(filename, ios::binary);
-	if(_file) {
+	bool Open() override
+	{
+		_file.open(_filename, ios::binary);
+		if(!_file) {
+			return false;
+		}
+
 		_file.seekg(0, ios::end);
 		_fileSize = (uint32_t)_file.tellg();
 		if(_fileSize < 12) {
@@ -30,102 +36,140 @@ bool PcmReader::Init(string filename, bool loop, uint32_t startOffset)
 		}
 
 		_file.seekg(4, ios::beg);
-		uint32_t loopOffset = (uint8_t)_file.get();
-		loopOffset |= ((uint8_t)_file.get()) << 8;
-		loopOffset |= ((uint8_t)_file.get()) << 16;
-		loopOffset |= ((uint8_t)_file.get()) << 24;
+		uint8_t header[4] = {};
+		_file.read((char*)header, 4);
+		_loopOffset = header[0] | (header[1] << 8) | (header[2] << 16) | (header[3] << 24);
 
-		_loopOffset = (uint32_t)loopOffset;
+		//Positions are file offsets - the samples start after the 8-byte header
+		_length = 8 + (_fileSize - 8) / 4 * 4;
+		uint64_t loopStart = (uint64_t)_loopOffset * 4 + 8;
+		_loopPosition = loopStart + 4 <= _fileSize ? (uint32_t)loopStart : _length;
 
-		_prevLeft = 0;
-		_prevRight = 0;
-		_done = false;
-		_loop = loop;
-		_fileOffset = startOffset;
 		_file.seekg(_fileOffset, ios::beg);
+		return true;
+	}
 
-		_leftoverSampleCount = 0;
-		_pcmBuffer.clear();
-		_resampler.Reset();
+	uint32_t GetSampleRate() override
+	{
+		return 44100;
+	}
 
-		return true;
-	} else {
-		_done = true;
-		return false;
+	uint32_t GetLength() override { return _length; }
+	uint32_t GetLoopPosition() override { return _loopPosition; }
+	uint32_t GetPositionStep() override { return 4; }
+
+	uint32_t Decode(int16_t* samples, uint32_t* positions, uint32_t frameCount, bool loop) override
+	{
+		uint32_t framesRead = 0;
+		while(framesRead < frameCount) {
+			if(_fileOffset + 4 > _fileSize) {
+				uint64_t loopStart = (uint64_t)_loopOffset * 4 + 8;
+				if(!loop || loopStart + 4 > _fileSize) {
+					break;
+				}
+				_fileOffset = (uint32_t)loopStart;
+				_file.clear();
+				_file.seekg(_fileOffset, ios::beg);
+			}
+
+			uint32_t count = std::min(frameCount - framesRead, (_fileSize - _fileOffset) / 4);
+			_readBuffer.resize(count * 4);
+			_file.read((char*)_readBuffer.data(), count * 4);
+			uint32_t bytesRead = (uint32_t)_file.gcount();
+			count = bytesRead / 4;
+			if(count == 0) {
+				//Read error
+				break;
+			}
+
+			for(uint32_t i = 0; i < count; i++) {
+				uint8_t* val = _readBuffer.data() + i * 4;
+				samples[(framesRead + i) * 2] = val[0] | (val[1] << 8);
+				samples[(framesRead + i) * 2 + 1] = val[2] | (val[3] << 8);
+				_fileOffset += 4;
+				positions[framesRead + i] = _fileOffset;
+			}
+			framesRead += count;
+		}
+		return framesRead;
 	}
+};
+
+PcmReader::PcmReader()
+{
+	_done = true;
+	_outputBuffer = new int16_t[20000];
 }
 
-bool PcmReader::IsPlaybackOver()
+PcmReader::~PcmReader()
 {
-	return _done;
+	delete[] _outputBuffer;
 }
 
-void PcmReader::SetSampleRate(uint32_t sampleRate)
+void PcmReader::Init(string filename, bool loop, uint32_t startOffset)
 {
-	if(sampleRate != _sampleRate) {
-		_sampleRate = sampleRate;
+	_done = false;
+	_pcmBuffer.clear();
+	_resampler.Reset();
 
-		_resampler.SetSampleRates(PcmReader::PcmSampleRate, _sampleRate);
+	if(_source && _filename == filename && _source->Seek(startOffset)) {
+		//The requested position is still buffered (e.g when a save state is loaded for run-ahead), keep using the current stream
+		_source->SetLoopFlag(loop);
+		return;
 	}
+
+	Stop();
+	_done = false;
+	_filename = filename;
+
+	//The file is opened and decoded on the stream thread, to avoid blocking the emulation thread
+	_source.reset(new StreamingAudioSource(new PcmStreamDecoder(filename, startOffset), loop, startOffset));
+	_streamThread.Add(_source);
 }
 
-void PcmReader::SetLoopFlag(bool loop)
+void PcmReader::Stop()
 {
-	_loop = loop;
+	if(_source) {
+		_source->Close();
+		_source.reset();
+	}
+	_filename.clear();
+	_done = true;
 }
 
-void PcmReader::ReadSample(int16_t &left, int16_t &right)
+bool PcmReader::IsPlaybackOver()
 {
-	uint8_t val[4];
-	_file.get(((char*)val)[0]);
-	_file.get(((char*)val)[1]);
-	_file.get(((char*)val)[2]);
-	_file.get(((char*)val)[3]);
-
-	left = val[0] | (val[1] << 8);
-	right = val[2] | (val[3] << 8);
+	return _done;
 }
 
-void PcmReader::LoadSamples(uint32_t samplesToLoad)
+void PcmReader::SetSampleRate(uint32_t sampleRate)
 {
-	uint32_t samplesRead = 0;
-
-	int16_t left = 0;
-	int16_t right = 0;
-	for(uint32_t i = _fileOffset; i < _fileSize && samplesRead < samplesToLoad; i+=4) {
-		ReadSample(left, right);
-
-		_pcmBuffer.push_back(left);
-		_pcmBuffer.push_back(right);
-
-		_prevLeft = left;
-		_prevRight = right;
+	if(sampleRate != _sampleRate) {
+		_sampleRate = sampleRate;
 
-		_fileOffset += 4;
-		samplesRead++;
+		_resampler.SetSampleRates(PcmReader::PcmSampleRate, _sampleRate);
+	}
+}
 
-		if(samplesRead < samplesToLoad && i + 4 >= _fileSize) {
-			if(_loop) {
-				i = _loopOffset * 4 + 8;
-				_fileOffset = i;
-				_file.seekg(_fileOffset, ios::beg);
-			} else {
-				_done = true;
-			}
-		}
+void PcmReader::SetLoopFlag(bool loop)
+{
+	if(_source) {
+		_source->SetLoopFlag(loop);
 	}
 }
 
 void PcmReader::ApplySamples(int16_t *buffer, size_t sampleCount, uint8_t volume)
 {
-	if(_done) {
+	if(_done || !_source) {
 		return;
 	}
 
 	int32_t samplesNeeded = (int32_t)sampleCount - _resampler.GetPendingCount();
 	if(samplesNeeded > 0) {
 		uint32_t samplesToLoad = samplesNeeded * PcmReader::PcmSampleRate / _sampleRate + 2;
-		LoadSamples(samplesToLoad);
+		_pcmBuffer.resize(samplesToLoad * 2);
+		uint32_t samplesLoaded = _source->Read(_pcmBuffer.data(), samplesToLoad);
+		_pcmBuffer.resize(samplesLoaded * 2);
 	}
 
 	uint32_t samplesRead = _resampler.Resample<false>(_pcmBuffer.data(), (uint32_t)_pcmBuffer.size() / 2, _outputBuffer, sampleCount);
@@ -135,9 +179,15 @@ void PcmReader::ApplySamples(int16_t *buffer, size_t sampleCount, uint8_t volume
 	for(uint32_t i = 0; i < samplesToProcess; i++) {
 		buffer[i] += (int16_t)((int32_t)_outputBuffer[i] * volume / 255);
 	}
+
+	//The end of the track depends on the number of samples played, not on how far ahead the stream thread is
+	_source->Advance((uint32_t)sampleCount, _sampleRate);
+	if(_source->IsPlaybackOver()) {
+		_done = true;
+	}
 }
 
 uint32_t PcmReader::GetOffset()
 {
-	return _fileOffset;
+	return _source ? _source->GetPosition() : 0;
 }
\ No newline at end of file
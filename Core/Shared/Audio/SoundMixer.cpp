@@ -11,6 +11,7 @@
 #include "Utilities/Audio/Equalizer.h"
 #include "Utilities/Audio/ReverbFilter.h"
 #include "Utilities/Audio/CrossFeedFilter.h"
+#include "Shared/PerformanceCounters.h"
 
 SoundMixer::SoundMixer(Emulator* emu)
 {
@@ -69,6 +70,8 @@ void SoundMixer::PlayAudioBuffer(int16_t* samples, uint32_t sampleCount, uint32_
 		return;
 	}
 
+	PERF_TIMER(_emu->GetPerformanceCounters(), PlayAudio);
+
 	EmuSettings* settings = _emu->GetSettings();
 	AudioPlayerHud* audioPlayer = _emu->GetAudioPlayerHud();
 	AudioConfig cfg = settings->GetAudioConfig();
@@ -92,7 +95,11 @@ void SoundMixer::PlayAudioBuffer(int16_t* samples, uint32_t sampleCount, uint32_
 
 	int16_t *out = _sampleBuffer;
 	memset(_sampleBuffer, 0, 0x10000 * 2);
-	uint32_t count = _resampler->Resample(samples, sampleCount, sourceRate, cfg.SampleRate, out);
+	uint32_t count;
+	{
+		PERF_TIMER(_emu->GetPerformanceCounters(), AudioResample);
+		count = _resampler->Resample(samples, sampleCount, sourceRate, cfg.SampleRate, out);
+	}
 
 	uint32_t targetRate = (uint32_t)(cfg.SampleRate * _resampler->GetRateAdjustment());
 	for(IAudioProvider* provider : _audioProviders) {
@@ -0,0 +1,276 @@
+#include "pch.h"
+#include <algorithm>
+#include "Shared/Audio/StreamingAudioSource.h"
+
+StreamingAudioSource::StreamingAudioSource(IAudioStreamDecoder* decoder, bool loop, uint32_t startPosition)
+{
+	_decoder.reset(decoder);
+	_samples.reset(new int16_t[StreamingAudioSource::BufferSize * 2]);
+	_positions.reset(new uint32_t[StreamingAudioSource::BufferSize]);
+	_writePos = 0;
+	_readPos = 0;
+	_opened = false;
+	_failed = false;
+	_endOfStream = false;
+	_closed = false;
+	_loop = loop;
+	_position = startPosition;
+}
+
+void StreamingAudioSource::Advance(uint32_t outputFrameCount, uint32_t outputSampleRate)
+{
+	if(_ended || outputSampleRate == 0) {
+		return;
+	}
+
+	bool opened = _opened.load(std::memory_order_acquire);
+	if(outputSampleRate != _outputRate) {
+		if(opened || _outputRate == 0) {
+			_outputFrames = 0;
+			_elapsedFrames = 0;
+		} else {
+			//The frames played so far haven't been applied to the position yet, convert them to the new rate
+			_outputFrames = _outputFrames * outputSampleRate / _outputRate;
+		}
+		_outputRate = outputSampleRate;
+	}
+
+	_outputFrames += outputFrameCount;
+	if(!opened) {
+		//The stream thread hasn't opened the file yet - the stream's sample rate and length are needed to update
+		//the position, the frames played until then are applied once it is opened (this never waits for the stream thread)
+		return;
+	}
+
+	//Convert the total number of output frames, to avoid accumulating rounding errors
+	uint64_t elapsedFrames = _outputFrames * _sampleRate / _outputRate;
+	uint32_t frameCount = (uint32_t)(elapsedFrames - _elapsedFrames);
+	_elapsedFrames = elapsedFrames;
+	_expectedReadPos += frameCount;
+
+	uint64_t position = (uint64_t)_position + (uint64_t)frameCount * _positionStep;
+	if(_length > 0) {
+		if(_loop && _loopPosition < _length) {
+			if(position > _length) {
+				position = _loopPosition + (position - _length - 1) % (_length - _loopPosition) + 1;
+			}
+		} else if(position >= _length) {
+			position = _length;
+			_ended = true;
+		}
+	}
+	_position = (uint32_t)position;
+}
+
+uint32_t StreamingAudioSource::Read(int16_t* out, uint32_t frameCount)
+{
+	if(!_opened.load(std::memory_order_acquire)) {
+		return 0;
+	}
+
+	uint32_t readPos = _readPos.load(std::memory_order_relaxed);
+	uint32_t writePos = _writePos.load(std::memory_order_acquire);
+
+	int32_t lag = (int32_t)(_expectedReadPos - readPos);
+	if(lag > (int32_t)StreamingAudioSource::SkipThreshold) {
+		//The decoder thread fell behind, skip the frames that should already have been played
+		readPos += std::min((uint32_t)lag, writePos - readPos);
+	}
+
+	uint32_t count = std::min(frameCount, writePos - readPos);
+	if(count > 0) {
+		uint32_t offset = readPos & StreamingAudioSource::BufferMask;
+		uint32_t firstPart = std::min(count, StreamingAudioSource::BufferSize - offset);
+		memcpy(out, _samples.get() + offset * 2, firstPart * 2 * sizeof(int16_t));
+		if(firstPart < count) {
+			memcpy(out + firstPart * 2, _samples.get(), (count - firstPart) * 2 * sizeof(int16_t));
+		}
+	}
+
+	_readPos.store(readPos + count, std::memory_order_release);
+	return count;
+}
+
+bool StreamingAudioSource::Seek(uint32_t position)
+{
+	if(position == _position) {
+		return true;
+	}
+
+	if(!_opened.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	uint32_t readPos = _readPos.load(std::memory_order_relaxed);
+	uint32_t writePos = _writePos.load(std::memory_order_acquire);
+
+	//Look for the frame that precedes this position, starting with the most recently read frames
+	//The decoder thread never overwrites the last HistorySize frames that were read
+	uint32_t historyCount = std::min(readPos, StreamingAudioSource::HistorySize);
+	for(uint32_t i = 1; i <= historyCount; i++) {
+		if(_positions[(readPos - i) & StreamingAudioSource::BufferMask] == position) {
+			SetReadPosition(readPos - i + 1, position);
+			return true;
+		}
+	}
+
+	for(uint32_t i = readPos; i != writePos; i++) {
+		if(_positions[i & StreamingAudioSource::BufferMask] == position) {
+			SetReadPosition(i + 1, position);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void StreamingAudioSource::SetReadPosition(uint32_t readPos, uint32_t position)
+{
+	//Start counting from the new position, like a new stream would
+	_position = position;
+	_ended = false;
+	_outputFrames = 0;
+	_elapsedFrames = 0;
+	_expectedReadPos = readPos;
+	_readPos.store(readPos, std::memory_order_release);
+}
+
+void StreamingAudioSource::SetLoopFlag(bool loop)
+{
+	_loop = loop;
+}
+
+void StreamingAudioSource::Close()
+{
+	_closed = true;
+}
+
+bool StreamingAudioSource::IsOpened()
+{
+	return _opened.load(std::memory_order_acquire);
+}
+
+bool StreamingAudioSource::IsPlaybackOver()
+{
+	if(_failed || _ended) {
+		return true;
+	} else if(_opened.load(std::memory_order_acquire) && _length == 0) {
+		//The stream's length is unknown, stop when the decoder reaches the end of the stream
+		return _endOfStream.load(std::memory_order_acquire) && _readPos.load(std::memory_order_relaxed) == _writePos.load(std::memory_order_acquire);
+	}
+	return false;
+}
+
+uint32_t StreamingAudioSource::GetSampleRate()
+{
+	return IsOpened() ? _sampleRate : 0;
+}
+
+uint32_t StreamingAudioSource::GetPosition()
+{
+	return _position;
+}
+
+bool StreamingAudioSource::Decode()
+{
+	if(!_opened) {
+		if(!_decoder->Open()) {
+			_failed = true;
+			return false;
+		}
+		_sampleRate = _decoder->GetSampleRate();
+		_length = _decoder->GetLength();
+		_loopPosition = _decoder->GetLoopPosition();
+		_positionStep = _decoder->GetPositionStep();
+		_opened.store(true, std::memory_order_release);
+	}
+
+	if(_endOfStream) {
+		return false;
+	}
+
+	uint32_t writePos = _writePos.load(std::memory_order_relaxed);
+	uint32_t usedCount = writePos - _readPos.load(std::memory_order_acquire);
+	if(usedCount + StreamingAudioSource::HistorySize + StreamingAudioSource::MinDecodeSize > StreamingAudioSource::BufferSize) {
+		//Buffer is full
+		return false;
+	}
+
+	uint32_t offset = writePos & StreamingAudioSource::BufferMask;
+	uint32_t frameCount = StreamingAudioSource::BufferSize - StreamingAudioSource::HistorySize - usedCount;
+	frameCount = std::min(frameCount, StreamingAudioSource::MaxDecodeSize);
+	frameCount = std::min(frameCount, StreamingAudioSource::BufferSize - offset);
+
+	uint32_t decoded = _decoder->Decode(_samples.get() + offset * 2, _positions.get() + offset, frameCount, _loop);
+	if(decoded == 0) {
+		_endOfStream.store(true, std::memory_order_release);
+		return false;
+	}
+
+	_writePos.store(writePos + decoded, std::memory_order_release);
+	return true;
+}
+
+bool StreamingAudioSource::IsDecodeDone()
+{
+	return _closed || _failed || _endOfStream;
+}
+
+AudioStreamThread::~AudioStreamThread()
+{
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		_stopFlag = true;
+	}
+	_signal.notify_all();
+
+	if(_thread.joinable()) {
+		_thread.join();
+	}
+}
+
+void AudioStreamThread::Add(shared_ptr<StreamingAudioSource> source)
+{
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		if(!_thread.joinable()) {
+			_thread = std::thread(&AudioStreamThread::Run, this);
+		}
+		_sources.push_back(source);
+		_sourceAdded = true;
+	}
+	_signal.notify_all();
+}
+
+void AudioStreamThread::Run()
+{
+	vector<shared_ptr<StreamingAudioSource>> sources;
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			if(_stopFlag) {
+				return;
+			}
+
+			_sources.erase(std::remove_if(_sources.begin(), _sources.end(), [](const shared_ptr<StreamingAudioSource>& src) { return src->IsDecodeDone(); }), _sources.end());
+			sources = _sources;
+		}
+
+		bool decoded = false;
+		for(shared_ptr<StreamingAudioSource>& source : sources) {
+			decoded |= source->Decode();
+		}
+		sources.clear();
+
+		if(!decoded) {
+			//Wait until a new source is added, or until the consumers have read some of the buffered samples
+			std::unique_lock<std::mutex> lock(_lock);
+			if(_sources.empty()) {
+				_signal.wait(lock, [this] { return _stopFlag || _sourceAdded; });
+			} else {
+				_signal.wait_for(lock, std::chrono::milliseconds(10), [this] { return _stopFlag || _sourceAdded; });
+			}
+			_sourceAdded = false;
+		}
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//Decodes an audio file for a StreamingAudioSource - all calls are made on the decoder thread
+class IAudioStreamDecoder
+{
+public:
+	virtual ~IAudioStreamDecoder() = default;
+
+	//Opens the file - returns false if the file is missing or invalid
+	virtual bool Open() = 0;
+	virtual uint32_t GetSampleRate() = 0;
+
+	//Stream length and loop point, in the same unit as the positions (GetLength returns 0 if the length is unknown)
+	//A loop position at or after the end of the stream disables looping
+	//GetPositionStep is the amount the position increases by for each frame
+	virtual uint32_t GetLength() = 0;
+	virtual uint32_t GetLoopPosition() = 0;
+	virtual uint32_t GetPositionStep() = 0;
+
+	//Decodes up to frameCount stereo frames (wrapping back to the loop point at the end of the file when loop is set)
+	//positions receives, for each frame, the stream position that follows it (this is the value used by save states)
+	//Returns 0 once the end of the stream is reached
+	virtual uint32_t Decode(int16_t* samples, uint32_t* positions, uint32_t frameCount, bool loop) = 0;
+};
+
+//Audio stream that is decoded ahead of time by an AudioStreamThread.
+//The decoded samples are kept in a single producer/single consumer ring buffer, so the emulation thread
+//can read them in MixAudio without blocking and without touching the disk.
+//The stream's position (and the end of the stream) only depends on the calls to Advance, not on how far ahead the
+//decoder thread is, to keep the emulation deterministic. Frames the decoder thread didn't produce in time are skipped.
+class StreamingAudioSource
+{
+private:
+	static constexpr uint32_t BufferSize = 0x8000; //~740ms at 44.1kHz
+	static constexpr uint32_t BufferMask = BufferSize - 1;
+	static constexpr uint32_t HistorySize = 0x2000; //Frames kept after being read, to allow seeking back (e.g when loading a run-ahead state)
+	static constexpr uint32_t MinDecodeSize = 0x400;
+	static constexpr uint32_t MaxDecodeSize = 0x1000;
+	static constexpr uint32_t SkipThreshold = 0x400; //Frames the reader can fall behind the stream's position before frames are skipped
+
+	unique_ptr<IAudioStreamDecoder> _decoder;
+	unique_ptr<int16_t[]> _samples;
+	unique_ptr<uint32_t[]> _positions;
+
+	//Frame counters - _writePos is only modified by the decoder thread, _readPos by the consumer
+	std::atomic<uint32_t> _writePos;
+	std::atomic<uint32_t> _readPos;
+
+	std::atomic<bool> _opened;
+	std::atomic<bool> _failed;
+	std::atomic<bool> _endOfStream;
+	std::atomic<bool> _closed;
+	std::atomic<bool> _loop;
+
+	//Set by the decoder thread before _opened
+	uint32_t _sampleRate = 0;
+	uint32_t _length = 0;
+	uint32_t _loopPosition = 0;
+	uint32_t _positionStep = 1;
+
+	//Only used by the consumer
+	uint32_t _position = 0;
+	uint32_t _expectedReadPos = 0;
+	uint64_t _outputFrames = 0;
+	uint64_t _elapsedFrames = 0;
+	uint32_t _outputRate = 0;
+	bool _ended = false;
+
+	void SetReadPosition(uint32_t readPos, uint32_t position);
+
+public:
+	StreamingAudioSource(IAudioStreamDecoder* decoder, bool loop, uint32_t startPosition);
+
+	//Consumer side
+	void Advance(uint32_t outputFrameCount, uint32_t outputSampleRate);
+	uint32_t Read(int16_t* out, uint32_t frameCount);
+	bool Seek(uint32_t position);
+	void SetLoopFlag(bool loop);
+	void Close();
+
+	bool IsOpened();
+	bool IsPlaybackOver();
+	uint32_t GetSampleRate();
+	uint32_t GetPosition();
+
+	//Decoder thread side
+	bool Decode();
+	bool IsDecodeDone();
+};
+
+//Background thread that decodes the StreamingAudioSource instances that are added to it
+class AudioStreamThread
+{
+private:
+	vector<shared_ptr<StreamingAudioSource>> _sources;
+	std::mutex _lock;
+	std::condition_variable _signal;
+	std::thread _thread;
+	bool _stopFlag = false;
+	bool _sourceAdded = false;
+
+	void Run();
+
+public:
+	~AudioStreamThread();
+
+	void Add(shared_ptr<StreamingAudioSource> source);
+};
@@ -58,6 +58,23 @@ void BaseControlManager::UnregisterInputRecorder(IInputRecorder* provider)
 	vec.erase(std::remove(vec.begin(), vec.end(), provider), vec.end());
 }
 
+void BaseControlManager::DiscardRecordedInputs(uint32_t fromFrame)
+{
+	auto lock = _deviceLock.AcquireSafe();
+
+	uint32_t pollCount = 0;
+	while(!_recordedPolls.empty() && _recordedPolls.back() >= fromFrame) {
+		_recordedPolls.pop_back();
+		pollCount++;
+	}
+
+	if(pollCount > 0) {
+		for(IInputRecorder* recorder : _inputRecorders) {
+			recorder->DiscardInputs(pollCount);
+		}
+	}
+}
+
 vector<ControllerData> BaseControlManager::GetPortStates()
 {
 	vector<ControllerData> states;
@@ -179,7 +196,15 @@ void BaseControlManager::UpdateInputState()
 
 	_emu->ProcessEvent(EventType::InputPolled, _cpuType);
 
-	if(!_emu->IsRunAheadFrame()) {
+	if(!_emu->IsRunAheadFrame() || _emu->IsRollbackFrame()) {
+		//Frames that are run again after a netplay rollback replace the inputs recorded with the wrong prediction
+		if(!_inputRecorders.empty()) {
+			_recordedPolls.push_back(_emu->GetFrameCount());
+			if(_recordedPolls.size() > BaseControlManager::MaxRecordedPolls) {
+				_recordedPolls.pop_front();
+			}
+		}
+
 		for(IInputRecorder* recorder : _inputRecorders) {
 			recorder->RecordInput(_controlDevices);
 		}
@@ -18,6 +18,10 @@ private:
 	vector<IInputRecorder*> _inputRecorders;
 	vector<IInputProvider*> _inputProviders;
 
+	//Frame number of the most recent polls that were sent to the input recorders
+	static constexpr uint32_t MaxRecordedPolls = 0x1000;
+	deque<uint32_t> _recordedPolls;
+
 protected:
 	Emulator* _emu = nullptr;
 	CpuType _cpuType = {};
@@ -62,6 +66,7 @@ public:
 
 	void RegisterInputRecorder(IInputRecorder* recorder);
 	void UnregisterInputRecorder(IInputRecorder* recorder);
+	void DiscardRecordedInputs(uint32_t fromFrame);
 
 	virtual shared_ptr<BaseControlDevice> CreateControllerDevice(ControllerType type, uint8_t port) = 0;
 
@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "Shared/CdImageReader.h"
+
+CdImageReader::CdImageReader(vector<VirtualFile>& files)
+{
+	_filePaths.resize(files.size());
+	_streams.resize(files.size());
+	_fileData.resize(files.size());
+
+	for(size_t i = 0; i < files.size(); i++) {
+		VirtualFile& file = files[i];
+		if(!file.IsArchive() && ifstream(file.GetFilePath(), ios::in | ios::binary)) {
+			_filePaths[i] = file.GetFilePath();
+		} else {
+			//Archive or buffer - GetFilePath() doesn't point to the file's content, keep the decompressed data instead
+			file.ReadFile(_fileData[i]);
+			if(file.IsArchive()) {
+				//Release the VirtualFile's copy of the data
+				file = VirtualFile(file.GetFilePath(), file.GetFileName());
+			}
+		}
+	}
+}
+
+CdImageReader::~CdImageReader()
+{
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		_stopFlag = true;
+	}
+	_signal.notify_all();
+
+	if(_thread.joinable()) {
+		_thread.join();
+	}
+}
+
+CdImageReader::Block* CdImageReader::FindBlock(uint32_t fileIndex, uint64_t offset)
+{
+	for(unique_ptr<Block>& block : _blocks) {
+		if(block->Offset == offset && block->FileIndex == fileIndex) {
+			return block.get();
+		}
+	}
+	return nullptr;
+}
+
+CdImageReader::Block* CdImageReader::AllocateBlock(uint32_t fileIndex, uint64_t offset)
+{
+	Block* block = nullptr;
+	if(_blocks.size() < CdImageReader::MaxBlockCount) {
+		_blocks.push_back(unique_ptr<Block>(new Block()));
+		block = _blocks.back().get();
+	} else {
+		//Reuse the least recently used block (blocks that are still being loaded can't be reused)
+		for(unique_ptr<Block>& candidate : _blocks) {
+			if(candidate->Ready && (!block || candidate->LastUse < block->LastUse)) {
+				block = candidate.get();
+			}
+		}
+
+		if(!block) {
+			_blocks.push_back(unique_ptr<Block>(new Block()));
+			block = _blocks.back().get();
+		}
+	}
+
+	block->FileIndex = fileIndex;
+	block->Offset = offset;
+	block->Data = {};
+	block->LastUse = ++_useCounter;
+	block->Ready = false;
+	return block;
+}
+
+void CdImageReader::LoadBlock(Block* block, std::unique_lock<std::mutex>& lock)
+{
+	uint32_t fileIndex = block->FileIndex;
+	uint64_t offset = block->Offset;
+
+	//Other threads can use the blocks that are already loaded while the file is being read
+	lock.unlock();
+
+	vector<uint8_t> data;
+	{
+		std::lock_guard<std::mutex> ioLock(_ioLock);
+		unique_ptr<ifstream>& stream = _streams[fileIndex];
+		if(!stream) {
+			stream.reset(new ifstream(_filePaths[fileIndex], ios::in | ios::binary));
+		}
+
+		if(stream->is_open()) {
+			data.resize(CdImageReader::BlockSize);
+			stream->clear();
+			stream->seekg(offset, ios::beg);
+			stream->read((char*)data.data(), CdImageReader::BlockSize);
+			data.resize((size_t)stream->gcount());
+		}
+	}
+
+	lock.lock();
+	block->Data = std::move(data);
+	block->Ready = true;
+	_signal.notify_all();
+}
+
+bool CdImageReader::IsQueued(uint32_t fileIndex, uint64_t offset)
+{
+	for(std::pair<uint32_t, uint64_t>& request : _queue) {
+		if(request.first == fileIndex && request.second == offset) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CdImageReader::Read(uint32_t fileIndex, uint64_t offset, uint8_t* dst, uint32_t length)
+{
+	if(fileIndex >= _filePaths.size()) {
+		memset(dst, 0, length);
+		return false;
+	}
+
+	if(_filePaths[fileIndex].empty()) {
+		vector<uint8_t>& data = _fileData[fileIndex];
+		if(offset >= data.size()) {
+			memset(dst, 0, length);
+			return false;
+		}
+
+		uint32_t size = (uint32_t)std::min<uint64_t>(length, data.size() - offset);
+		memcpy(dst, data.data() + offset, size);
+		if(size < length) {
+			//Out of bounds
+			memset(dst + size, 0, length - size);
+			return false;
+		}
+		return true;
+	}
+
+	std::unique_lock<std::mutex> lock(_lock);
+	while(length > 0) {
+		uint64_t blockOffset = offset - (offset % CdImageReader::BlockSize);
+		Block* block = FindBlock(fileIndex, blockOffset);
+		if(!block) {
+			LoadBlock(AllocateBlock(fileIndex, blockOffset), lock);
+			continue;
+		} else if(!block->Ready) {
+			//The block is being loaded by the background thread
+			_signal.wait(lock);
+			continue;
+		}
+
+		block->LastUse = ++_useCounter;
+
+		uint32_t blockPos = (uint32_t)(offset - blockOffset);
+		if(blockPos >= block->Data.size()) {
+			//Out of bounds
+			memset(dst, 0, length);
+			return false;
+		}
+
+		uint32_t size = std::min<uint32_t>(length, (uint32_t)block->Data.size() - blockPos);
+		memcpy(dst, block->Data.data() + blockPos, size);
+		dst += size;
+		offset += size;
+		length -= size;
+	}
+	return true;
+}
+
+void CdImageReader::Prefetch(uint32_t fileIndex, uint64_t offset, uint32_t length)
+{
+	if(fileIndex >= _filePaths.size() || _filePaths[fileIndex].empty() || length == 0) {
+		//Files that are kept in memory don't need to be prefetched
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		if(!_thread.joinable()) {
+			_thread = std::thread(&CdImageReader::PrefetchThread, this);
+		}
+
+		uint64_t end = offset + length;
+		for(uint64_t blockOffset = offset - (offset % CdImageReader::BlockSize); blockOffset < end; blockOffset += CdImageReader::BlockSize) {
+			if(!FindBlock(fileIndex, blockOffset) && !IsQueued(fileIndex, blockOffset)) {
+				_queue.push_back({ fileIndex, blockOffset });
+			}
+		}
+
+		while(_queue.size() > CdImageReader::MaxQueuedBlocks) {
+			//Drop the oldest requests (e.g after a seek, they are probably no longer needed)
+			_queue.pop_front();
+		}
+	}
+	_signal.notify_all();
+}
+
+void CdImageReader::PrefetchThread()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	while(true) {
+		_signal.wait(lock, [this] { return _stopFlag || !_queue.empty(); });
+		if(_stopFlag) {
+			return;
+		}
+
+		std::pair<uint32_t, uint64_t> request = _queue.front();
+		_queue.pop_front();
+
+		if(!FindBlock(request.first, request.second)) {
+			LoadBlock(AllocateBlock(request.first, request.second), lock);
+		}
+	}
+}
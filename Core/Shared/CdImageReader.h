@@ -0,0 +1,59 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "Utilities/VirtualFile.h"
+
+//Reads the files of a disc image in large blocks, with a bounded number of blocks kept in memory.
+//Blocks can be read ahead of time on a background thread (e.g when the CD-ROM drive receives a read command),
+//to avoid stalling the emulation thread when the image is on slow storage.
+//Files that can't be read from the disk directly (e.g files inside an archive) are kept in memory instead.
+class CdImageReader
+{
+private:
+	static constexpr uint32_t BlockSize = 0x40000; //256 KB
+	static constexpr uint32_t MaxBlockCount = 64; //16 MB
+	static constexpr uint32_t MaxQueuedBlocks = 16;
+
+	struct Block
+	{
+		uint32_t FileIndex = 0;
+		uint64_t Offset = 0;
+		vector<uint8_t> Data;
+		uint64_t LastUse = 0;
+		bool Ready = false;
+	};
+
+	vector<string> _filePaths;
+	vector<unique_ptr<ifstream>> _streams;
+	vector<vector<uint8_t>> _fileData;
+	std::mutex _ioLock;
+
+	vector<unique_ptr<Block>> _blocks;
+	uint64_t _useCounter = 0;
+	std::deque<std::pair<uint32_t, uint64_t>> _queue;
+	std::mutex _lock;
+	std::condition_variable _signal;
+
+	std::thread _thread;
+	bool _stopFlag = false;
+
+	Block* FindBlock(uint32_t fileIndex, uint64_t offset);
+	Block* AllocateBlock(uint32_t fileIndex, uint64_t offset);
+	void LoadBlock(Block* block, std::unique_lock<std::mutex>& lock);
+	bool IsQueued(uint32_t fileIndex, uint64_t offset);
+
+	void PrefetchThread();
+
+public:
+	CdImageReader(vector<VirtualFile>& files);
+	~CdImageReader();
+
+	//Copies data from the file - returns false if the range is outside the file
+	bool Read(uint32_t fileIndex, uint64_t offset, uint8_t* dst, uint32_t length);
+
+	//Queues the blocks that contain this range to be loaded in the background
+	void Prefetch(uint32_t fileIndex, uint64_t offset, uint32_t length);
+};
@@ -241,5 +241,7 @@ bool CdReader::LoadCue(VirtualFile& cueFile, DiscInfo& disc)
 	}
 	MessageManager::Log("---- END TRACKS ----");
 
+	disc.Reader.reset(new CdImageReader(disc.Files));
+
 	return true;
 }
@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "Utilities/VirtualFile.h"
 #include "Shared/MessageManager.h"
+#include "Shared/CdImageReader.h"
 
 enum class TrackFormat
 {
@@ -77,8 +78,10 @@ struct TrackInfo
 struct DiscInfo
 {
 	static constexpr int SectorSize = 2352;
+	static constexpr uint32_t AudioReadAheadSize = 0x40000;
 
 	vector<VirtualFile> Files;
+	shared_ptr<CdImageReader> Reader;
 	vector<TrackInfo> Tracks;
 	uint32_t DiscSize;
 	uint32_t DiscSectorCount;
@@ -123,24 +126,39 @@ struct DiscInfo
 			TrackInfo& trk = Tracks[track];
 			uint32_t sectorSize = trk.GetSectorSize();
 			uint32_t sectorHeaderSize = trk.Format == TrackFormat::Mode1_2352 ? Mode1_2352_SectorHeaderSize : 0;
-			uint32_t byteOffset = trk.FileOffset + (sector - trk.FirstSector) * sectorSize;
-			if(!Files[trk.FileIndex].ReadChunk(outData, byteOffset + sectorHeaderSize, 2048)) {
+			uint64_t byteOffset = trk.FileOffset + (uint64_t)(sector - trk.FirstSector) * sectorSize;
+
+			uint8_t sectorData[2048];
+			if(Reader->Read(trk.FileIndex, byteOffset + sectorHeaderSize, sectorData, 2048)) {
+				outData.insert(outData.end(), sectorData, sectorData + 2048);
+			} else {
 				LogDebug("Invalid read offsets");
 			}
 		}
 	}
 
-	int16_t ReadAudioSample(uint32_t sector, uint32_t sample, uint32_t byteOffset)
+	//Starts loading these sectors in the background (called when a read command is received)
+	void PrefetchSectors(uint32_t sector, uint32_t sectorCount)
 	{
 		int32_t track = GetTrack(sector);
-		if(track < 0) {
-			LogDebug("Invalid sector/track");
-			return 0;
+		if(track < 0 || sectorCount == 0) {
+			return;
 		}
 
-		uint32_t fileIndex = Tracks[track].FileIndex;
-		uint32_t startByte = Tracks[track].FileOffset + (sector - Tracks[track].FirstSector) * DiscInfo::SectorSize;
-		return (int16_t)(Files[fileIndex].ReadByte(startByte + sample * 4 + byteOffset) | (Files[fileIndex].ReadByte(startByte + sample * 4 + 1 + byteOffset) << 8));
+		TrackInfo& trk = Tracks[track];
+		uint32_t lastSector = std::min(trk.LastSector, sector + sectorCount - 1);
+		uint32_t sectorSize = trk.GetSectorSize();
+		Reader->Prefetch(trk.FileIndex, trk.FileOffset + (uint64_t)(sector - trk.FirstSector) * sectorSize, (lastSector - sector + 1) * sectorSize);
+	}
+
+	int16_t ReadAudioSample(uint32_t sector, uint32_t sample, uint32_t byteOffset)
+	{
+		if(_audioSector != (int64_t)sector) {
+			LoadAudioSector(sector);
+		}
+
+		uint32_t pos = sample * 4 + byteOffset;
+		return (int16_t)(_audioData[pos] | (_audioData[pos + 1] << 8));
 	}
 
 	int16_t ReadLeftSample(uint32_t sector, uint32_t sample)
@@ -152,6 +170,30 @@ struct DiscInfo
 	{
 		return ReadAudioSample(sector, sample, 2);
 	}
+
+private:
+	//The sector that is currently being played by the audio player
+	int64_t _audioSector = -1;
+	uint8_t _audioData[DiscInfo::SectorSize] = {};
+
+	void LoadAudioSector(uint32_t sector)
+	{
+		_audioSector = sector;
+
+		int32_t track = GetTrack(sector);
+		if(track < 0) {
+			LogDebug("Invalid sector/track");
+			memset(_audioData, 0, sizeof(_audioData));
+			return;
+		}
+
+		uint32_t fileIndex = Tracks[track].FileIndex;
+		uint64_t startByte = Tracks[track].FileOffset + (uint64_t)(sector - Tracks[track].FirstSector) * DiscInfo::SectorSize;
+		Reader->Read(fileIndex, startByte, _audioData, DiscInfo::SectorSize);
+
+		//Load the next part of the track in the background while this sector is playing
+		Reader->Prefetch(fileIndex, startByte + DiscInfo::SectorSize, DiscInfo::AudioReadAheadSize);
+	}
 };
 
 class CdReader
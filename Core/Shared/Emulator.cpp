@@ -26,6 +26,7 @@
 #include "Shared/HistoryViewer.h"
 #include "Netplay/GameServer.h"
 #include "Netplay/GameClient.h"
+#include "Netplay/RollbackManager.h"
 #include "Shared/Interfaces/IConsole.h"
 #include "Shared/Interfaces/IBarcodeReader.h"
 #include "Shared/Interfaces/ITapeRecorder.h"
@@ -47,6 +48,7 @@
 #include "Utilities/FolderUtilities.h"
 #include "Shared/MemoryOperationType.h"
 #include "Shared/EventType.h"
+#include "Shared/PerformanceCounters.h"
 
 Emulator::Emulator() :
 	_settings(new EmuSettings(this)),
@@ -63,12 +65,15 @@ Emulator::Emulator() :
 	_historyViewer(new HistoryViewer(this)),
 	_gameServer(new GameServer(this)),
 	_gameClient(new GameClient(this)),
-	_rewindManager(new RewindManager(this))
+	_rewindManager(new RewindManager(this)),
+	_rollbackManager(new RollbackManager(this)),
+	_perfCounters(new PerformanceCounters())
 {
 	_paused = false;
 	_pauseOnNextFrame = false;
 	_stopFlag = false;
 	_isRunAheadFrame = false;
+	_isRollbackFrame = false;
 	_lockCounter = 0;
 	_threadPaused = false;
 
@@ -120,6 +125,7 @@ void Emulator::Run()
 
 	_stopFlag = false;
 	_isRunAheadFrame = false;
+	_isRollbackFrame = false;
 
 	PlatformUtilities::EnableHighResolutionTimer();
 
@@ -131,17 +137,23 @@ void Emulator::Run()
 	_lastFrameTimer.Reset();
 
 	while(!_stopFlag) {
-		bool useRunAhead = _settings->GetEmulationConfig().RunAheadFrames > 0 && !_debugger && !_audioPlayerHud && !_rewindManager->IsRewinding() && _settings->GetEmulationSpeed() > 0 && _settings->GetEmulationSpeed() <= 100;
-		if(useRunAhead) {
-			RunFrameWithRunAhead();
-		} else {
-			_console->RunFrame();
-			_rewindManager->ProcessEndOfFrame();
-			_historyViewer->ProcessEndOfFrame();
-			ProcessSystemActions();
-		}
+		{
+			PERF_TIMER(_perfCounters.get(), Frame);
+			bool useRunAhead = _settings->GetEmulationConfig().RunAheadFrames > 0 && !_debugger && !_audioPlayerHud && !_rewindManager->IsRewinding() && _settings->GetEmulationSpeed() > 0 && _settings->GetEmulationSpeed() <= 100;
+			if(_rollbackManager->IsEnabled()) {
+				RunFrameWithRollback();
+			} else if(useRunAhead) {
+				RunFrameWithRunAhead();
+			} else {
+				RunConsoleFrame();
+				_rewindManager->ProcessEndOfFrame();
+				_historyViewer->ProcessEndOfFrame();
+				ProcessSystemActions();
+			}
 
-		ProcessAutoSaveState();
+			ProcessAutoSaveState();
+		}
+		_perfCounters->EndFrame();
 
 		WaitForLock();
 
@@ -198,25 +210,31 @@ bool Emulator::ProcessSystemActions()
 	return false;
 }
 
+void Emulator::RunConsoleFrame()
+{
+	PERF_TIMER(_perfCounters.get(), RunFrame);
+	_console->RunFrame();
+}
+
 void Emulator::RunFrameWithRunAhead()
 {
-	stringstream runAheadState;
+	PERF_TIMER(_perfCounters.get(), RunAhead);
 	uint32_t frameCount = _settings->GetEmulationConfig().RunAheadFrames;
 
 	//Run a single frame and save the state (no audio/video)
 	_isRunAheadFrame = true;
-	_console->RunFrame();
-	Serialize(runAheadState, false, 0);
+	RunConsoleFrame();
+	SerializeToBuffer(_runAheadState, false);
 
 	while(frameCount > 1) {
 		//Run extra frames if the requested run ahead frame count is higher than 1
 		frameCount--;
-		_console->RunFrame();
+		RunConsoleFrame();
 	}
 	_isRunAheadFrame = false;
 
 	//Run one frame normally (with audio/video output)
-	_console->RunFrame();
+	RunConsoleFrame();
 	_rewindManager->ProcessEndOfFrame();
 	_historyViewer->ProcessEndOfFrame();
 
@@ -224,9 +242,50 @@ void Emulator::RunFrameWithRunAhead()
 	if(!wasReset) {
 		//Load the state we saved earlier
 		_isRunAheadFrame = true;
-		Deserialize(runAheadState, SaveStateManager::FileFormatVersion, false);
+		DeserializeFromBuffer(_runAheadState, false, false);
+		_isRunAheadFrame = false;
+	}
+}
+
+void Emulator::RunFrameWithRollback()
+{
+	//Don't run too far ahead of the other players - wrong predictions can only be corrected for a limited number of frames
+	//Stop, Pause and Lock wake up the rollback manager to interrupt the wait
+	while(_rollbackManager->NeedsToWait(GetFrameCount()) && !_stopFlag && !_paused && _lockCounter == 0) {
+		_rollbackManager->WaitForInput();
+	}
+
+	uint32_t currentFrame = GetFrameCount();
+	uint32_t rollbackFrame = 0;
+	if(_rollbackManager->GetRollbackFrame(currentFrame, rollbackFrame)) {
+		//The input received for a previous frame doesn't match the prediction that was used,
+		//load the state saved at the start of that frame and run the frames again (no audio/video)
+		_isRunAheadFrame = true;
+		if(DeserializeFromBuffer(_rollbackManager->GetSnapshot(rollbackFrame), false, false)) {
+			//The inputs recorded (movie, rewind) for these frames used the wrong prediction, record the corrected inputs instead
+			_console->GetControlManager()->DiscardRecordedInputs(rollbackFrame);
+			_isRollbackFrame = true;
+			for(uint32_t i = 0; i < RollbackManager::SnapshotCount && GetFrameCount() < currentFrame; i++) {
+				uint32_t frame = GetFrameCount();
+				_rollbackManager->BeginFrame(frame, true);
+				if(frame != rollbackFrame) {
+					SerializeToBuffer(_rollbackManager->GetSnapshot(frame), false);
+				}
+				RunConsoleFrame();
+			}
+			_isRollbackFrame = false;
+		}
 		_isRunAheadFrame = false;
 	}
+
+	_rollbackManager->BeginFrame(currentFrame, false);
+	SerializeToBuffer(_rollbackManager->GetSnapshot(currentFrame), false);
+	RunConsoleFrame();
+	_rollbackManager->EndFrame(currentFrame);
+
+	_rewindManager->ProcessEndOfFrame();
+	_historyViewer->ProcessEndOfFrame();
+	ProcessSystemActions();
 }
 
 void Emulator::OnBeforeSendFrame()
@@ -236,7 +295,9 @@ void Emulator::OnBeforeSendFrame()
 			_audioPlayerHud->Draw();
 		}
 
-		if(_stats && _settings->GetPreferences().ShowDebugInfo) {
+		bool showDebugInfo = _settings->GetPreferences().ShowDebugInfo;
+		_perfCounters->SetDisplayEnabled(showDebugInfo);
+		if(_stats && showDebugInfo) {
 			double lastFrameTime = _lastFrameTimer.GetElapsedMS();
 			_lastFrameTimer.Reset();
 			_stats->DisplayStats(this, lastFrameTime);
@@ -247,11 +308,14 @@ void Emulator::OnBeforeSendFrame()
 void Emulator::ProcessEndOfFrame()
 {
 	if(!_isRunAheadFrame) {
-		_frameLimiter->ProcessFrame();
-		while(_frameLimiter->WaitForNextFrame()) {
-			if(_stopFlag || _frameDelay != GetFrameDelay() || _paused || _pauseOnNextFrame || _lockCounter > 0) {
-				//Need to process another event, stop sleeping
-				break;
+		{
+			PERF_TIMER(_perfCounters.get(), FrameWait);
+			_frameLimiter->ProcessFrame();
+			while(_frameLimiter->WaitForNextFrame()) {
+				if(_stopFlag || _frameDelay != GetFrameDelay() || _paused || _pauseOnNextFrame || _lockCounter > 0) {
+					//Need to process another event, stop sleeping
+					break;
+				}
 			}
 		}
 
@@ -271,6 +335,7 @@ void Emulator::Stop(bool sendNotification, bool preventRecentGameSave, bool save
 	BlockDebuggerRequests();
 
 	_stopFlag = true;
+	_rollbackManager->WakeUp();
 
 	_notificationManager->SendNotification(ConsoleNotificationType::BeforeGameUnload);
 
@@ -293,6 +358,7 @@ void Emulator::Stop(bool sendNotification, bool preventRecentGameSave, bool save
 	_movieManager->Stop();
 	_videoDecoder->StopThread();
 	_rewindManager->Reset();
+	vector<uint8_t>().swap(_runAheadState);
 
 	if(_console) {
 		if(saveBattery) {
@@ -533,6 +599,7 @@ void Emulator::InitConsole(unique_ptr<IConsole>& newConsole, ConsoleMemoryInfo o
 
 	_console.reset(newConsole);
 	_consoleType = _console->GetConsoleType();
+	_rawStateSchemas.clear();
 	_notificationManager->RegisterNotificationListener(_console.lock());
 }
 
@@ -759,6 +826,7 @@ void Emulator::Pause()
 		debugger->Step(GetCpuTypes()[0], 1, StepType::Step, BreakSource::Pause);
 	} else {
 		_paused = true;
+		_rollbackManager->WakeUp();
 	}
 }
 
@@ -829,6 +897,7 @@ void Emulator::Lock()
 {
 	SuspendDebugger(false);
 	_lockCounter++;
+	_rollbackManager->WakeUp();
 	_runLock.Acquire();
 }
 
@@ -878,7 +947,13 @@ void Emulator::WaitForLock()
 
 void Emulator::Serialize(ostream& out, bool includeSettings, int compressionLevel)
 {
-	Serializer s(SaveStateManager::FileFormatVersion, true);
+	Serialize(out, includeSettings, compressionLevel, SerializeFormat::Binary);
+}
+
+void Emulator::Serialize(ostream& out, bool includeSettings, int compressionLevel, SerializeFormat format)
+{
+	PERF_TIMER(_perfCounters.get(), Serialize);
+	Serializer s(SaveStateManager::FileFormatVersion, true, format);
 	if(includeSettings) {
 		SV(_settings);
 	}
@@ -888,7 +963,13 @@ void Emulator::Serialize(ostream& out, bool includeSettings, int compressionLeve
 
 bool Emulator::Deserialize(istream& in, uint32_t fileFormatVersion, bool includeSettings, optional<ConsoleType> srcConsoleType)
 {
-	Serializer s(fileFormatVersion, false);
+	return Deserialize(in, fileFormatVersion, includeSettings, srcConsoleType, SerializeFormat::Binary);
+}
+
+bool Emulator::Deserialize(istream& in, uint32_t fileFormatVersion, bool includeSettings, optional<ConsoleType> srcConsoleType, SerializeFormat format)
+{
+	PERF_TIMER(_perfCounters.get(), Deserialize);
+	Serializer s(fileFormatVersion, false, format);
 	if(!s.LoadFrom(in)) {
 		return false;
 	}
@@ -920,11 +1001,66 @@ bool Emulator::Deserialize(istream& in, uint32_t fileFormatVersion, bool include
 	}
 
 	s.Stream(_console, "");
+
+	if(format == SerializeFormat::Raw && !s.ValidateRawSchema()) {
+		//Raw states have no keys, a layout mismatch means the state was not created by this console
+		LogDebug("[Emulator] Raw save state does not match the console's state layout");
+		return false;
+	}
 	
 	_notificationManager->SendNotification(ConsoleNotificationType::StateLoaded);
 	return true;
 }
 
+void Emulator::SerializeToBuffer(vector<uint8_t>& buffer, bool includeSettings)
+{
+	PERF_TIMER(_perfCounters.get(), Serialize);
+	Serializer s(SaveStateManager::FileFormatVersion, true, SerializeFormat::Raw, buffer);
+	if(includeSettings) {
+		SV(_settings);
+	}
+	s.Stream(_console, "");
+	_rawStateSchemas.emplace(s.GetRawSchema());
+}
+
+bool Emulator::IsKnownRawSchema(vector<uint8_t>& buffer)
+{
+	//Every raw buffer is created by SerializeToBuffer, which records its layout - the list is cleared when a console is loaded
+	Serializer s(SaveStateManager::FileFormatVersion, false, SerializeFormat::Raw, buffer);
+	uint64_t schema = s.GetRawHeaderSchema();
+	return schema != 0 && _rawStateSchemas.find(schema) != _rawStateSchemas.end();
+}
+
+bool Emulator::DeserializeFromBuffer(vector<uint8_t>& buffer, bool includeSettings, bool sendNotification)
+{
+	PERF_TIMER(_perfCounters.get(), Deserialize);
+	if(!IsKnownRawSchema(buffer)) {
+		//Reject the state before any of the console's fields are overwritten
+		LogDebug("[Emulator] Raw save state does not match the console's state layout");
+		return false;
+	}
+
+	Serializer s(SaveStateManager::FileFormatVersion, false, SerializeFormat::Raw, buffer);
+	if(!s.IsValid()) {
+		return false;
+	}
+
+	if(includeSettings) {
+		SV(_settings);
+	}
+	s.Stream(_console, "");
+
+	if(!s.ValidateRawSchema()) {
+		LogDebug("[Emulator] Raw save state does not match the console's state layout");
+		return false;
+	}
+
+	if(sendNotification) {
+		_notificationManager->SendNotification(ConsoleNotificationType::StateLoaded);
+	}
+	return true;
+}
+
 BaseVideoFilter* Emulator::GetVideoFilter()
 {
 	shared_ptr<IConsole> console = GetConsole();
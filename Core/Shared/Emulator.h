@@ -34,6 +34,8 @@ class SystemActionManager;
 class AudioPlayerHud;
 class GameServer;
 class GameClient;
+class RollbackManager;
+class PerformanceCounters;
 
 class IInputRecorder;
 class IInputProvider;
@@ -48,6 +50,7 @@ enum class ConsoleRegion;
 enum class ConsoleType;
 enum class HashType;
 enum class TapeRecorderAction;
+enum class SerializeFormat;
 
 struct ConsoleMemoryInfo
 {
@@ -85,6 +88,8 @@ private:
 	const shared_ptr<GameServer> _gameServer;
 	const shared_ptr<GameClient> _gameClient;
 	const shared_ptr<RewindManager> _rewindManager;
+	const unique_ptr<RollbackManager> _rollbackManager;
+	const unique_ptr<PerformanceCounters> _perfCounters;
 
 	thread::id _emulationThreadId;
 
@@ -102,6 +107,9 @@ private:
 	atomic<int> _blockDebuggerRequestCount;
 
 	atomic<bool> _isRunAheadFrame;
+	atomic<bool> _isRollbackFrame;
+	vector<uint8_t> _runAheadState;
+	unordered_set<uint64_t> _rawStateSchemas;
 	bool _frameRunning = false;
 
 	RomInfo _rom;
@@ -122,7 +130,11 @@ private:
 
 	void ProcessAutoSaveState();
 	bool ProcessSystemActions();
+	void RunConsoleFrame();
 	void RunFrameWithRunAhead();
+	void RunFrameWithRollback();
+
+	bool IsKnownRawSchema(vector<uint8_t>& buffer);
 
 	void BlockDebuggerRequests();
 	void ResetDebugger(bool startDebugger = false);
@@ -180,7 +192,15 @@ public:
 	void SuspendDebugger(bool release);
 
 	void Serialize(ostream& out, bool includeSettings, int compressionLevel = 1);
+	void Serialize(ostream& out, bool includeSettings, int compressionLevel, SerializeFormat format);
 	bool Deserialize(istream& in, uint32_t fileFormatVersion, bool includeSettings, optional<ConsoleType> consoleType = std::nullopt);
+	bool Deserialize(istream& in, uint32_t fileFormatVersion, bool includeSettings, optional<ConsoleType> consoleType, SerializeFormat format);
+
+	//In-memory snapshots (raw format) - the buffer is reused as-is, to avoid allocations
+	//Run-ahead and rollback netplay reload a state on every frame and pass sendNotification = false,
+	//so that these loads aren't treated as user-requested state loads (StateLoaded notification)
+	void SerializeToBuffer(vector<uint8_t>& buffer, bool includeSettings);
+	bool DeserializeFromBuffer(vector<uint8_t>& buffer, bool includeSettings, bool sendNotification = true);
 
 	SoundMixer* GetSoundMixer() { return _soundMixer.get(); }
 	VideoRenderer* GetVideoRenderer() { return _videoRenderer.get(); }
@@ -198,6 +218,8 @@ public:
 	HistoryViewer* GetHistoryViewer() { return _historyViewer.get(); }
 	GameServer* GetGameServer() { return _gameServer.get(); }
 	GameClient* GetGameClient() { return _gameClient.get(); }
+	RollbackManager* GetRollbackManager() { return _rollbackManager.get(); }
+	PerformanceCounters* GetPerformanceCounters() { return _perfCounters.get(); }
 	shared_ptr<SystemActionManager> GetSystemActionManager() { return _systemActionManager; }
 
 	BaseVideoFilter* GetVideoFilter();
@@ -229,6 +251,7 @@ public:
 
 	bool IsRunning() { return _console != nullptr; }
 	bool IsRunAheadFrame() { return _isRunAheadFrame; }
+	bool IsRollbackFrame() { return _isRollbackFrame; }
 
 	TimingInfo GetTimingInfo(CpuType cpuType);
 	uint32_t GetFrameCount();
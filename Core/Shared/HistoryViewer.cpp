@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Shared/HistoryViewer.h"
 #include "Shared/RewindData.h"
+#include "Shared/RewindKeyFrameCache.h"
 #include "Shared/Emulator.h"
 #include "Shared/EmuSettings.h"
 #include "Shared/Video/VideoRenderer.h"
@@ -45,6 +46,12 @@ bool HistoryViewer::Initialize(Emulator* mainEmu)
 	_emu->GetBatteryManager()->Initialize("");
 	
 	_history = mainEmu->GetRewindManager()->GetHistory();
+
+	//Use a separate key frame cache, to avoid evicting the main instance's key frames (and vice versa)
+	_keyFrameCache.reset(new RewindKeyFrameCache());
+	for(RewindData& rewindData : _history) {
+		rewindData.SetKeyFrameCache(_keyFrameCache);
+	}
 	
 	_emu->UnregisterInputProvider(this);
 	_emu->RegisterInputProvider(this);
@@ -120,7 +127,9 @@ bool HistoryViewer::CreateSaveState(string outputFile, uint32_t position)
 
 	std::stringstream stateData;
 	_emu->GetSaveStateManager()->GetSaveStateHeader(stateData);
-	_history[position].GetStateData(stateData, _history, position);
+	if(!_history[position].GetStateData(stateData, _history, position)) {
+		return false;
+	}
 
 	ofstream output(outputFile, ios::binary);
 	if(output) {
@@ -33,6 +33,7 @@ private:
 	Emulator* _emu = nullptr;
 	Emulator* _mainEmu = nullptr;
 	deque<RewindData> _history;
+	shared_ptr<RewindKeyFrameCache> _keyFrameCache;
 	uint32_t _position = 0;
 	uint32_t _pollCounter = 0;
 
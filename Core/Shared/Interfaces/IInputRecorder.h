@@ -7,4 +7,7 @@ class IInputRecorder
 {
 public:
 	virtual void RecordInput(vector<shared_ptr<BaseControlDevice>> devices) = 0;
+
+	//Removes the last pollCount inputs that were recorded (used when netplay rollback runs these frames again)
+	virtual void DiscardInputs(uint32_t pollCount) = 0;
 };
\ No newline at end of file
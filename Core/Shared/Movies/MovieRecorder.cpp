@@ -37,6 +37,7 @@ bool MovieRecorder::Record(RecordMovieOptions options)
 	_description = options.Description;
 	_writer.reset(new ZipWriter());
 	_inputData = stringstream();
+	_pendingInputs.clear();
 	_saveStateData = stringstream();
 	_hasSaveState = false;
 
@@ -126,6 +127,7 @@ bool MovieRecorder::Stop()
 	if(_writer) {
 		_emu->UnregisterInputRecorder(this);
 
+		FlushPendingInputs();
 		_writer->AddFile(_inputData, "Input.txt");
 
 		stringstream out;
@@ -165,10 +167,33 @@ bool MovieRecorder::Stop()
 
 void MovieRecorder::RecordInput(vector<shared_ptr<BaseControlDevice>> devices)
 {
+	string line;
 	for(shared_ptr<BaseControlDevice> &device : devices) {
-		_inputData << ("|" + device->GetTextState());
+		line += "|" + device->GetTextState();
+	}
+	line += "\n";
+
+	_pendingInputs.push_back(std::move(line));
+	if(_pendingInputs.size() > MovieRecorder::MaxPendingInputs) {
+		_inputData << _pendingInputs.front();
+		_pendingInputs.pop_front();
+	}
+}
+
+void MovieRecorder::DiscardInputs(uint32_t pollCount)
+{
+	while(pollCount > 0 && !_pendingInputs.empty()) {
+		_pendingInputs.pop_back();
+		pollCount--;
 	}
-	_inputData << "\n";
+}
+
+void MovieRecorder::FlushPendingInputs()
+{
+	for(string& line : _pendingInputs) {
+		_inputData << line;
+	}
+	_pendingInputs.clear();
 }
 
 void MovieRecorder::OnLoadBattery(string extension, vector<uint8_t> batteryData)
@@ -205,10 +230,14 @@ bool MovieRecorder::CreateMovie(string movieFile, deque<RewindData> &data, uint3
 			_hasSaveState = true;
 			_saveStateData = stringstream();
 			_emu->GetSaveStateManager()->GetSaveStateHeader(_saveStateData);
-			data[startPosition].GetStateData(_saveStateData, data, startPosition);
+			if(!data[startPosition].GetStateData(_saveStateData, data, startPosition)) {
+				_writer.reset();
+				return false;
+			}
 		}
 
 		_inputData = stringstream();
+		_pendingInputs.clear();
 
 		for(uint32_t i = startPosition; i < endPosition; i++) {
 			RewindData rewindData = data[i];
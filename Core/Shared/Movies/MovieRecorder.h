@@ -23,6 +23,10 @@ private:
 	unique_ptr<ZipWriter> _writer;
 	std::unordered_map<string, vector<uint8_t>> _batteryData;
 	stringstream _inputData;
+
+	//Most recent input lines, kept out of _inputData until they can no longer be discarded by a netplay rollback
+	static constexpr uint32_t MaxPendingInputs = 0x1000;
+	deque<string> _pendingInputs;
 	bool _hasSaveState = false;
 	stringstream _saveStateData;
 
@@ -31,6 +35,7 @@ private:
 	void WriteString(stringstream &out, string name, string value);
 	void WriteInt(stringstream &out, string name, uint32_t value);
 	void WriteBool(stringstream &out, string name, bool enabled);
+	void FlushPendingInputs();
 
 public:
 	MovieRecorder(Emulator* emu);
@@ -41,6 +46,7 @@ public:
 
 	// Inherited via IInputRecorder
 	void RecordInput(vector<shared_ptr<BaseControlDevice>> devices) override;
+	void DiscardInputs(uint32_t pollCount) override;
 
 	// Inherited via IBatteryRecorder
 	void OnLoadBattery(string extension, vector<uint8_t> batteryData) override;
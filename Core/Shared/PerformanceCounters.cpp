@@ -0,0 +1,201 @@
+#include "pch.h"
+#include "Shared/PerformanceCounters.h"
+
+PerformanceCounters::PerformanceCounters()
+{
+	_active = false;
+	_enabled = false;
+	_displayEnabled = false;
+	_tracing = false;
+	Reset();
+
+	for(int i = 0; i < PerformanceCounters::CounterCount; i++) {
+		_frameTime[i] = 0;
+		_frameCallCount[i] = 0;
+	}
+}
+
+const char* PerformanceCounters::GetCounterName(PerfCounterType type)
+{
+	switch(type) {
+		case PerfCounterType::Frame: return "Frame";
+		case PerfCounterType::RunFrame: return "RunFrame";
+		case PerfCounterType::FrameWait: return "FrameWait";
+		case PerfCounterType::RunAhead: return "RunAhead";
+		case PerfCounterType::RewindCapture: return "RewindCapture";
+		case PerfCounterType::DecodeFrame: return "DecodeFrame";
+		case PerfCounterType::Render: return "Render";
+		case PerfCounterType::PlayAudio: return "PlayAudio";
+		case PerfCounterType::AudioResample: return "AudioResample";
+		case PerfCounterType::Serialize: return "Serialize";
+		case PerfCounterType::Deserialize: return "Deserialize";
+		case PerfCounterType::Netplay: return "Netplay";
+	}
+	return "";
+}
+
+uint32_t PerformanceCounters::GetThreadId()
+{
+	//Small sequential IDs are easier to read in the trace viewer than the OS' thread IDs
+	static atomic<uint32_t> threadCounter(0);
+	static thread_local uint32_t threadId = ++threadCounter;
+	return threadId;
+}
+
+void PerformanceCounters::UpdateActiveFlag()
+{
+	_active = _enabled || _displayEnabled || _tracing;
+}
+
+void PerformanceCounters::SetEnabled(bool enabled)
+{
+	auto lock = _historyLock.AcquireSafe();
+	_enabled = enabled;
+	UpdateActiveFlag();
+}
+
+void PerformanceCounters::SetDisplayEnabled(bool enabled)
+{
+	if(_displayEnabled != enabled) {
+		auto lock = _historyLock.AcquireSafe();
+		_displayEnabled = enabled;
+		UpdateActiveFlag();
+	}
+}
+
+void PerformanceCounters::Reset()
+{
+	for(int i = 0; i < PerformanceCounters::CounterCount; i++) {
+		_totalTime[i] = 0;
+		_callCount[i] = 0;
+	}
+
+	auto lock = _historyLock.AcquireSafe();
+	for(int i = 0; i < PerformanceCounters::CounterCount; i++) {
+		_historyPos[i] = 0;
+		_historyCount[i] = 0;
+	}
+}
+
+void PerformanceCounters::Add(PerfCounterType type, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	uint64_t duration = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+	_totalTime[(int)type] += duration;
+	_callCount[(int)type]++;
+	_frameTime[(int)type] += duration;
+	_frameCallCount[(int)type]++;
+
+	if(_tracing) {
+		auto lock = _traceLock.AcquireSafe();
+		if(_tracing && _traceEvents.size() < PerformanceCounters::MaxTraceEvents && start >= _traceStart) {
+			uint64_t traceTime = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(start - _traceStart).count();
+			_traceEvents.push_back({ type, GetThreadId(), traceTime, duration });
+		}
+	}
+}
+
+PerfCounterStats PerformanceCounters::GetStats(PerfCounterType type)
+{
+	PerfCounterStats stats = {};
+	stats.TotalTime = _totalTime[(int)type] / 1000000.0;
+	stats.CallCount = _callCount[(int)type];
+	return stats;
+}
+
+void PerformanceCounters::EndFrame()
+{
+	auto lock = _historyLock.AcquireSafe();
+	for(int i = 0; i < PerformanceCounters::CounterCount; i++) {
+		uint32_t callCount = _frameCallCount[i].exchange(0);
+		uint64_t time = _frameTime[i].exchange(0);
+		if(callCount > 0) {
+			_history[i][_historyPos[i]] = (float)(time / 1000000.0);
+			_historyPos[i] = (_historyPos[i] + 1) % PerformanceCounters::HistorySize;
+			_historyCount[i] = std::min(_historyCount[i] + 1, PerformanceCounters::HistorySize);
+		}
+	}
+}
+
+PerfCounterFrameStats PerformanceCounters::GetFrameStats(PerfCounterType type)
+{
+	PerfCounterFrameStats stats = {};
+	if((int)type < 0 || (int)type >= PerformanceCounters::CounterCount) {
+		//The type comes from the UI (interop), ignore invalid values
+		return stats;
+	}
+
+	vector<float> samples;
+	{
+		auto lock = _historyLock.AcquireSafe();
+		samples.assign(_history[(int)type], _history[(int)type] + _historyCount[(int)type]);
+	}
+
+	stats.SampleCount = (uint32_t)samples.size();
+	if(samples.empty()) {
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	double total = 0;
+	for(float sample : samples) {
+		total += sample;
+	}
+
+	stats.Average = total / samples.size();
+	stats.P50 = samples[samples.size() / 2];
+	stats.P99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+	stats.Max = samples.back();
+	return stats;
+}
+
+void PerformanceCounters::StartTrace()
+{
+	{
+		auto lock = _traceLock.AcquireSafe();
+		_traceEvents.clear();
+		_traceEvents.reserve(0x10000);
+		_traceStart = std::chrono::steady_clock::now();
+		_tracing = true;
+	}
+
+	auto lock = _historyLock.AcquireSafe();
+	UpdateActiveFlag();
+}
+
+bool PerformanceCounters::StopTrace(string filename)
+{
+	vector<TraceEvent> events;
+	{
+		auto lock = _traceLock.AcquireSafe();
+		if(!_tracing) {
+			return false;
+		}
+		_tracing = false;
+		events = std::move(_traceEvents);
+		_traceEvents = {};
+	}
+
+	{
+		auto lock = _historyLock.AcquireSafe();
+		UpdateActiveFlag();
+	}
+
+	ofstream out(filename, ios::out | ios::trunc);
+	if(!out) {
+		return false;
+	}
+
+	//Complete ("X") events, timestamps are in microseconds
+	out << "{\"traceEvents\":[\n";
+	out << std::fixed << std::setprecision(3);
+	for(size_t i = 0; i < events.size(); i++) {
+		TraceEvent& evt = events[i];
+		out << "{\"name\":\"" << GetCounterName(evt.Type) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << evt.ThreadId;
+		out << ",\"ts\":" << (evt.Start / 1000.0) << ",\"dur\":" << (evt.Duration / 1000.0) << "}";
+		out << (i + 1 < events.size() ? ",\n" : "\n");
+	}
+	out << "],\"displayTimeUnit\":\"ms\"}\n";
+	return true;
+}
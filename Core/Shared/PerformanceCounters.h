@@ -0,0 +1,142 @@
+#pragma once
+#include "pch.h"
+#include <chrono>
+#include "Utilities/SimpleLock.h"
+
+enum class PerfCounterType
+{
+	Frame, //A full iteration of the emulation loop (Emulator::Run), including the time spent waiting for the next frame
+	RunFrame, //Includes FrameWait and PlayAudio (both are processed at the end of each frame)
+	FrameWait,
+	RunAhead,
+	RewindCapture,
+	DecodeFrame,
+	Render,
+	PlayAudio,
+	AudioResample,
+	Serialize,
+	Deserialize,
+	Netplay,
+};
+
+struct PerfCounterStats
+{
+	double TotalTime; //in milliseconds
+	uint32_t CallCount;
+};
+
+//Time spent in a counter, per frame (only includes frames where the counter was used)
+struct PerfCounterFrameStats
+{
+	double Average; //in milliseconds
+	double P50;
+	double P99;
+	double Max;
+	uint32_t SampleCount;
+};
+
+//Measures the time spent in the main stages of the emulation (used by benchmarks, the debug HUD and traces)
+//Disabled by default - the timers cost nothing besides a flag check when disabled, and can be removed
+//entirely from the build by defining MESEN_NO_PERF_COUNTERS
+class PerformanceCounters
+{
+public:
+	static constexpr int CounterCount = (int)PerfCounterType::Netplay + 1;
+
+private:
+	static constexpr uint32_t HistorySize = 600;
+	static constexpr size_t MaxTraceEvents = 2000000;
+
+	struct TraceEvent
+	{
+		PerfCounterType Type;
+		uint32_t ThreadId;
+		uint64_t Start; //in nanoseconds, relative to _traceStart
+		uint64_t Duration;
+	};
+
+	atomic<bool> _active;
+	atomic<bool> _enabled;
+	atomic<bool> _displayEnabled;
+	atomic<bool> _tracing;
+
+	atomic<uint64_t> _totalTime[PerformanceCounters::CounterCount]; //in nanoseconds
+	atomic<uint32_t> _callCount[PerformanceCounters::CounterCount];
+
+	//Time spent in each counter since the last call to EndFrame
+	atomic<uint64_t> _frameTime[PerformanceCounters::CounterCount];
+	atomic<uint32_t> _frameCallCount[PerformanceCounters::CounterCount];
+
+	SimpleLock _historyLock;
+	float _history[PerformanceCounters::CounterCount][PerformanceCounters::HistorySize] = {};
+	uint32_t _historyPos[PerformanceCounters::CounterCount] = {};
+	uint32_t _historyCount[PerformanceCounters::CounterCount] = {};
+
+	SimpleLock _traceLock;
+	vector<TraceEvent> _traceEvents;
+	std::chrono::steady_clock::time_point _traceStart;
+
+	void UpdateActiveFlag();
+	static uint32_t GetThreadId();
+
+public:
+	PerformanceCounters();
+
+	static const char* GetCounterName(PerfCounterType type);
+
+	void SetEnabled(bool enabled);
+	void SetDisplayEnabled(bool enabled);
+	bool IsEnabled() { return _active; }
+
+	void Reset();
+	void Add(PerfCounterType type, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+	PerfCounterStats GetStats(PerfCounterType type);
+
+	//Called by the emulation thread once per iteration of the emulation loop
+	void EndFrame();
+	PerfCounterFrameStats GetFrameStats(PerfCounterType type);
+
+	//Records every timed call, to be saved in Chrome's trace event format (chrome://tracing, Perfetto)
+	void StartTrace();
+	bool StopTrace(string filename);
+	bool IsTracing() { return _tracing; }
+};
+
+struct BenchmarkResult
+{
+	uint32_t FrameCount;
+	double ElapsedSeconds;
+	PerfCounterStats Counters[PerformanceCounters::CounterCount];
+};
+
+//Adds the time elapsed between its construction and destruction to the specified counter
+class PerfTimer
+{
+private:
+	PerformanceCounters* _counters;
+	PerfCounterType _type;
+	std::chrono::steady_clock::time_point _start;
+
+public:
+	PerfTimer(PerformanceCounters* counters, PerfCounterType type)
+	{
+		_counters = counters->IsEnabled() ? counters : nullptr;
+		_type = type;
+		if(_counters) {
+			_start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~PerfTimer()
+	{
+		if(_counters) {
+			_counters->Add(_type, _start, std::chrono::steady_clock::now());
+		}
+	}
+};
+
+#ifndef MESEN_NO_PERF_COUNTERS
+	#define PERF_TIMER(counters, type) PerfTimer _perfTimer##type(counters, PerfCounterType::type)
+#else
+	#define PERF_TIMER(counters, type)
+#endif
@@ -12,6 +12,7 @@
 #include "Utilities/ZipWriter.h"
 #include "Utilities/ZipReader.h"
 #include "Utilities/ArchiveReader.h"
+#include "Utilities/Timer.h"
 
 RecordedRomTest::RecordedRomTest(Emulator* emu, bool inBackground)
 {
@@ -55,6 +56,7 @@ void RecordedRomTest::ValidateFrame()
 
 	uint8_t md5Hash[16];
 	GetMd5Sum(md5Hash, frame.FrameBuffer, frame.Width * frame.Height * sizeof(uint16_t));
+	_frameCount++;
 
 	if(_currentCount == 0) {
 		_currentCount = _repetitionCount.front();
@@ -109,6 +111,7 @@ void RecordedRomTest::Reset()
 	_runningTest = false;
 	_recording = false;
 	_badFrameCount = 0;
+	_frameCount = 0;
 }
 
 void RecordedRomTest::Record(string filename, bool reset)
@@ -145,7 +148,7 @@ void RecordedRomTest::Record(string filename, bool reset)
 	}
 }
 
-RomTestResult RecordedRomTest::Run(string filename)
+RomTestResult RecordedRomTest::Run(string filename, uint32_t timeoutSeconds)
 {
 	RomTestResult result = {};
 	_emu->GetNotificationManager()->RegisterNotificationListener(shared_from_this());
@@ -216,6 +219,9 @@ RomTestResult RecordedRomTest::Run(string filename)
 		settings->GetPcEngineConfig().RamPowerOnState = RamState::AllZeros;
 		settings->GetPcEngineConfig().DisableFrameSkipping = true;
 
+		bool timedOut = false;
+		Timer timer;
+
 		_emu->Lock();
 		//Start playing movie
 		if(_emu->LoadRom(testRom, VirtualFile(""))) {
@@ -224,7 +230,14 @@ RomTestResult RecordedRomTest::Run(string filename)
 
 			_runningTest = true;
 			_emu->Unlock();
-			_signal.Wait();
+			if(timeoutSeconds > 0) {
+				while(_runningTest && timer.GetElapsedMS() < timeoutSeconds * 1000.0) {
+					_signal.Wait(100);
+				}
+				timedOut = _runningTest;
+			} else {
+				_signal.Wait();
+			}
 			_emu->Stop(!_inBackground);
 			_runningTest = false;
 		} else {
@@ -236,6 +249,14 @@ RomTestResult RecordedRomTest::Run(string filename)
 
 		settings->ClearFlag(EmulationFlags::MaximumSpeed);
 
+		result.FrameCount = _frameCount;
+		result.ElapsedSeconds = timer.GetElapsedMS() / 1000.0;
+		if(timedOut) {
+			result.ErrorCode = -5;
+			result.State = RomTestState::Failed;
+			return result;
+		}
+
 		result.ErrorCode = _badFrameCount;
 		result.State = _badFrameCount == 0 ? RomTestState::Passed : (_isLastFrameGood ? RomTestState::PassedWithWarnings : RomTestState::Failed);
 
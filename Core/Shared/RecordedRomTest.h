@@ -19,6 +19,8 @@ struct RomTestResult
 {
 	RomTestState State;
 	int32_t ErrorCode;
+	uint32_t FrameCount;
+	double ElapsedSeconds;
 };
 
 class RecordedRomTest : public INotificationListener, public std::enable_shared_from_this<RecordedRomTest>
@@ -28,8 +30,9 @@ private:
 
 	bool _inBackground = false;
 	bool _recording = false;
-	bool _runningTest = false;
+	atomic<bool> _runningTest;
 	int _badFrameCount = 0;
+	uint32_t _frameCount = 0;
 	bool _isLastFrameGood = false;
 
 	uint8_t _previousHash[16] = {};
@@ -54,6 +57,8 @@ public:
 
 	void ProcessNotification(ConsoleNotificationType type, void* parameter) override;
 	void Record(string filename, bool reset);
-	RomTestResult Run(string filename);
+
+	//timeoutSeconds: the test fails if it isn't done after this amount of time (0 = no timeout)
+	RomTestResult Run(string filename, uint32_t timeoutSeconds = 0);
 	void Stop();
 };
\ No newline at end of file
@@ -13,6 +13,7 @@ struct RenderedFrame
 	uint32_t FrameNumber = 0;
 	uint32_t VideoPhase = 0;
 	vector<ControllerData> InputData;
+	uint32_t BufferSize = 0; //Number of pixels in FrameBuffer, when it isn't Width * Height
 
 	RenderedFrame()
 	{}
@@ -2,63 +2,159 @@
 #include "Shared/RewindData.h"
 #include "Shared/Emulator.h"
 #include "Shared/SaveStateManager.h"
+#include "Shared/RewindKeyFrameCache.h"
 #include "Utilities/CompressionHelper.h"
 
-void RewindData::GetStateData(stringstream &stateData, deque<RewindData>& prevStates, int32_t position)
+bool RewindData::GetStateData(stringstream &stateData, deque<RewindData>& prevStates, int32_t position)
 {
 	vector<uint8_t> data;
-	CompressionHelper::Decompress(_saveStateData, data);
+	if(!GetState(data, prevStates, position)) {
+		return false;
+	}
+	stateData.write((char*)data.data(), data.size());
+	return true;
+}
 
-	if(!IsFullState) {
-		position = (position > 0 ? position : (int32_t)prevStates.size()) - 1;
-		ProcessXorState(data, prevStates, position);
+bool RewindData::GetState(vector<uint8_t>& output, deque<RewindData>& prevStates, int32_t position)
+{
+	if(IsFullState) {
+		shared_ptr<vector<uint8_t>> keyFrame = GetKeyFrameData();
+		if(!keyFrame) {
+			return false;
+		}
+		output = *keyFrame;
+		return true;
 	}
 
-	stateData.write((char*)data.data(), data.size());
+	position = (position > 0 ? position : (int32_t)prevStates.size()) - 1;
+	shared_ptr<vector<uint8_t>> keyFrame = FindKeyFrameData(prevStates, position);
+	if(!keyFrame) {
+		//The delta can't be rebuilt without its key frame
+		return false;
+	}
+
+	vector<uint8_t> pageData;
+	if(!CompressionHelper::Decompress(_saveStateData, pageData)) {
+		return false;
+	}
+
+	return ApplyDirtyPages(pageData, *keyFrame, output);
+}
+
+shared_ptr<vector<uint8_t>> RewindData::GetKeyFrameData()
+{
+	shared_ptr<vector<uint8_t>> keyFrame = _keyFrameCache ? _keyFrameCache->Get(_keyFrameId) : nullptr;
+	if(!keyFrame) {
+		keyFrame.reset(new vector<uint8_t>());
+		if(!CompressionHelper::Decompress(_saveStateData, *keyFrame)) {
+			return nullptr;
+		}
+		if(_keyFrameCache) {
+			_keyFrameCache->Add(_keyFrameId, keyFrame);
+		}
+	}
+	return keyFrame;
 }
 
-template<typename T>
-void RewindData::ProcessXorState(T& data, deque<RewindData>& prevStates, int32_t position)
+shared_ptr<vector<uint8_t>> RewindData::FindKeyFrameData(deque<RewindData>& prevStates, int32_t position)
 {
-	//Find last full state and XOR with it
-	while(position >= 0 && position < prevStates.size()) {
+	//Find last full state
+	while(position >= 0 && position < (int32_t)prevStates.size()) {
 		RewindData& prevState = prevStates[position];
 		if(prevState.IsFullState) {
-			//XOR with previous state to restore state data to its initial state
-			vector<uint8_t> prevStateData;
-			CompressionHelper::Decompress(prevState._saveStateData, prevStateData);
-			for(size_t i = 0, len = std::min(prevStateData.size(), data.size()); i < len; i++) {
-				data[i] ^= prevStateData[i];
-			}
-			break;
+			return prevState.GetKeyFrameData();
 		}
 		position--;
 	}
+	return nullptr;
+}
+
+void RewindData::GetDirtyPages(const uint8_t* data, uint32_t stateSize, const vector<uint8_t>& keyFrame, vector<uint8_t>& output)
+{
+	//Format: state size (4 bytes), dirty page bitmap, content of all dirty pages
+	uint32_t pageCount = (stateSize + RewindData::PageSize - 1) / RewindData::PageSize;
+	uint32_t bitmapSize = (pageCount + 7) / 8;
+
+	output.clear();
+	output.reserve(sizeof(uint32_t) + bitmapSize + stateSize / 8);
+	output.insert(output.end(), (uint8_t*)&stateSize, (uint8_t*)&stateSize + sizeof(uint32_t));
+	output.resize(sizeof(uint32_t) + bitmapSize, 0);
+
+	const uint8_t* src = data;
+	for(uint32_t i = 0; i < pageCount; i++) {
+		uint32_t start = i * RewindData::PageSize;
+		uint32_t len = std::min(RewindData::PageSize, stateSize - start);
+		if(start + len > keyFrame.size() || memcmp(src + start, keyFrame.data() + start, len) != 0) {
+			output[sizeof(uint32_t) + (i >> 3)] |= 1 << (i & 0x07);
+			output.insert(output.end(), src + start, src + start + len);
+		}
+	}
+}
+
+bool RewindData::ApplyDirtyPages(vector<uint8_t>& pageData, const vector<uint8_t>& keyFrame, vector<uint8_t>& output)
+{
+	output.clear();
+	if(pageData.size() < sizeof(uint32_t)) {
+		return false;
+	}
+
+	uint32_t stateSize;
+	memcpy(&stateSize, pageData.data(), sizeof(uint32_t));
+	uint64_t pageCount = ((uint64_t)stateSize + RewindData::PageSize - 1) / RewindData::PageSize;
+	uint64_t bitmapSize = (pageCount + 7) / 8;
+	if(sizeof(uint32_t) + bitmapSize > pageData.size()) {
+		return false;
+	}
+
+	//Validate the size of the data against the bitmap before writing anything
+	uint8_t* bitmap = pageData.data() + sizeof(uint32_t);
+	uint64_t expectedSize = sizeof(uint32_t) + bitmapSize;
+	for(uint32_t i = 0; i < pageCount; i++) {
+		if(bitmap[i >> 3] & (1 << (i & 0x07))) {
+			expectedSize += std::min(RewindData::PageSize, stateSize - i * RewindData::PageSize);
+		}
+	}
+	if(expectedSize != pageData.size()) {
+		return false;
+	}
+
+	output.assign(keyFrame.begin(), keyFrame.begin() + std::min<size_t>(keyFrame.size(), stateSize));
+	output.resize(stateSize, 0);
+
+	size_t pos = sizeof(uint32_t) + bitmapSize;
+	for(uint32_t i = 0; i < pageCount; i++) {
+		if(bitmap[i >> 3] & (1 << (i & 0x07))) {
+			uint32_t start = i * RewindData::PageSize;
+			uint32_t len = std::min(RewindData::PageSize, stateSize - start);
+			memcpy(output.data() + start, pageData.data() + pos, len);
+			pos += len;
+		}
+	}
+	return true;
 }
 
-void RewindData::LoadState(Emulator* emu, deque<RewindData>& prevStates, int32_t position)
+bool RewindData::LoadState(Emulator* emu, deque<RewindData>& prevStates, int32_t position)
 {
 	if(_saveStateData.size() == 0) {
-		return;
+		return false;
 	}
 		
 	vector<uint8_t> data;
-	CompressionHelper::Decompress(_saveStateData, data);
-
-	if(!IsFullState) {
-		position = (position > 0 ? position : (int32_t)prevStates.size()) - 1;
-		ProcessXorState(data, prevStates, position);
+	if(!GetState(data, prevStates, position)) {
+		return false;
 	}
 
 	stringstream stream;
 	stream.write((char*)data.data(), data.size());
 	stream.seekg(0, ios::beg);
 
-	emu->Deserialize(stream, SaveStateManager::FileFormatVersion, true);
+	return emu->Deserialize(stream, SaveStateManager::FileFormatVersion, true);
 }
 
-void RewindData::SaveState(Emulator* emu, deque<RewindData>& prevStates, int32_t position)
+void RewindData::SaveState(Emulator* emu, shared_ptr<RewindKeyFrameCache> keyFrameCache, deque<RewindData>& prevStates, int32_t position)
 {
+	_keyFrameCache = keyFrameCache;
+
 	std::stringstream state;
 	emu->Serialize(state, true, 0);
 
@@ -66,13 +162,26 @@ void RewindData::SaveState(Emulator* emu, deque<RewindData>& prevStates, int32_t
 
 	position = position > 0 ? position : (int32_t)prevStates.size();
 
+	shared_ptr<vector<uint8_t>> keyFrame;
 	if(position > 0 && (position % 30) != 0) {
-		position--;
-		ProcessXorState(data, prevStates, position);
+		keyFrame = FindKeyFrameData(prevStates, position - 1);
+	}
+
+	if(keyFrame) {
+		//Only keep the pages that changed since the last full state
+		vector<uint8_t> pageData;
+		GetDirtyPages((uint8_t*)data.data(), (uint32_t)data.size(), *keyFrame, pageData);
+		CompressionHelper::Compress(pageData.data(), pageData.size(), 1, _saveStateData, CompressionType::Lz);
 	} else {
 		IsFullState = true;
+		_keyFrameId = RewindKeyFrameCache::GetNewId();
+		CompressionHelper::Compress(data, 1, _saveStateData, CompressionType::Lz);
+
+		//Keep the uncompressed state in the cache, it is needed to save the next delta states
+		if(_keyFrameCache) {
+			_keyFrameCache->Add(_keyFrameId, std::make_shared<vector<uint8_t>>(data.begin(), data.end()));
+		}
 	}
 
-	CompressionHelper::Compress(data, 1, _saveStateData);
 	FrameCount = 0;
 }
@@ -4,14 +4,22 @@
 #include "Shared/BaseControlDevice.h"
 
 class Emulator;
+class RewindKeyFrameCache;
 
 class RewindData
 {
 private:
+	//Delta states only contain the pages that differ from the previous full state (key frame)
+	static constexpr uint32_t PageSize = 256;
+
 	vector<uint8_t> _saveStateData;
+	uint64_t _keyFrameId = 0;
+	shared_ptr<RewindKeyFrameCache> _keyFrameCache;
+
+	shared_ptr<vector<uint8_t>> GetKeyFrameData();
+	static shared_ptr<vector<uint8_t>> FindKeyFrameData(deque<RewindData>& prevStates, int32_t position);
 
-	template<typename T>
-	void ProcessXorState(T& data, deque<RewindData>& prevStates, int32_t position);
+	bool GetState(vector<uint8_t>& output, deque<RewindData>& prevStates, int32_t position);
 
 public:
 	std::deque<ControlDeviceState> InputLogs[BaseControlDevice::PortCount];
@@ -19,9 +27,14 @@ public:
 	bool EndOfSegment = false;
 	bool IsFullState = false;
 
-	void GetStateData(stringstream& stateData, deque<RewindData>& prevStates, int32_t position);
+	bool GetStateData(stringstream& stateData, deque<RewindData>& prevStates, int32_t position);
 	uint32_t GetStateSize() { return (uint32_t)_saveStateData.size(); }
 
-	void LoadState(Emulator* emu, deque<RewindData>& prevStates, int32_t position = -1);
-	void SaveState(Emulator* emu, deque<RewindData>& prevStates, int32_t position = -1);
+	bool LoadState(Emulator* emu, deque<RewindData>& prevStates, int32_t position = -1);
+	void SaveState(Emulator* emu, shared_ptr<RewindKeyFrameCache> keyFrameCache, deque<RewindData>& prevStates, int32_t position = -1);
+	void SetKeyFrameCache(shared_ptr<RewindKeyFrameCache> keyFrameCache) { _keyFrameCache = keyFrameCache; }
+
+	//Also used by netplay to send states as a delta against the last state the client received
+	static void GetDirtyPages(const uint8_t* data, uint32_t stateSize, const vector<uint8_t>& keyFrame, vector<uint8_t>& output);
+	static bool ApplyDirtyPages(vector<uint8_t>& pageData, const vector<uint8_t>& keyFrame, vector<uint8_t>& output);
 };
@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "Shared/RewindKeyFrameCache.h"
+
+atomic<uint64_t> RewindKeyFrameCache::_nextId(1);
+
+uint64_t RewindKeyFrameCache::GetNewId()
+{
+	return _nextId++;
+}
+
+shared_ptr<vector<uint8_t>> RewindKeyFrameCache::Get(uint64_t id)
+{
+	auto lock = _lock.AcquireSafe();
+	auto result = _entriesById.find(id);
+	if(result == _entriesById.end()) {
+		_misses++;
+		return nullptr;
+	}
+
+	//Move to the front of the list (most recently used)
+	_entries.splice(_entries.begin(), _entries, result->second);
+	_hits++;
+	return _entries.front().Data;
+}
+
+void RewindKeyFrameCache::Add(uint64_t id, shared_ptr<vector<uint8_t>> data)
+{
+	uint32_t size = (uint32_t)data->size();
+	if(size > RewindKeyFrameCache::MaxCacheSize) {
+		return;
+	}
+
+	auto lock = _lock.AcquireSafe();
+	auto result = _entriesById.find(id);
+	if(result != _entriesById.end()) {
+		//Replace the existing entry
+		_cacheSize -= (uint32_t)result->second->Data->size();
+		_entries.erase(result->second);
+	}
+
+	_entries.push_front({ id, data });
+	_entriesById[id] = _entries.begin();
+	_cacheSize += size;
+
+	while(_cacheSize > RewindKeyFrameCache::MaxCacheSize) {
+		//Evict least recently used key frames
+		_cacheSize -= (uint32_t)_entries.back().Data->size();
+		_entriesById.erase(_entries.back().Id);
+		_entries.pop_back();
+	}
+}
+
+void RewindKeyFrameCache::Clear()
+{
+	auto lock = _lock.AcquireSafe();
+	_entries.clear();
+	_entriesById.clear();
+	_cacheSize = 0;
+	_hits = 0;
+	_misses = 0;
+}
+
+RewindKeyFrameCacheStats RewindKeyFrameCache::GetStats()
+{
+	auto lock = _lock.AcquireSafe();
+	RewindKeyFrameCacheStats stats = {};
+	stats.CacheSize = _cacheSize;
+	stats.MaxCacheSize = RewindKeyFrameCache::MaxCacheSize;
+	stats.Hits = _hits;
+	stats.Misses = _misses;
+	return stats;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "pch.h"
+#include "Utilities/SimpleLock.h"
+
+struct RewindKeyFrameCacheStats
+{
+	uint32_t CacheSize;
+	uint32_t MaxCacheSize;
+	uint32_t Hits;
+	uint32_t Misses;
+};
+
+//LRU cache of decompressed rewind key frames (full states), to avoid decompressing the same key frame
+//every time one of its delta states is saved or loaded.
+//Each rewind history owner (RewindManager, HistoryViewer) has its own cache.
+class RewindKeyFrameCache
+{
+private:
+	static constexpr uint32_t MaxCacheSize = 16 * 1024 * 1024;
+	static atomic<uint64_t> _nextId;
+
+	struct CacheEntry
+	{
+		uint64_t Id;
+		shared_ptr<vector<uint8_t>> Data;
+	};
+
+	SimpleLock _lock;
+	std::list<CacheEntry> _entries;
+	unordered_map<uint64_t, std::list<CacheEntry>::iterator> _entriesById;
+	uint32_t _cacheSize = 0;
+	uint32_t _hits = 0;
+	uint32_t _misses = 0;
+
+public:
+	//Ids are unique across all caches, since history data can be copied from one owner to another
+	static uint64_t GetNewId();
+
+	shared_ptr<vector<uint8_t>> Get(uint64_t id);
+	void Add(uint64_t id, shared_ptr<vector<uint8_t>> data);
+	void Clear();
+
+	RewindKeyFrameCacheStats GetStats();
+};
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Shared/RewindManager.h"
+#include "Shared/RewindKeyFrameCache.h"
 #include "Shared/MessageManager.h"
 #include "Shared/Emulator.h"
 #include "Shared/EmuSettings.h"
@@ -8,11 +9,13 @@
 #include "Shared/BaseControlDevice.h"
 #include "Shared/RenderedFrame.h"
 #include "Shared/BaseControlManager.h"
+#include "Shared/PerformanceCounters.h"
 
 RewindManager::RewindManager(Emulator* emu)
 {
 	_emu = emu;
 	_settings = emu->GetSettings();
+	_keyFrameCache.reset(new RewindKeyFrameCache());
 }
 
 RewindManager::~RewindManager()
@@ -38,6 +41,7 @@ void RewindManager::Reset()
 	_settings->ClearFlag(EmulationFlags::MaximumSpeed);
 	_settings->ClearFlag(EmulationFlags::Rewind);
 	ClearBuffer();
+	_keyFrameCache->Clear();
 }
 
 void RewindManager::ClearBuffer()
@@ -116,6 +120,12 @@ RewindStats RewindManager::GetStats()
 	stats.MemoryUsage = memoryUsage;
 	stats.HistorySize = (uint32_t)_history.size();
 	stats.HistoryDuration = stats.HistorySize * RewindManager::BufferSize;
+
+	RewindKeyFrameCacheStats cacheStats = _keyFrameCache->GetStats();
+	stats.KeyFrameCacheSize = cacheStats.CacheSize;
+	stats.KeyFrameCacheMaxSize = cacheStats.MaxCacheSize;
+	stats.KeyFrameCacheHits = cacheStats.Hits;
+	stats.KeyFrameCacheMisses = cacheStats.Misses;
 	return stats;
 }
 
@@ -143,8 +153,9 @@ void RewindManager::AddHistoryBlock()
 		if(_currentHistory.FrameCount > 0) {
 			_history.push_back(_currentHistory);
 		}
+		PERF_TIMER(_emu->GetPerformanceCounters(), RewindCapture);
 		_currentHistory = RewindData();
-		_currentHistory.SaveState(_emu, _history);
+		_currentHistory.SaveState(_emu, _keyFrameCache, _history);
 	}
 }
 
@@ -159,7 +170,14 @@ void RewindManager::PopHistory()
 		}
 
 		_historyBackup.push_front(_currentHistory);
-		_currentHistory.LoadState(_emu, _history);
+		if(!_currentHistory.LoadState(_emu, _history)) {
+			//The state (or the key frame it depends on) can't be rebuilt, so the older states can't be loaded either
+			//Stop rewinding at the last state that was loaded successfully
+			MessageManager::Log("[Rewind] Could not load rewind state, stopping.");
+			_history.clear();
+			_currentHistory.FrameCount = 0;
+			return;
+		}
 		if(!_audioHistoryBuilder.empty()) {
 			_audioHistory.insert(_audioHistory.begin(), _audioHistoryBuilder.begin(), _audioHistoryBuilder.end());
 			_audioHistoryBuilder.clear();
@@ -345,6 +363,29 @@ void RewindManager::RecordInput(vector<shared_ptr<BaseControlDevice>> devices)
 	}
 }
 
+void RewindManager::DiscardInputs(uint32_t pollCount)
+{
+	if(_settings->GetPreferences().RewindBufferSize > 0 && _rewindState == RewindState::Stopped) {
+		for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+			//Each poll added one entry for every connected port, the inputs may span the current and previous blocks
+			uint32_t count = pollCount;
+			std::deque<ControlDeviceState>* logs = &_currentHistory.InputLogs[i];
+			while(count > 0 && !logs->empty()) {
+				logs->pop_back();
+				count--;
+			}
+
+			if(count > 0 && !_history.empty()) {
+				logs = &_history.back().InputLogs[i];
+				while(count > 0 && !logs->empty()) {
+					logs->pop_back();
+					count--;
+				}
+			}
+		}
+	}
+}
+
 bool RewindManager::SetInput(BaseControlDevice *device)
 {
 	uint8_t port = device->GetPort();
@@ -34,6 +34,11 @@ struct RewindStats
 	uint32_t MemoryUsage;
 	uint32_t HistorySize;
 	uint32_t HistoryDuration;
+
+	uint32_t KeyFrameCacheSize;
+	uint32_t KeyFrameCacheMaxSize;
+	uint32_t KeyFrameCacheHits;
+	uint32_t KeyFrameCacheMisses;
 };
 
 class RewindManager : public INotificationListener, public IInputProvider, public IInputRecorder
@@ -51,6 +56,7 @@ private:
 	deque<RewindData> _history;
 	deque<RewindData> _historyBackup;
 	RewindData _currentHistory = {};
+	shared_ptr<RewindKeyFrameCache> _keyFrameCache;
 
 	RewindState _rewindState = RewindState::Stopped;
 	int32_t _framesToFastForward = 0;
@@ -84,6 +90,7 @@ public:
 	void ProcessEndOfFrame();
 
 	void RecordInput(vector<shared_ptr<BaseControlDevice>> devices) override;
+	void DiscardInputs(uint32_t pollCount) override;
 	bool SetInput(BaseControlDevice *device) override;
 
 	void StartRewinding(bool forDebugger = false);
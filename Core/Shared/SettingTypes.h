@@ -111,6 +111,9 @@ struct VideoConfig
 	uint32_t FullscreenResHeight = 0;
 
 	uint32_t ScreenRotation = 0;
+
+	//Number of threads used by the scale filters (xBRZ, HQX, etc.) and HD packs, 0 = automatic
+	uint32_t FilterThreadCount = 0;
 };
 
 struct AudioConfig
@@ -524,6 +527,7 @@ struct NesConfig
 
 	ConsoleRegion Region = ConsoleRegion::Auto;
 	bool EnableHdPacks = true;
+	bool CacheHdPackImages = false;
 	bool DisableGameDatabase = false;
 	bool FdsAutoLoadDisk = true;
 	bool FdsFastForwardOnLoad = false;
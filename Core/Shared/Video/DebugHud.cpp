@@ -4,6 +4,7 @@
 #include "Shared/Video/DrawCommand.h"
 #include "Shared/Video/DrawLineCommand.h"
 #include "Shared/Video/DrawPixelCommand.h"
+#include "Shared/Video/DrawPixelBufferCommand.h"
 #include "Shared/Video/DrawRectangleCommand.h"
 #include "Shared/Video/DrawStringCommand.h"
 #include "Shared/Video/DrawScreenBufferCommand.h"
@@ -11,46 +12,133 @@
 DebugHud::DebugHud()
 {
 	_commandCount = 0;
+	_buffers.push_back(unique_ptr<DrawCommandBuffer>(new DrawCommandBuffer()));
+	_currentBuffer = _buffers.back().get();
 }
 
 DebugHud::~DebugHud()
 {
-	_commandLock.Acquire();
-	_commandLock.Release();
+	auto lock = _drawLock.AcquireSafe();
+	ClearCommands();
 }
 
-void DebugHud::ClearScreen()
+DrawCommandBuffer* DebugHud::SwapBuffers()
+{
+	DrawCommandBuffer* newBuffer;
+	if(_freeBuffers.size()) {
+		newBuffer = _freeBuffers.back();
+		_freeBuffers.pop_back();
+	} else {
+		_buffers.push_back(unique_ptr<DrawCommandBuffer>(new DrawCommandBuffer()));
+		newBuffer = _buffers.back().get();
+	}
+
+	DrawCommandBuffer* buffer = _currentBuffer.exchange(newBuffer);
+
+	//Wait for threads that started adding a command before the swap
+	buffer->WaitForWriters();
+	return buffer;
+}
+
+void DebugHud::ReleaseCommand(DrawCommand* cmd, DrawCommandBuffer* buffer)
+{
+	cmd->~DrawCommand();
+	buffer->LiveCommandCount--;
+	if(buffer->LiveCommandCount == 0) {
+		buffer->Reset();
+		_freeBuffers.push_back(buffer);
+	}
+}
+
+void DebugHud::ClearCommands()
 {
-	auto lock = _commandLock.AcquireSafe();
+	DrawCommandBuffer* buffer = SwapBuffers();
+	_newCommands.clear();
+	buffer->GetCommands(_newCommands);
+	for(DrawCommand* cmd : _newCommands) {
+		_commands.push_back({ cmd, buffer });
+	}
+	if(buffer->LiveCommandCount == 0) {
+		buffer->Reset();
+		_freeBuffers.push_back(buffer);
+	}
+
+	for(auto& [cmd, cmdBuffer] : _commands) {
+		ReleaseCommand(cmd, cmdBuffer);
+	}
 	_commands.clear();
+	_commandCount = 0;
+}
+
+void DebugHud::ClearScreen()
+{
+	auto lock = _drawLock.AcquireSafe();
+	ClearCommands();
 }
 
 void DebugHud::Draw(uint32_t* argbBuffer, FrameInfo frameInfo, OverscanDimensions overscan, uint32_t frameNumber, bool autoScale, float forcedScale)
 {
-	auto lock = _commandLock.AcquireSafe();
-	for(unique_ptr<DrawCommand> &command : _commands) {
-		command->Draw(argbBuffer, frameInfo, overscan, frameNumber, autoScale, forcedScale);
+	auto lock = _drawLock.AcquireSafe();
+
+	//Take all the commands that were added since the last call
+	DrawCommandBuffer* buffer = SwapBuffers();
+	_newCommands.clear();
+	buffer->GetCommands(_newCommands);
+	for(DrawCommand* cmd : _newCommands) {
+		if(_commands.size() < DebugHud::MaxCommandCount) {
+			_commands.push_back({ cmd, buffer });
+		} else {
+			ReleaseCommand(cmd, buffer);
+		}
+	}
+	if(_newCommands.empty()) {
+		buffer->Reset();
+		_freeBuffers.push_back(buffer);
+	}
+
+	for(auto& [cmd, cmdBuffer] : _commands) {
+		cmd->Draw(argbBuffer, frameInfo, overscan, frameNumber, autoScale, forcedScale);
 	}
-	_commands.erase(std::remove_if(_commands.begin(), _commands.end(), [](const unique_ptr<DrawCommand>& c) { return c->Expired(); }), _commands.end());
+
+	_commands.erase(std::remove_if(_commands.begin(), _commands.end(), [this](const std::pair<DrawCommand*, DrawCommandBuffer*>& c) {
+		if(c.first->Expired()) {
+			ReleaseCommand(c.first, c.second);
+			return true;
+		}
+		return false;
+	}), _commands.end());
 	_commandCount = (uint32_t)_commands.size();
 }
 
 void DebugHud::DrawPixel(int x, int y, int color, int frameCount, int startFrame)
 {
-	AddCommand(unique_ptr<DrawCommand>(new DrawPixelCommand(x, y, color, frameCount, startFrame)));
+	AddCommand<DrawPixelCommand>(0, x, y, color, frameCount, startFrame);
+}
+
+void DebugHud::DrawPixels(int x, int y, int width, int height, uint32_t* pixels, int frameCount, int startFrame)
+{
+	if(width <= 0 || height <= 0) {
+		return;
+	}
+	AddCommand<DrawPixelBufferCommand>(width * height * sizeof(uint32_t), x, y, width, height, pixels, frameCount, startFrame);
 }
 
 void DebugHud::DrawLine(int x, int y, int x2, int y2, int color, int frameCount, int startFrame)
 {
-	AddCommand(unique_ptr<DrawCommand>(new DrawLineCommand(x, y, x2, y2, color, frameCount, startFrame)));
+	AddCommand<DrawLineCommand>(0, x, y, x2, y2, color, frameCount, startFrame);
 }
 
 void DebugHud::DrawRectangle(int x, int y, int width, int height, int color, bool fill, int frameCount, int startFrame)
 {
-	AddCommand(unique_ptr<DrawCommand>(new DrawRectangleCommand(x, y, width, height, color, fill, frameCount, startFrame)));
+	AddCommand<DrawRectangleCommand>(0, x, y, width, height, color, fill, frameCount, startFrame);
 }
 
 void DebugHud::DrawString(int x, int y, string text, int color, int backColor, int frameCount, int startFrame, int maxWidth)
 {
-	AddCommand(unique_ptr<DrawCommand>(new DrawStringCommand(x, y, text, color, backColor, frameCount, startFrame, maxWidth)));
+	AddCommand<DrawStringCommand>(0, x, y, text, color, backColor, frameCount, startFrame, maxWidth);
+}
+
+void DebugHud::DrawScreenBuffer(uint32_t* pixels, uint32_t width, uint32_t height, int startFrame)
+{
+	AddCommand<DrawScreenBufferCommand>(width * height * sizeof(uint32_t), pixels, width, height, startFrame);
 }
@@ -3,35 +3,65 @@
 #include "Utilities/SimpleLock.h"
 #include "Shared/SettingTypes.h"
 #include "Shared/Video/DrawCommand.h"
+#include "Shared/Video/DrawCommandBuffer.h"
 
 class DebugHud
 {
 private:
 	static constexpr size_t MaxCommandCount = 500000;
-	vector<unique_ptr<DrawCommand>> _commands;
+
+	//New commands are added to _currentBuffer (without locking), which is swapped with an empty buffer
+	//when the HUD is drawn. Buffers are kept until all of their commands have expired, and then reused.
+	atomic<DrawCommandBuffer*> _currentBuffer;
+	vector<unique_ptr<DrawCommandBuffer>> _buffers;
+	vector<DrawCommandBuffer*> _freeBuffers;
+
+	//Commands that haven't expired yet (only accessed by the thread drawing the HUD, while holding _drawLock)
+	vector<std::pair<DrawCommand*, DrawCommandBuffer*>> _commands;
+	vector<DrawCommand*> _newCommands;
 	atomic<uint32_t> _commandCount;
-	SimpleLock _commandLock;
+	SimpleLock _drawLock;
+
+	DrawCommandBuffer* SwapBuffers();
+	void ReleaseCommand(DrawCommand* cmd, DrawCommandBuffer* buffer);
+	void ClearCommands();
+
+	template<typename T, typename... Args>
+	__forceinline void AddCommand(uint32_t extraSize, Args... args)
+	{
+		static_assert(alignof(T) <= 8, "draw commands must be aligned on 8 bytes or less");
+
+		while(true) {
+			DrawCommandBuffer* buffer = _currentBuffer;
+			buffer->BeginWrite();
+			if(buffer != _currentBuffer) {
+				//The buffer was swapped before the write started, try again with the new buffer
+				buffer->EndWrite();
+				continue;
+			}
+
+			void* cmd = buffer->Allocate(sizeof(T) + extraSize);
+			if(cmd) {
+				new (cmd) T(args...);
+			}
+			buffer->EndWrite();
+			return;
+		}
+	}
 
 public:
 	DebugHud();
 	~DebugHud();
 
-	bool HasCommands() { return _commandCount > 0; }
+	bool HasCommands() { return _commandCount > 0 || _currentBuffer.load()->HasCommands(); }
 
 	void Draw(uint32_t* argbBuffer, FrameInfo frameInfo, OverscanDimensions overscan, uint32_t frameNumber, bool autoScale, float forcedScale = 0);
 	void ClearScreen();
 
 	void DrawPixel(int x, int y, int color, int frameCount, int startFrame = -1);
+	void DrawPixels(int x, int y, int width, int height, uint32_t* pixels, int frameCount, int startFrame = -1);
 	void DrawLine(int x, int y, int x2, int y2, int color, int frameCount, int startFrame = -1);
 	void DrawRectangle(int x, int y, int width, int height, int color, bool fill, int frameCount, int startFrame = -1);
 	void DrawString(int x, int y, string text, int color, int backColor, int frameCount, int startFrame = -1, int maxWidth = 0);
-
-	__forceinline void AddCommand(unique_ptr<DrawCommand> cmd)
-	{
-		auto lock = _commandLock.AcquireSafe();
-		if(_commands.size() < DebugHud::MaxCommandCount) {
-			_commands.push_back(std::move(cmd));
-			_commandCount++;
-		}
-	}
+	void DrawScreenBuffer(uint32_t* pixels, uint32_t width, uint32_t height, int startFrame);
 };
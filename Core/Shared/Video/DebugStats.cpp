@@ -5,7 +5,9 @@
 #include "Shared/Interfaces/IAudioDevice.h"
 #include "Shared/Emulator.h"
 #include "Shared/RewindManager.h"
+#include "Shared/Video/VideoDecoder.h"
 #include "Shared/EmuSettings.h"
+#include "Shared/PerformanceCounters.h"
 
 void DebugStats::DisplayStats(Emulator *emu, double lastFrameTime)
 {
@@ -87,8 +89,8 @@ void DebugStats::DisplayStats(Emulator *emu, double lastFrameTime)
 		hud->DrawLine(130 + i*2, 60 + 50 - duration*2, 130 + i*2 + 2, 60 + 50 - nextDuration*2, lineColor, 1, startFrame);
 	}
 
-	hud->DrawRectangle(8, 60, 115, 34, 0x40000000, true, 1, startFrame);
-	hud->DrawRectangle(8, 60, 115, 34, 0xFFFFFF, false, 1, startFrame);
+	hud->DrawRectangle(8, 60, 115, 52, 0x40000000, true, 1, startFrame);
+	hud->DrawRectangle(8, 60, 115, 52, 0xFFFFFF, false, 1, startFrame);
 
 	hud->DrawString(10, 62, "Misc. Stats", 0xFFFFFF, 0xFF000000, 1, startFrame);
 
@@ -103,4 +105,61 @@ void DebugStats::DisplayStats(Emulator *emu, double lastFrameTime)
 		ss << "   Per min.: " << std::fixed << std::setprecision(2) << (memUsage * 60 * 60 / rewindStats.HistoryDuration) << " MB";
 		hud->DrawString(9, 82, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
 	}
+
+	ss = std::stringstream();
+	ss << "   Cache: " << std::fixed << std::setprecision(2) << ((double)rewindStats.KeyFrameCacheSize / (1024 * 1024)) << " MB";
+	hud->DrawString(9, 91, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+	VideoDecoderStats decoderStats = emu->GetVideoDecoder()->GetStats();
+	ss = std::stringstream();
+	ss << "Filter: " << std::fixed << std::setprecision(2) << decoderStats.AverageScaleFilterTime << " ms (" << decoderStats.ScaleFilterThreads << "T)";
+	hud->DrawString(10, 100, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+	DisplayTimings(emu, startFrame);
+}
+
+void DebugStats::DisplayTimings(Emulator* emu, int startFrame)
+{
+	DebugHud* hud = emu->GetDebugHud();
+	PerformanceCounters* counters = emu->GetPerformanceCounters();
+
+	vector<std::pair<PerfCounterType, PerfCounterFrameStats>> timings;
+	for(int i = 0; i < PerformanceCounters::CounterCount; i++) {
+		PerfCounterFrameStats stats = counters->GetFrameStats((PerfCounterType)i);
+		if(stats.SampleCount > 0) {
+			timings.push_back({ (PerfCounterType)i, stats });
+		}
+	}
+
+	if(timings.empty()) {
+		return;
+	}
+
+	int height = 13 + (int)timings.size() * 9;
+	hud->DrawRectangle(8, 114, 243, height, 0x40000000, true, 1, startFrame);
+	hud->DrawRectangle(8, 114, 243, height, 0xFFFFFF, false, 1, startFrame);
+	hud->DrawString(10, 116, "Timings (ms per frame)", 0xFFFFFF, 0xFF000000, 1, startFrame);
+	const char* columns[4] = { "Avg", "P50", "P99", "Max" };
+	for(int i = 0; i < 4; i++) {
+		hud->DrawString(130 + i * 30, 116, columns[i], 0xFFFFFF, 0xFF000000, 1, startFrame);
+	}
+
+	double expectedFrameDelay = 1000 / emu->GetFps();
+	int y = 127;
+	for(auto& timing : timings) {
+		PerfCounterFrameStats& stats = timing.second;
+		hud->DrawString(10, y, PerformanceCounters::GetCounterName(timing.first), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+		//Highlight stages that take longer than a frame (except for the ones that include the wait for the next frame)
+		bool includesWait = timing.first == PerfCounterType::Frame || timing.first == PerfCounterType::RunFrame || timing.first == PerfCounterType::FrameWait;
+
+		double values[4] = { stats.Average, stats.P50, stats.P99, stats.Max };
+		for(int i = 0; i < 4; i++) {
+			int color = (!includesWait && values[i] > expectedFrameDelay) ? 0xFF0000 : 0xFFFFFF;
+			std::stringstream ss;
+			ss << std::fixed << std::setprecision(2) << values[i];
+			hud->DrawString(130 + i * 30, y, ss.str(), color, 0xFF000000, 1, startFrame);
+		}
+		y += 9;
+	}
 }
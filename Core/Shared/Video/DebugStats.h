@@ -11,6 +11,8 @@ private:
 	double _lastFrameMin = 9999;
 	double _lastFrameMax = 0;
 
+	void DisplayTimings(Emulator* emu, int startFrame);
+
 public:
 	void DisplayStats(Emulator *emu, double lastFrameTime);
 };
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "Shared/Video/DrawCommandBuffer.h"
+#include "Shared/Video/DrawCommand.h"
+
+DrawCommandBuffer::DrawCommandBuffer()
+{
+	_writePos = 0;
+	_writerCount = 0;
+	for(uint32_t i = 0; i < DrawCommandBuffer::MaxBlockCount; i++) {
+		_blocks[i] = nullptr;
+	}
+}
+
+DrawCommandBuffer::~DrawCommandBuffer()
+{
+	for(uint32_t i = 0; i < DrawCommandBuffer::MaxBlockCount; i++) {
+		delete[] _blocks[i].load();
+	}
+}
+
+uint8_t* DrawCommandBuffer::GetBlock(uint32_t index)
+{
+	uint8_t* block = _blocks[index];
+	if(!block) {
+		auto lock = _blockLock.AcquireSafe();
+		block = _blocks[index];
+		if(!block) {
+			block = new uint8_t[DrawCommandBuffer::BlockSize];
+			_blocks[index] = block;
+		}
+	}
+	return block;
+}
+
+DrawCommandBuffer::EntryHeader* DrawCommandBuffer::AllocateEntry(uint32_t size)
+{
+	//Keep all entries aligned on 8 bytes
+	size = (size + sizeof(EntryHeader) + 7) & ~7;
+
+	uint64_t pos = _writePos;
+	uint64_t start;
+	uint64_t end;
+	do {
+		start = pos;
+		if((start % DrawCommandBuffer::BlockSize) + size > DrawCommandBuffer::BlockSize) {
+			//Entries can't cross block boundaries, start at the beginning of the next block
+			start = (start / DrawCommandBuffer::BlockSize + 1) * DrawCommandBuffer::BlockSize;
+		}
+		end = start + size;
+		if(end > DrawCommandBuffer::MaxSize) {
+			return nullptr;
+		}
+	} while(!_writePos.compare_exchange_weak(pos, end));
+
+	if(start != pos) {
+		//Mark the end of the previous block as unused
+		EntryHeader* unused = (EntryHeader*)(GetBlock((uint32_t)(pos / DrawCommandBuffer::BlockSize)) + (pos % DrawCommandBuffer::BlockSize));
+		unused->Size = (uint32_t)(start - pos);
+		unused->Type = EntryType::Unused;
+	}
+
+	EntryHeader* header = (EntryHeader*)(GetBlock((uint32_t)(start / DrawCommandBuffer::BlockSize)) + (start % DrawCommandBuffer::BlockSize));
+	header->Size = size;
+	return header;
+}
+
+void* DrawCommandBuffer::Allocate(uint32_t size)
+{
+	if(size > DrawCommandBuffer::BlockSize / 4) {
+		//Large commands (e.g screen buffers) are allocated separately to avoid wasting space in the blocks
+		EntryHeader* header = AllocateEntry(sizeof(uint8_t*));
+		if(!header) {
+			return nullptr;
+		}
+
+		uint8_t* data = new uint8_t[size];
+		{
+			auto lock = _blockLock.AcquireSafe();
+			_largeAllocations.push_back(unique_ptr<uint8_t[]>(data));
+		}
+		*(uint8_t**)(header + 1) = data;
+		header->Type = EntryType::LargeCommand;
+		return data;
+	}
+
+	EntryHeader* header = AllocateEntry(size);
+	if(!header) {
+		return nullptr;
+	}
+	header->Type = EntryType::Command;
+	return header + 1;
+}
+
+void DrawCommandBuffer::WaitForWriters()
+{
+	while(_writerCount > 0) {
+		std::this_thread::yield();
+	}
+}
+
+void DrawCommandBuffer::GetCommands(vector<DrawCommand*>& commands)
+{
+	uint64_t end = _writePos;
+	uint64_t pos = 0;
+	while(pos < end) {
+		EntryHeader* header = (EntryHeader*)(_blocks[pos / DrawCommandBuffer::BlockSize].load() + (pos % DrawCommandBuffer::BlockSize));
+		if(header->Type == EntryType::Command) {
+			commands.push_back((DrawCommand*)(header + 1));
+			LiveCommandCount++;
+		} else if(header->Type == EntryType::LargeCommand) {
+			commands.push_back((DrawCommand*)*(uint8_t**)(header + 1));
+			LiveCommandCount++;
+		}
+		pos += header->Size;
+	}
+}
+
+void DrawCommandBuffer::Reset()
+{
+	_largeAllocations.clear();
+	_writePos = 0;
+	LiveCommandCount = 0;
+}
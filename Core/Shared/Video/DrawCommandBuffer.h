@@ -0,0 +1,60 @@
+#pragma once
+#include "pch.h"
+#include "Utilities/SimpleLock.h"
+
+class DrawCommand;
+
+//Arena that stores the draw commands added to a HUD during a frame
+//Any number of threads can allocate commands at the same time without locking (a lock is only
+//used when a new block of memory needs to be allocated, which rarely happens since blocks are reused)
+class DrawCommandBuffer
+{
+private:
+	static constexpr uint32_t BlockSize = 0x40000;
+	static constexpr uint32_t MaxBlockCount = 256; //64 MB
+	static constexpr uint64_t MaxSize = (uint64_t)DrawCommandBuffer::BlockSize * DrawCommandBuffer::MaxBlockCount;
+
+	enum class EntryType : uint32_t
+	{
+		Unused, //Unused space at the end of a block
+		Command,
+		LargeCommand //Command is too large to fit in a block, the entry contains a pointer to the command
+	};
+
+	struct EntryHeader
+	{
+		uint32_t Size; //Includes the header
+		EntryType Type;
+	};
+
+	atomic<uint8_t*> _blocks[DrawCommandBuffer::MaxBlockCount];
+	vector<unique_ptr<uint8_t[]>> _largeAllocations;
+	SimpleLock _blockLock;
+
+	atomic<uint64_t> _writePos;
+	atomic<uint32_t> _writerCount;
+
+	uint8_t* GetBlock(uint32_t index);
+	EntryHeader* AllocateEntry(uint32_t size);
+
+public:
+	//Number of commands in the buffer that haven't expired yet (only used by the thread that draws the HUD)
+	uint32_t LiveCommandCount = 0;
+
+	DrawCommandBuffer();
+	~DrawCommandBuffer();
+
+	//Returns nullptr when the buffer is full
+	void* Allocate(uint32_t size);
+
+	//Writers must call BeginWrite/EndWrite around Allocate and the construction of the command
+	void BeginWrite() { _writerCount++; }
+	void EndWrite() { _writerCount--; }
+	void WaitForWriters();
+
+	bool HasCommands() { return _writePos > 0; }
+
+	//Only valid once all writers are done (e.g after WaitForWriters)
+	void GetCommands(vector<DrawCommand*>& commands);
+	void Reset();
+};
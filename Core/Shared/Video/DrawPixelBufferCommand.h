@@ -0,0 +1,34 @@
+#pragma once
+#include "pch.h"
+#include "Shared/Video/DrawCommand.h"
+
+//Draws a block of pixels - the pixels are stored right after the command (see DebugHud::DrawPixels)
+class DrawPixelBufferCommand : public DrawCommand
+{
+private:
+	int _x, _y, _width, _height;
+
+	uint32_t* GetPixels() { return (uint32_t*)(this + 1); }
+
+protected:
+	void InternalDraw()
+	{
+		uint32_t* pixels = GetPixels();
+		for(int j = 0; j < _height; j++) {
+			for(int i = 0; i < _width; i++) {
+				DrawPixel(_x + i, _y + j, pixels[j * _width + i]);
+			}
+		}
+	}
+
+public:
+	DrawPixelBufferCommand(int x, int y, int width, int height, uint32_t* pixels, int frameCount, int startFrame) :
+		DrawCommand(startFrame, frameCount), _x(x), _y(y), _width(width), _height(height)
+	{
+		//Invert alpha byte - 0 = opaque, 255 = transparent (same as DrawPixelCommand)
+		uint32_t* dst = GetPixels();
+		for(int i = 0, len = width * height; i < len; i++) {
+			dst[i] = (~pixels[i] & 0xFF000000) | (pixels[i] & 0xFFFFFF);
+		}
+	}
+};
@@ -2,13 +2,15 @@
 #include "pch.h"
 #include "Shared/Video/DrawCommand.h"
 
+//The screen buffer is stored right after the command (see DebugHud::DrawScreenBuffer)
 class DrawScreenBufferCommand : public DrawCommand
 {
 private:
-	uint32_t* _screenBuffer = nullptr;
 	uint32_t _width = 0;
 	uint32_t _height = 0;
 
+	uint32_t* GetScreenBuffer() { return (uint32_t*)(this + 1); }
+
 protected:
 	void InternalDraw()
 	{
@@ -16,27 +18,18 @@ protected:
 		int left = (int)_overscan.Left;
 		int width = _frameInfo.Width;
 		int srcOffset = top * _width + left;
+		uint32_t* screenBuffer = GetScreenBuffer();
 
 		for(uint32_t y = 0; y < _frameInfo.Height; y++) {
-			memcpy(_argbBuffer + y * _frameInfo.Width, _screenBuffer + srcOffset + y * _width, width * sizeof(uint32_t));
+			memcpy(_argbBuffer + y * _frameInfo.Width, screenBuffer + srcOffset + y * _width, width * sizeof(uint32_t));
 		}
 	}
 
 public:
-	DrawScreenBufferCommand(uint32_t width, uint32_t height, int startFrame) : DrawCommand(startFrame, 1, false, true)
+	DrawScreenBufferCommand(uint32_t* screenBuffer, uint32_t width, uint32_t height, int startFrame) : DrawCommand(startFrame, 1, false, true)
 	{
 		_width = width;
 		_height = height;
-		_screenBuffer = new uint32_t[width * height];
-	}
-
-	void SetPixel(int index, uint32_t color)
-	{
-		_screenBuffer[index] = color;
-	}
-
-	virtual ~DrawScreenBufferCommand()
-	{
-		delete[] _screenBuffer;
+		memcpy(GetScreenBuffer(), screenBuffer, width * height * sizeof(uint32_t));
 	}
 };
@@ -4,6 +4,8 @@
 #include "Utilities/HQX/hqx.h"
 #include "Utilities/Scale2x/scalebit.h"
 #include "Utilities/KreedSaiEagle/SaiEagle.h"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/Timer.h"
 
 bool ScaleFilter::_hqxInitDone = false;
 
@@ -28,11 +30,12 @@ uint32_t ScaleFilter::GetScale()
 	return _filterScale;
 }
 
-void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer)
+void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast)
 {
-	uint32_t* outputBuffer = _outputBuffer;
+	uint32_t* outputBuffer = _outputBuffer + yFirst * _width * _filterScale * _filterScale;
+	inputArgbBuffer += yFirst * _width;
 
-	for(uint32_t y = 0; y < _height; y++) {
+	for(uint32_t y = yFirst; y < yLast; y++) {
 		for(uint32_t x = 0; x < _width; x++) {
 			for(uint32_t i = 0; i < _filterScale; i++) {
 				*(outputBuffer++) = *inputArgbBuffer;
@@ -53,32 +56,96 @@ void ScaleFilter::UpdateOutputBuffer(uint32_t width, uint32_t height)
 		_width = width;
 		_height = height;
 		_outputBuffer = new uint32_t[_width*_height*_filterScale*_filterScale];
+		if(_scaleFilterType == ScaleFilterType::Scale2x && _filterScale == 4) {
+			_scale4xBuffer.resize(_width*_height*4);
+		}
 	}
 }
 
-uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height)
+void ScaleFilter::ApplyFilterToRows(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast)
 {
-	UpdateOutputBuffer(width, height);
+	//Processes source rows [yFirst, yLast) - safe to call from multiple threads for different rows
+	uint32_t width = _width;
+	uint32_t height = _height;
 
 	if(_scaleFilterType == ScaleFilterType::xBRZ) {
-		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB);
+		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB, xbrz::ScalerCfg(), yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::HQX) {
-		hqx(_filterScale, inputArgbBuffer, _outputBuffer, width, height);
+		hqx(_filterScale, inputArgbBuffer, _outputBuffer, width, height, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Scale2x) {
-		scale(_filterScale, _outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height);
+		scale_slice(_filterScale, _outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::_2xSai) {
-		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Super2xSai) {
-		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::SuperEagle) {
-		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale, yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Prescale) {
-		ApplyPrescaleFilter(inputArgbBuffer);
+		ApplyPrescaleFilter(inputArgbBuffer, yFirst, yLast);
+	}
+}
+
+void ScaleFilter::RunBands(ThreadPool* threadPool, uint32_t height, const std::function<void(uint32_t, uint32_t)>& func)
+{
+	uint32_t bandCount = 1;
+	if(threadPool && threadPool->GetThreadCount() > 1) {
+		//Use more bands than threads to balance the load when some bands take longer than others
+		bandCount = std::max<uint32_t>(1, std::min(threadPool->GetThreadCount() * 2, height / ScaleFilter::MinBandHeight));
 	}
 
+	_lastBandCount = bandCount;
+	if(bandCount == 1) {
+		func(0, height);
+		return;
+	}
+
+	threadPool->ParallelFor(bandCount, [=](uint32_t band) {
+		func(height * band / bandCount, height * (band + 1) / bandCount);
+	});
+}
+
+uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, ThreadPool* threadPool)
+{
+	Timer timer;
+	UpdateOutputBuffer(width, height);
+
+	if(_scaleFilterType == ScaleFilterType::Scale2x && _filterScale == 4) {
+		//Scale4x is Scale2x applied twice - run both passes in bands, with the intermediate result in a separate buffer
+		uint32_t* buffer = _scale4xBuffer.data();
+		RunBands(threadPool, height, [=](uint32_t yFirst, uint32_t yLast) {
+			scale_slice(2, buffer, width*sizeof(uint32_t)*2, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height, yFirst, yLast);
+		});
+		RunBands(threadPool, height * 2, [=](uint32_t yFirst, uint32_t yLast) {
+			scale_slice(2, _outputBuffer, width*sizeof(uint32_t)*4, buffer, width*sizeof(uint32_t)*2, 4, width * 2, height * 2, yFirst, yLast);
+		});
+	} else {
+		RunBands(threadPool, height, [=](uint32_t yFirst, uint32_t yLast) {
+			ApplyFilterToRows(inputArgbBuffer, yFirst, yLast);
+		});
+	}
+
+	_frameTimes[_frameTimeIndex] = timer.GetElapsedMS();
+	_frameTimeIndex = (_frameTimeIndex + 1) % 60;
+	_frameTimeCount = std::min<uint32_t>(_frameTimeCount + 1, 60);
+
 	return _outputBuffer;
 }
 
+ScaleFilterStats ScaleFilter::GetStats()
+{
+	ScaleFilterStats stats = {};
+	if(_frameTimeCount > 0) {
+		double total = 0;
+		for(uint32_t i = 0; i < _frameTimeCount; i++) {
+			total += _frameTimes[i];
+		}
+		stats.LastFrameTime = _frameTimes[(_frameTimeIndex + 59) % 60];
+		stats.AverageFrameTime = total / _frameTimeCount;
+	}
+	stats.BandCount = _lastBandCount;
+	return stats;
+}
+
 unique_ptr<ScaleFilter> ScaleFilter::GetScaleFilter(VideoFilterType filter)
 {
 	unique_ptr<ScaleFilter> scaleFilter;
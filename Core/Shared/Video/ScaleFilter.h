@@ -1,19 +1,40 @@
 #pragma once
 
 #include "pch.h"
+#include <functional>
 #include "Shared/SettingTypes.h"
 
+class ThreadPool;
+
+struct ScaleFilterStats
+{
+	double LastFrameTime; //ms
+	double AverageFrameTime; //ms, over the last 60 frames
+	uint32_t BandCount; //Number of bands the last frame was split into
+};
+
 class ScaleFilter
 {
 private:
+	//Smallest band processed by a thread, in source rows (xBRZ and HQX re-read the rows around each band)
+	static constexpr uint32_t MinBandHeight = 16;
+
 	static bool _hqxInitDone;
 	uint32_t _filterScale;
 	ScaleFilterType _scaleFilterType;
 	uint32_t *_outputBuffer = nullptr;
+	vector<uint32_t> _scale4xBuffer;
 	uint32_t _width = 0;
 	uint32_t _height = 0;
 
-	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer);
+	double _frameTimes[60] = {};
+	uint32_t _frameTimeIndex = 0;
+	uint32_t _frameTimeCount = 0;
+	uint32_t _lastBandCount = 0;
+
+	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast);
+	void ApplyFilterToRows(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast);
+	void RunBands(ThreadPool* threadPool, uint32_t height, const std::function<void(uint32_t, uint32_t)>& func);
 	void UpdateOutputBuffer(uint32_t width, uint32_t height);
 
 public:
@@ -21,8 +42,9 @@ public:
 	~ScaleFilter();
 
 	uint32_t GetScale();
-	uint32_t* ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height);
+	uint32_t* ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, ThreadPool* threadPool = nullptr);
 	FrameInfo GetFrameInfo(FrameInfo baseFrameInfo);
+	ScaleFilterStats GetStats();
 
 	static unique_ptr<ScaleFilter> GetScaleFilter(VideoFilterType filter);
 };
\ No newline at end of file
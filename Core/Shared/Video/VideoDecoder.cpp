@@ -16,11 +16,16 @@
 #include "Shared/RenderedFrame.h"
 #include "Shared/Video/SystemHud.h"
 #include "SNES/CartTypes.h"
+#include "Utilities/ThreadPool.h"
+#include "Shared/PerformanceCounters.h"
 
 VideoDecoder::VideoDecoder(Emulator* emu)
 {
 	_emu = emu;
-	_frameChanged = false;
+	_mailbox = 1;
+	_decoding = false;
+	_droppedFrames = 0;
+	_lateFrames = 0;
 	_stopFlag = false;
 	_baseFrameSize = { 256, 239 };
 	_lastFrameSize = _baseFrameSize;
@@ -80,6 +85,27 @@ void VideoDecoder::UpdateVideoFilter()
 		_forceFilterUpdate = false;
 	}
 
+	if(_scaleFilter) {
+		uint32_t threadCount = _emu->GetSettings()->GetVideoConfig().FilterThreadCount;
+		if(threadCount == 0) {
+			threadCount = ThreadPool::GetDefaultThreadCount();
+		}
+		if(!_filterThreadPool || _filterThreadPool->GetThreadCount() != threadCount) {
+			_filterThreadPool.reset(new ThreadPool(threadCount));
+
+			auto lock = _statsLock.AcquireSafe();
+			_scaleFilterThreads = threadCount;
+		}
+	} else if(_filterThreadPool) {
+		//No scale filter, stop the worker threads
+		_filterThreadPool.reset();
+
+		auto lock = _statsLock.AcquireSafe();
+		_scaleFilterThreads = 0;
+		_scaleFilterTime = 0;
+		_averageScaleFilterTime = 0;
+	}
+
 	uint32_t screenRotation = _emu->GetSettings()->GetVideoConfig().ScreenRotation;
 	if(screenRotation != 0) {
 		if(!_rotateFilter || _rotateFilter->GetAngle() != screenRotation) {
@@ -92,6 +118,7 @@ void VideoDecoder::UpdateVideoFilter()
 
 void VideoDecoder::DecodeFrame(bool forRewind)
 {
+	PERF_TIMER(_emu->GetPerformanceCounters(), DecodeFrame);
 	UpdateVideoFilter();
 
 	bool isAudioPlayer = _emu->GetAudioPlayerHud() != nullptr;
@@ -123,8 +150,13 @@ void VideoDecoder::DecodeFrame(bool forRewind)
 	_emu->GetDebugHud()->Draw(outputBuffer, frameSize, overscan, _frame.FrameNumber, true);
 
 	if(_scaleFilter && !isAudioPlayer) {
-		outputBuffer = _scaleFilter->ApplyFilter(outputBuffer, frameSize.Width, frameSize.Height);
+		outputBuffer = _scaleFilter->ApplyFilter(outputBuffer, frameSize.Width, frameSize.Height, _filterThreadPool.get());
 		frameSize = _scaleFilter->GetFrameInfo(frameSize);
+
+		ScaleFilterStats filterStats = _scaleFilter->GetStats();
+		auto lock = _statsLock.AcquireSafe();
+		_scaleFilterTime = filterStats.LastFrameTime;
+		_averageScaleFilterTime = filterStats.AverageFrameTime;
 	}
 
 	if(!isAudioPlayer) {
@@ -143,8 +175,6 @@ void VideoDecoder::DecodeFrame(bool forRewind)
 	
 	//Rewind manager will take care of sending the correct frame to the video renderer
 	_emu->GetRewindManager()->SendFrame(convertedFrame, forRewind);
-
-	_frameChanged = false;
 }
 
 void VideoDecoder::DecodeThread()
@@ -152,15 +182,78 @@ void VideoDecoder::DecodeThread()
 	//This thread will decode the PPU's output (color ID to RGB, intensify r/g/b and produce a HD version of the frame if needed)
 	while(!_stopFlag.load()) {
 		//DecodeFrame returns the final ARGB frame we want to display in the emulator window
-		while(!_frameChanged) {
+		while(!(_mailbox & VideoDecoder::NewFrameFlag)) {
 			_waitForFrame.Wait();
 			if(_stopFlag.load()) {
 				return;
 			}
 		}
 
+		//Swap the read slot with the slot containing the most recent frame
+		_decoding = true;
+		_readSlot = _mailbox.exchange(_readSlot) & VideoDecoder::SlotMask;
+		_frame = _slots[_readSlot].Frame;
 		DecodeFrame();
+
+		{
+			std::lock_guard<std::mutex> lock(_idleLock);
+			_decoding = false;
+		}
+		_idleSignal.notify_all();
+	}
+}
+
+bool VideoDecoder::IsDecodeThreadIdle()
+{
+	//Check the mailbox first - _decoding is always set before the new frame flag is cleared
+	return !(_mailbox & VideoDecoder::NewFrameFlag) && !_decoding;
+}
+
+void VideoDecoder::WaitForDecodeThread()
+{
+	//Wait until the decode thread has processed all frames sent to it
+	std::unique_lock<std::mutex> lock(_idleLock);
+	_idleSignal.wait(lock, [this] { return IsDecodeThreadIdle() || !_decodeThread || _stopFlag; });
+}
+
+void VideoDecoder::PostFrame(RenderedFrame& frame)
+{
+	//Copy the frame into the write slot - the PPU's buffer will be overwritten while the frame is being decoded
+	DecoderFrameSlot& slot = _slots[_writeSlot];
+	//Some consoles' buffers don't match the frame's dimensions (e.g PCE), copy the whole buffer when its size is specified
+	uint32_t pixelCount = frame.BufferSize ? frame.BufferSize : frame.Width * frame.Height;
+	if(slot.Buffer.size() < pixelCount) {
+		slot.Buffer.resize(pixelCount);
+	}
+	memcpy(slot.Buffer.data(), frame.FrameBuffer, pixelCount * sizeof(uint16_t));
+	slot.Frame = frame;
+	slot.Frame.FrameBuffer = slot.Buffer.data();
+
+	if(_decoding) {
+		_lateFrames++;
+	}
+
+	uint32_t prevSlot = _mailbox.exchange(_writeSlot | VideoDecoder::NewFrameFlag);
+	if(prevSlot & VideoDecoder::NewFrameFlag) {
+		//The previous frame was never picked up by the decode thread, drop it
+		_droppedFrames++;
 	}
+	_writeSlot = prevSlot & VideoDecoder::SlotMask;
+
+	_waitForFrame.Signal();
+}
+
+VideoDecoderStats VideoDecoder::GetStats()
+{
+	VideoDecoderStats stats = {};
+	stats.DroppedFrames = _droppedFrames;
+	stats.LateFrames = _lateFrames;
+
+	auto lock = _statsLock.AcquireSafe();
+	stats.ScaleFilterTime = _scaleFilterTime;
+	stats.AverageScaleFilterTime = _averageScaleFilterTime;
+	stats.ScaleFilterThreads = _scaleFilterThreads;
+	return stats;
 }
 
 uint32_t VideoDecoder::GetFrameCount()
@@ -174,22 +267,21 @@ void VideoDecoder::UpdateFrame(RenderedFrame frame, bool sync, bool forRewind)
 		return;
 	}
 
-	if(_frameChanged) {
-		//Last frame isn't done decoding yet - sometimes Signal() introduces a 25-30ms delay
-		while(_frameChanged) {
-			//Spin until decode is done
-		}
-		//At this point, we are sure that the decode thread is no longer busy
+	if(sync || frame.Data || _emu->GetVideoRenderer()->IsRecording()) {
+		//Synchronous decoding uses the same filters as the decode thread, so it must be idle.
+		//HD pack frames also need to wait, since the screen info they point to is owned by the PPU
+		//and is only double-buffered (it can't be copied into the slot like the frame buffer)
+		//Frames are never dropped while recording, otherwise the video would drift out of sync with the audio
+		WaitForDecodeThread();
 	}
 
 	_emu->OnBeforeSendFrame();
 
-	_frame = frame;
 	if(sync) {
+		_frame = frame;
 		DecodeFrame(forRewind);
 	} else {
-		_frameChanged = true;
-		_waitForFrame.Signal();
+		PostFrame(frame);
 	}
 	_frameCount++;
 }
@@ -202,7 +294,10 @@ void VideoDecoder::StartThread()
 		UpdateVideoFilter();
 		_videoFilter->SetBaseFrameInfo(_baseFrameSize);
 		_stopFlag = false;
-		_frameChanged = false;
+		_writeSlot = 0;
+		_mailbox = 1;
+		_readSlot = 2;
+		_decoding = false;
 		_frameCount = 0;
 		_waitForFrame.Reset();
 		
@@ -215,7 +310,11 @@ void VideoDecoder::StartThread()
 void VideoDecoder::StopThread()
 {
 	auto lock = _stopStartLock.AcquireSafe();
-	_stopFlag = true;
+	{
+		std::lock_guard<std::mutex> idleLock(_idleLock);
+		_stopFlag = true;
+	}
+	_idleSignal.notify_all();
 	if(_decodeThread) {
 		_waitForFrame.Signal();
 		_decodeThread->join();
@@ -7,13 +7,36 @@
 
 class BaseVideoFilter;
 class ScaleFilter;
+class ThreadPool;
 class RotateFilter;
 class IRenderingDevice;
 class Emulator;
 
+struct VideoDecoderStats
+{
+	uint32_t DroppedFrames; //Frames replaced by a newer frame before the decode thread could process them
+	uint32_t LateFrames; //Frames sent while the decode thread was still busy with the previous frame
+
+	double ScaleFilterTime; //Time taken by the scale filter (xBRZ, HQX, etc.) for the last frame, in ms
+	double AverageScaleFilterTime; //Same, averaged over the last 60 frames
+	uint32_t ScaleFilterThreads;
+};
+
+struct DecoderFrameSlot
+{
+	vector<uint16_t> Buffer;
+	RenderedFrame Frame;
+};
+
 class VideoDecoder
 {
 private:
+	//Triple buffering between the emulation thread and the decode thread:
+	//the emulation thread owns _writeSlot, the decode thread owns _readSlot, and
+	//_mailbox holds the third slot's index (+ a flag when it contains a new frame)
+	static constexpr uint32_t NewFrameFlag = 0x04;
+	static constexpr uint32_t SlotMask = 0x03;
+
 	Emulator* _emu;
 
 	ConsoleType _consoleType = ConsoleType::Snes;
@@ -22,8 +45,19 @@ private:
 
 	SimpleLock _stopStartLock;
 	AutoResetEvent _waitForFrame;
+
+	//Signaled by the decode thread when it becomes idle (see WaitForDecodeThread)
+	std::mutex _idleLock;
+	std::condition_variable _idleSignal;
 	
-	atomic<bool> _frameChanged;
+	DecoderFrameSlot _slots[3];
+	uint32_t _writeSlot = 0;
+	uint32_t _readSlot = 2;
+	atomic<uint32_t> _mailbox;
+	atomic<bool> _decoding;
+	atomic<uint32_t> _droppedFrames;
+	atomic<uint32_t> _lateFrames;
+
 	atomic<bool> _stopFlag;
 	uint32_t _frameCount = 0;
 	bool _forceFilterUpdate = false;
@@ -38,10 +72,19 @@ private:
 	unique_ptr<BaseVideoFilter> _videoFilter;
 	unique_ptr<ScaleFilter> _scaleFilter;
 	unique_ptr<RotateFilter> _rotateFilter;
+	unique_ptr<ThreadPool> _filterThreadPool;
+
+	SimpleLock _statsLock;
+	double _scaleFilterTime = 0;
+	double _averageScaleFilterTime = 0;
+	uint32_t _scaleFilterThreads = 0;
 
 	void UpdateVideoFilter();
 
 	void DecodeThread();
+	bool IsDecodeThreadIdle();
+	void WaitForDecodeThread();
+	void PostFrame(RenderedFrame& frame);
 
 public:
 	VideoDecoder(Emulator* console);
@@ -61,6 +104,7 @@ public:
 	double GetLastFrameScale() { return _frame.Scale; }
 
 	void UpdateFrame(RenderedFrame frame, bool sync, bool forRewind);
+	VideoDecoderStats GetStats();
 
 	bool IsRunning();
 	void StartThread();
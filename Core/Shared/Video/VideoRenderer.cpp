@@ -11,6 +11,7 @@
 #include "Utilities/Video/IVideoRecorder.h"
 #include "Utilities/Video/AviRecorder.h"
 #include "Utilities/Video/GifRecorder.h"
+#include "Shared/PerformanceCounters.h"
 
 VideoRenderer::VideoRenderer(Emulator* emu)
 {
@@ -73,6 +74,7 @@ void VideoRenderer::RenderThread()
 		//Wait until a frame is ready, or until 32ms have passed (to allow HUD to update at ~30fps when paused)
 		_waitForRender.Wait(32);
 		if(_renderer) {
+			PERF_TIMER(_emu->GetPerformanceCounters(), Render);
 			FrameInfo size = _emu->GetVideoDecoder()->GetBaseFrameInfo(true);
 			_scriptHudSurface.UpdateSize(size.Width * _scriptHudScale, size.Height * _scriptHudScale);
 
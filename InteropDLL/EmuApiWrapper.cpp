@@ -11,6 +11,7 @@
 #include "Core/Shared/ShortcutKeyHandler.h"
 #include "Core/Shared/TimingInfo.h"
 #include "Core/Shared/CheatManager.h"
+#include "Core/Shared/PerformanceCounters.h"
 #include "Core/Shared/DebuggerRequest.h"
 #include "Core/Netplay/GameClient.h"
 #include "Core/Netplay/GameServer.h"
@@ -277,6 +278,11 @@ extern "C" {
 	DllExport void __stdcall LoadRecentGame(char* filepath, bool resetGame) { _emu->GetSaveStateManager()->LoadRecentGame(filepath, resetGame); }
 	DllExport int32_t __stdcall GetSaveStatePreview(char* saveStatePath, uint8_t* pngData) { return _emu->GetSaveStateManager()->GetSaveStatePreview(saveStatePath, pngData); }
 
+	DllExport void __stdcall SetPerformanceCountersEnabled(bool enabled) { _emu->GetPerformanceCounters()->SetEnabled(enabled); }
+	DllExport PerfCounterFrameStats __stdcall GetPerformanceCounterStats(PerfCounterType type) { return _emu->GetPerformanceCounters()->GetFrameStats(type); }
+	DllExport void __stdcall StartPerformanceTrace() { _emu->GetPerformanceCounters()->StartTrace(); }
+	DllExport bool __stdcall StopPerformanceTrace(char* filename) { return _emu->GetPerformanceCounters()->StopTrace(filename); }
+
 	class PgoKeyManager : public IKeyManager
 	{
 	public:
@@ -4,11 +4,12 @@
 #include "Core/Netplay/ClientConnectionData.h"
 #include "Core/Netplay/GameServer.h"
 #include "Core/Netplay/GameClient.h"
+#include "Core/Netplay/GameConnection.h"
 
 extern unique_ptr<Emulator> _emu;
 
 extern "C" {
-	DllExport void __stdcall StartServer(uint16_t port, char* password) { _emu->GetGameServer()->StartServer(port, password); }
+	DllExport void __stdcall StartServer(uint16_t port, char* password, bool rollback) { _emu->GetGameServer()->StartServer(port, password, rollback); }
 	DllExport void __stdcall StopServer() { _emu->GetGameServer()->StopServer(); }
 	DllExport bool __stdcall IsServerRunning() { return _emu->GetGameServer()->Started(); }
 
@@ -19,6 +20,9 @@ extern "C" {
 	}
 
 	DllExport void __stdcall Disconnect() { _emu->GetGameClient()->Disconnect(); }
+
+	//Delays received netplay messages, to test netplay with a local connection
+	DllExport void __stdcall NetPlaySetSimulatedLatency(uint32_t latency, uint32_t jitter) { GameConnection::SetSimulatedLatency(latency, jitter); }
 	DllExport bool __stdcall IsConnected() { return _emu->GetGameClient()->Connected(); }
 
 	DllExport void __stdcall NetPlayGetControllerList(NetplayControllerUsageInfo* list, int32_t& length)
@@ -1,25 +1,103 @@
 #include "Common.h"
 #include "Core/Shared/RecordedRomTest.h"
 #include "Core/Shared/Emulator.h"
+#include "Core/Shared/EmuSettings.h"
+#include "Core/Shared/PerformanceCounters.h"
+#include "Core/Shared/Movies/MovieManager.h"
+#include "Utilities/Timer.h"
+#include "Utilities/FolderUtilities.h"
+#include "Utilities/ThreadPool.h"
 
 extern unique_ptr<Emulator> _emu;
 shared_ptr<RecordedRomTest> _recordedRomTest;
 
+static RomTestResult RunBackgroundTest(string filename, uint32_t timeoutSeconds)
+{
+	//Each test runs in its own emulator instance, which allows running multiple tests at once
+	unique_ptr<Emulator> emu(new Emulator());
+	emu->Initialize(false);
+	shared_ptr<RecordedRomTest> romTest(new RecordedRomTest(emu.get(), true));
+	RomTestResult result = romTest->Run(filename, timeoutSeconds);
+	emu->Release();
+	return result;
+}
+
 extern "C"
 {
 	DllExport RomTestResult __stdcall RunRecordedTest(char* filename, bool inBackground)
 	{
 		if(inBackground) {
-			unique_ptr<Emulator> emu(new Emulator());
-			emu->Initialize();
-			shared_ptr<RecordedRomTest> romTest(new RecordedRomTest(emu.get(), true));
-			return romTest->Run(filename);
+			return RunBackgroundTest(filename, 0);
 		} else {
 			shared_ptr<RecordedRomTest> romTest(new RecordedRomTest(_emu.get(), false));
 			return romTest->Run(filename);
 		}
 	}
 
+	//Used by the TestHelper command line tool - runs up to threadCount tests at once (0 = based on the number of cores)
+	DllExport void __stdcall RunRecordedTests(vector<string> testFiles, string homeFolder, uint32_t threadCount, uint32_t timeoutSeconds, vector<RomTestResult>& results)
+	{
+		FolderUtilities::SetHomeFolder(homeFolder);
+
+		results.clear();
+		results.resize(testFiles.size(), RomTestResult {});
+
+		//Emulators run on their own thread, the pool's threads only wait for the tests to end
+		ThreadPool pool(threadCount > 0 ? threadCount : std::max<uint32_t>(1, std::thread::hardware_concurrency()));
+		pool.ParallelFor((uint32_t)testFiles.size(), [&](uint32_t i) {
+			results[i] = RunBackgroundTest(testFiles[i], timeoutSeconds);
+		});
+	}
+
+	//Runs the rom (and movie, if specified) for frameCount frames as fast as possible, without audio or video output
+	DllExport bool __stdcall RunBenchmark(string romFile, string movieFile, uint32_t frameCount, string homeFolder, BenchmarkResult& result)
+	{
+		FolderUtilities::SetHomeFolder(homeFolder);
+		result = {};
+
+		unique_ptr<Emulator> emu(new Emulator());
+		emu->Initialize(false);
+
+		PerformanceCounters* counters = emu->GetPerformanceCounters();
+
+		emu->Lock();
+		if(!emu->LoadRom(VirtualFile(romFile), VirtualFile())) {
+			emu->Unlock();
+			emu->Release();
+			return false;
+		}
+
+		if(!movieFile.empty()) {
+			emu->GetMovieManager()->Play(VirtualFile(movieFile), true);
+		}
+		emu->GetSettings()->SetFlag(EmulationFlags::MaximumSpeed);
+
+		//The performance counters only add a breakdown of the time spent (they are empty when they are disabled at compile time)
+		counters->Reset();
+		counters->SetEnabled(true);
+		uint32_t startFrame = emu->GetFrameCount();
+		Timer timer;
+		emu->Unlock();
+
+		while(emu->IsRunning() && emu->GetFrameCount() - startFrame < frameCount) {
+			std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(5));
+		}
+
+		{
+			//Pause the emulation to get consistent values
+			auto lock = emu->AcquireLock();
+			result.ElapsedSeconds = timer.GetElapsedMS() / 1000.0;
+			counters->SetEnabled(false);
+			for(int i = 0; i < PerformanceCounters::CounterCount; i++) {
+				result.Counters[i] = counters->GetStats((PerfCounterType)i);
+			}
+			result.FrameCount = emu->GetFrameCount() - startFrame;
+		}
+
+		emu->Release();
+		return true;
+	}
+
 	DllExport void __stdcall RomTestRecord(char* filename, bool reset)
 	{
 		_recordedRomTest.reset(new RecordedRomTest(_emu.get(), false));
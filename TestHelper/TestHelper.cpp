@@ -0,0 +1,349 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <chrono>
+#if __has_include(<filesystem>)
+	#include <filesystem>
+	namespace fs = std::filesystem;
+#elif __has_include(<experimental/filesystem>)
+	#include <experimental/filesystem>
+	namespace fs = std::experimental::filesystem;
+#endif
+
+#ifndef _WIN32
+	#define __stdcall
+#endif
+
+using std::string;
+using std::vector;
+
+//Must match the definitions in Core/Shared/RecordedRomTest.h
+enum class RomTestState
+{
+	Failed,
+	Passed,
+	PassedWithWarnings
+};
+
+struct RomTestResult
+{
+	RomTestState State;
+	int32_t ErrorCode;
+	uint32_t FrameCount;
+	double ElapsedSeconds;
+};
+
+//Must match the definitions in Core/Shared/PerformanceCounters.h
+static constexpr int CounterCount = 12;
+
+struct PerfCounterStats
+{
+	double TotalTime;
+	uint32_t CallCount;
+};
+
+struct BenchmarkResult
+{
+	uint32_t FrameCount;
+	double ElapsedSeconds;
+	PerfCounterStats Counters[CounterCount];
+};
+
+static const char* _counterNames[CounterCount] = {
+	"Frame", "RunFrame", "FrameWait", "RunAhead", "RewindCapture", "DecodeFrame",
+	"Render", "PlayAudio", "AudioResample", "Serialize", "Deserialize", "Netplay"
+};
+
+extern "C" {
+	void __stdcall RunRecordedTests(vector<string> testFiles, string homeFolder, uint32_t threadCount, uint32_t timeoutSeconds, vector<RomTestResult>& results);
+	bool __stdcall RunBenchmark(string romFile, string movieFile, uint32_t frameCount, string homeFolder, BenchmarkResult& result);
+}
+
+struct TestEntry
+{
+	string Name;
+	RomTestResult Result;
+};
+
+vector<string> GetTestFiles(string rootFolder)
+{
+	vector<string> files;
+
+	std::error_code errorCode;
+	if(!fs::is_directory(fs::u8path(rootFolder), errorCode)) {
+		return files;
+	}
+
+	for(fs::recursive_directory_iterator i(fs::u8path(rootFolder)), end; i != end; i++) {
+		string extension = i->path().extension().u8string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		if(extension == ".mtp") {
+			files.push_back(i->path().u8string());
+		}
+	}
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+string GetStateName(RomTestState state)
+{
+	switch(state) {
+		case RomTestState::Passed: return "Passed";
+		case RomTestState::PassedWithWarnings: return "PassedWithWarnings";
+		default: return "Failed";
+	}
+}
+
+double GetFps(RomTestResult& result)
+{
+	return result.ElapsedSeconds > 0 ? result.FrameCount / result.ElapsedSeconds : 0;
+}
+
+string Escape(string str, bool forXml)
+{
+	std::stringstream out;
+	for(char c : str) {
+		switch(c) {
+			case '"': out << (forXml ? "&quot;" : "\\\""); break;
+			case '\\': out << (forXml ? "\\" : "\\\\"); break;
+			case '&': out << (forXml ? "&amp;" : "&"); break;
+			case '<': out << (forXml ? "&lt;" : "<"); break;
+			case '>': out << (forXml ? "&gt;" : ">"); break;
+			default:
+				if((uint8_t)c < 0x20) {
+					out << ' ';
+				} else {
+					out << c;
+				}
+				break;
+		}
+	}
+	return out.str();
+}
+
+void WriteJUnit(string filename, vector<TestEntry>& tests, uint32_t failedCount, double totalTime)
+{
+	std::ofstream out(fs::u8path(filename), std::ios::out | std::ios::trunc);
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	out << "<testsuites>\n";
+	out << "\t<testsuite name=\"RecordedRomTests\" tests=\"" << tests.size() << "\" failures=\"" << failedCount << "\" time=\"" << totalTime << "\">\n";
+	for(TestEntry& test : tests) {
+		RomTestResult& result = test.Result;
+		out << "\t\t<testcase name=\"" << Escape(test.Name, true) << "\" classname=\"RecordedRomTests\" time=\"" << result.ElapsedSeconds << "\">\n";
+		if(result.State == RomTestState::Failed) {
+			out << "\t\t\t<failure message=\"Error code: " << result.ErrorCode << "\"/>\n";
+		}
+		out << "\t\t\t<system-out>state=" << GetStateName(result.State) << " errorCode=" << result.ErrorCode << " frames=" << result.FrameCount << " fps=" << GetFps(result) << "</system-out>\n";
+		out << "\t\t</testcase>\n";
+	}
+	out << "\t</testsuite>\n";
+	out << "</testsuites>\n";
+}
+
+void WriteJson(string filename, vector<TestEntry>& tests, uint32_t failedCount, double totalTime)
+{
+	std::ofstream out(fs::u8path(filename), std::ios::out | std::ios::trunc);
+	out << "{\n";
+	out << "\t\"total\": " << tests.size() << ",\n";
+	out << "\t\"failed\": " << failedCount << ",\n";
+	out << "\t\"time\": " << totalTime << ",\n";
+	out << "\t\"tests\": [\n";
+	for(size_t i = 0; i < tests.size(); i++) {
+		RomTestResult& result = tests[i].Result;
+		out << "\t\t{ ";
+		out << "\"name\": \"" << Escape(tests[i].Name, false) << "\", ";
+		out << "\"state\": \"" << GetStateName(result.State) << "\", ";
+		out << "\"errorCode\": " << result.ErrorCode << ", ";
+		out << "\"time\": " << result.ElapsedSeconds << ", ";
+		out << "\"frames\": " << result.FrameCount << ", ";
+		out << "\"fps\": " << GetFps(result);
+		out << " }" << (i + 1 < tests.size() ? "," : "") << "\n";
+	}
+	out << "\t]\n";
+	out << "}\n";
+}
+
+int RunBenchmarkMode(string romFile, string movieFile, uint32_t frameCount, string homeFolder, string jsonFile)
+{
+	std::cout << "Running benchmark: " << romFile << " (" << frameCount << " frames)" << std::endl;
+
+	BenchmarkResult result = {};
+	if(!RunBenchmark(romFile, movieFile, frameCount, homeFolder, result)) {
+		std::cout << "Could not load rom: " << romFile << std::endl;
+		return 2;
+	}
+
+	double fps = result.ElapsedSeconds > 0 ? result.FrameCount / result.ElapsedSeconds : 0;
+	double totalTime = result.ElapsedSeconds * 1000;
+
+	std::cout << "Frames: " << result.FrameCount << std::endl;
+	std::cout << "Time: " << result.ElapsedSeconds << "s" << std::endl;
+	std::cout << "FPS: " << fps << std::endl;
+	std::cout << "==================" << std::endl;
+	std::cout << "Counter\tCalls\tTotal (ms)\tAverage (ms)\t% of time" << std::endl;
+	for(int i = 0; i < CounterCount; i++) {
+		PerfCounterStats& counter = result.Counters[i];
+		double average = counter.CallCount > 0 ? counter.TotalTime / counter.CallCount : 0;
+		double percent = totalTime > 0 ? counter.TotalTime * 100 / totalTime : 0;
+		std::cout << _counterNames[i] << "\t" << counter.CallCount << "\t" << counter.TotalTime << "\t" << average << "\t" << percent << std::endl;
+	}
+	std::cout << "(RunFrame includes FrameWait and PlayAudio, DecodeFrame and Render run on their own threads)" << std::endl;
+
+	if(!jsonFile.empty()) {
+		std::ofstream out(fs::u8path(jsonFile), std::ios::out | std::ios::trunc);
+		out << "{\n";
+		out << "\t\"rom\": \"" << Escape(romFile, false) << "\",\n";
+		out << "\t\"movie\": \"" << Escape(movieFile, false) << "\",\n";
+		out << "\t\"frames\": " << result.FrameCount << ",\n";
+		out << "\t\"time\": " << result.ElapsedSeconds << ",\n";
+		out << "\t\"fps\": " << fps << ",\n";
+		out << "\t\"counters\": {\n";
+		for(int i = 0; i < CounterCount; i++) {
+			PerfCounterStats& counter = result.Counters[i];
+			out << "\t\t\"" << _counterNames[i] << "\": { \"calls\": " << counter.CallCount << ", \"totalTime\": " << counter.TotalTime << " }" << (i + 1 < CounterCount ? "," : "") << "\n";
+		}
+		out << "\t}\n";
+		out << "}\n";
+	}
+
+	return 0;
+}
+
+bool ParseNumber(const char* str, uint32_t& value)
+{
+	//Rejects empty/negative values, trailing characters and out of range values (std::stoul throws or accepts these)
+	char* end = nullptr;
+	errno = 0;
+	unsigned long long result = std::strtoull(str, &end, 10);
+	if(str[0] == '\0' || str[0] == '-' || *end != '\0' || errno == ERANGE || result > UINT32_MAX) {
+		return false;
+	}
+	value = (uint32_t)result;
+	return true;
+}
+
+void PrintUsage()
+{
+	std::cout << "Usage:" << std::endl;
+	std::cout << "  testhelper <test folder> [--threads <count>] [--timeout <seconds>] [--junit <file>] [--json <file>] [--home <folder>]" << std::endl;
+	std::cout << "  testhelper --benchmark <rom> [--movie <file>] [--frames <count>] [--json <file>] [--home <folder>]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	string testFolder;
+	string junitFile;
+	string jsonFile;
+	string homeFolder = "TestHelperHome";
+	string benchmarkRom;
+	string movieFile;
+	uint32_t frameCount = 6000;
+	uint32_t threadCount = 0;
+	uint32_t timeout = 0;
+	bool validArgs = true;
+
+	for(int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if(arg == "--threads" && hasValue) {
+			validArgs = ParseNumber(argv[++i], threadCount);
+		} else if(arg == "--timeout" && hasValue) {
+			validArgs = ParseNumber(argv[++i], timeout);
+		} else if(arg == "--junit" && hasValue) {
+			junitFile = argv[++i];
+		} else if(arg == "--json" && hasValue) {
+			jsonFile = argv[++i];
+		} else if(arg == "--home" && hasValue) {
+			homeFolder = argv[++i];
+		} else if(arg == "--benchmark" && hasValue) {
+			benchmarkRom = argv[++i];
+		} else if(arg == "--movie" && hasValue) {
+			movieFile = argv[++i];
+		} else if(arg == "--frames" && hasValue) {
+			validArgs = ParseNumber(argv[++i], frameCount);
+		} else if(testFolder.empty() && arg.size() > 0 && arg[0] != '-') {
+			testFolder = arg;
+		} else {
+			//Unknown option, or an option without its value
+			validArgs = false;
+		}
+
+		if(!validArgs) {
+			std::cout << "Invalid argument: " << arg << std::endl;
+			PrintUsage();
+			return 2;
+		}
+	}
+
+	std::error_code errorCode;
+	fs::create_directories(fs::u8path(homeFolder), errorCode);
+	homeFolder = fs::absolute(fs::u8path(homeFolder)).u8string();
+
+	if(!benchmarkRom.empty()) {
+		return RunBenchmarkMode(benchmarkRom, movieFile, frameCount, homeFolder, jsonFile);
+	}
+
+	if(testFolder.empty()) {
+		PrintUsage();
+		return 2;
+	}
+
+	vector<string> testFiles = GetTestFiles(testFolder);
+	if(testFiles.empty()) {
+		std::cout << "No test files (.mtp) found in: " << testFolder << std::endl;
+		return 2;
+	}
+
+	std::cout << "Running " << testFiles.size() << " tests..." << std::endl;
+
+	auto start = std::chrono::steady_clock::now();
+	vector<RomTestResult> results;
+	RunRecordedTests(testFiles, homeFolder, threadCount, timeout, results);
+	double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	vector<TestEntry> tests;
+	uint32_t failedCount = 0;
+	fs::path rootPath = fs::u8path(testFolder);
+	for(size_t i = 0; i < testFiles.size() && i < results.size(); i++) {
+		TestEntry entry;
+		entry.Name = fs::u8path(testFiles[i]).lexically_relative(rootPath).generic_u8string();
+		entry.Result = results[i];
+		tests.push_back(entry);
+
+		RomTestResult& result = entry.Result;
+		if(result.State == RomTestState::Failed) {
+			failedCount++;
+		}
+
+		std::cout << "[Test] " << GetStateName(result.State) << ": " << entry.Name;
+		if(result.State != RomTestState::Passed) {
+			std::cout << " (" << result.ErrorCode << ")";
+		}
+		std::cout << " - " << result.ElapsedSeconds << "s, " << (int)GetFps(result) << " fps" << std::endl;
+	}
+
+	std::cout << "==================" << std::endl;
+	if(failedCount > 0) {
+		std::cout << "Tests passed: " << (tests.size() - failedCount) << std::endl;
+		std::cout << "Tests failed: " << failedCount << std::endl;
+	} else {
+		std::cout << "All " << tests.size() << " tests passed!" << std::endl;
+	}
+	std::cout << "Total time: " << totalTime << "s" << std::endl;
+
+	if(!junitFile.empty()) {
+		WriteJUnit(junitFile, tests, failedCount, totalTime);
+	}
+	if(!jsonFile.empty()) {
+		WriteJson(jsonFile, tests, failedCount, totalTime);
+	}
+
+	return failedCount > 0 ? 1 : 0;
+}
@@ -20,6 +20,7 @@ namespace Mesen.Config
 		[Reactive] public bool AutoRefresh { get; set; } = true;
 		[Reactive] public bool RefreshOnBreakPause { get; set; } = true;
 		[Reactive] public bool ShowToolbar { get; set; } = true;
+		[Reactive] [MinMax(DebugApi.TraceLogBufferSize, 500000000)] public int HistorySize { get; set; } = DebugApi.TraceLogBufferSize;
 
 		[Reactive] public TraceLoggerCpuConfig SnesConfig { get; set; } = new();
 		[Reactive] public TraceLoggerCpuConfig SpcConfig { get; set; } = new();
@@ -35,6 +35,7 @@ namespace Mesen.Config
 		//General
 		[Reactive] public ConsoleRegion Region { get; set; } = ConsoleRegion.Auto;
 		[Reactive] public bool EnableHdPacks { get; set; } = true;
+		[Reactive] public bool CacheHdPackImages { get; set; } = false;
 		[Reactive] public bool DisableGameDatabase { get; set; } = false;
 		[Reactive] public bool FdsAutoLoadDisk { get; set; } = true;
 		[Reactive] public bool FdsFastForwardOnLoad { get; set; } = false;
@@ -149,6 +150,7 @@ namespace Mesen.Config
 
 				Region = Region,
 				EnableHdPacks = EnableHdPacks,
+				CacheHdPackImages = CacheHdPackImages,
 				DisableGameDatabase = DisableGameDatabase,
 				FdsAutoLoadDisk = FdsAutoLoadDisk,
 				FdsFastForwardOnLoad = FdsFastForwardOnLoad,
@@ -315,6 +317,7 @@ namespace Mesen.Config
 
 		public ConsoleRegion Region;
 		[MarshalAs(UnmanagedType.I1)] public bool EnableHdPacks;
+		[MarshalAs(UnmanagedType.I1)] public bool CacheHdPackImages;
 		[MarshalAs(UnmanagedType.I1)] public bool DisableGameDatabase;
 		[MarshalAs(UnmanagedType.I1)] public bool FdsAutoLoadDisk;
 		[MarshalAs(UnmanagedType.I1)] public bool FdsFastForwardOnLoad;
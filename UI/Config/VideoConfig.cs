@@ -49,6 +49,8 @@ namespace Mesen.Config
 
 		[Reactive] public ScreenRotation ScreenRotation { get; set; } = ScreenRotation.None;
 
+		[Reactive] [MinMax(0, 32)] public UInt32 FilterThreadCount { get; set; } = 0;
+
 		public VideoConfig()
 		{
 		}
@@ -91,7 +93,9 @@ namespace Mesen.Config
 				FullscreenResWidth = (uint)(ExclusiveFullscreenResolution == FullscreenResolution.Default ? (ApplicationHelper.GetMainWindow()?.Screens.Primary?.Bounds.Width ?? 1920) : ExclusiveFullscreenResolution.GetWidth()),
 				FullscreenResHeight = (uint)(ExclusiveFullscreenResolution == FullscreenResolution.Default ? (ApplicationHelper.GetMainWindow()?.Screens.Primary?.Bounds.Height ?? 1080) : ExclusiveFullscreenResolution.GetHeight()),
 
-				ScreenRotation = (uint)ScreenRotation
+				ScreenRotation = (uint)ScreenRotation,
+
+				FilterThreadCount = this.FilterThreadCount
 			});
 		}
 	}
@@ -135,6 +139,8 @@ namespace Mesen.Config
 		public UInt32 FullscreenResHeight;
 
 		public UInt32 ScreenRotation;
+
+		public UInt32 FilterThreadCount;
 	}
 
 	public enum VideoFilterType
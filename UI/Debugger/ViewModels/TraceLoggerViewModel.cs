@@ -17,6 +17,7 @@ using System;
 using System.Collections.Generic;
 using System.ComponentModel;
 using System.Linq;
+using System.Reactive.Linq;
 using System.Text;
 using System.Threading.Tasks;
 
@@ -97,10 +98,16 @@ namespace Mesen.Debugger.ViewModels
 			}));
 
 			AddDisposable(this.WhenAnyValue(x => x.SelectionStart, x => x.SelectionEnd, x => x.SelectedRow, x => x.SelectionAnchor).Subscribe(x => {
-				SelectionStart = Math.Max(MinScrollPosition, Math.Min(DebugApi.TraceLogBufferSize - 1, SelectionStart));
-				SelectionEnd = Math.Max(MinScrollPosition, Math.Min(DebugApi.TraceLogBufferSize - 1, SelectionEnd));
-				SelectedRow = Math.Max(MinScrollPosition, Math.Min(DebugApi.TraceLogBufferSize - 1, SelectedRow));
-				SelectionAnchor = Math.Max(MinScrollPosition, Math.Min(DebugApi.TraceLogBufferSize - 1, SelectionAnchor));
+				SelectionStart = Math.Max(MinScrollPosition, Math.Min(Config.HistorySize - 1, SelectionStart));
+				SelectionEnd = Math.Max(MinScrollPosition, Math.Min(Config.HistorySize - 1, SelectionEnd));
+				SelectedRow = Math.Max(MinScrollPosition, Math.Min(Config.HistorySize - 1, SelectedRow));
+				SelectionAnchor = Math.Max(MinScrollPosition, Math.Min(Config.HistorySize - 1, SelectionAnchor));
+			}));
+
+			AddDisposable(this.WhenAnyValue(x => x.Config.HistorySize).Skip(1).Subscribe(x => {
+				MaxScrollPosition = Config.HistorySize - VisibleRowCount;
+				UpdateCoreOptions();
+				UpdateLog(true);
 			}));
 		}
 
@@ -111,9 +118,17 @@ namespace Mesen.Debugger.ViewModels
 
 		private void QuickSearch_OnFind(OnFindEventArgs e)
 		{
-			CodeLineData[] lines = GetCodeLines(0, DebugApi.TraceLogBufferSize);
 			string needle = e.SearchString.ToLowerInvariant().Trim();
-			
+
+			//Only the rows that contain data are searched, and they are loaded in small pages
+			//(the trace log can contain hundreds of millions of rows when the history size is increased)
+			int historySize = Config.HistorySize;
+			int traceSize = Math.Min(historySize, (int)DebugApi.GetExecutionTraceSize());
+			int firstRow = historySize - traceSize;
+			const int pageSize = 1000;
+			int pageStart = -1;
+			CodeLineData[] page = Array.Empty<CodeLineData>();
+
 			int startRow = SelectedRow;
 			if(e.Direction == SearchDirection.Backward) {
 				startRow--;
@@ -122,12 +137,19 @@ namespace Mesen.Debugger.ViewModels
 			}
 			int sign = e.Direction == SearchDirection.Backward ? -1 : 1;
 
-			for(int i = 0; i < lines.Length; i++) {
-				int lineIndex = (i * sign + startRow) % lines.Length;
+			for(int i = 0; i < traceSize; i++) {
+				int lineIndex = (i * sign + startRow - firstRow) % traceSize;
 				if(lineIndex < 0) {
-					lineIndex += lines.Length;
+					lineIndex += traceSize;
+				}
+				lineIndex += firstRow;
+
+				if(lineIndex < pageStart || lineIndex >= pageStart + page.Length) {
+					pageStart = Math.Max(firstRow, Math.Min(historySize - pageSize, sign > 0 ? lineIndex : lineIndex - pageSize + 1));
+					page = GetCodeLines(pageStart, Math.Min(pageSize, historySize - pageStart));
 				}
-				if(lines[lineIndex].Text.Contains(needle, StringComparison.OrdinalIgnoreCase)) {
+
+				if(page[lineIndex - pageStart].Text.Contains(needle, StringComparison.OrdinalIgnoreCase)) {
 					Dispatcher.UIThread.Post(() => {
 						ScrollToRowNumber(lineIndex);
 						SelectedRow = lineIndex;
@@ -257,7 +279,8 @@ namespace Mesen.Debugger.ViewModels
 					UseLabels = cfg.UseLabels,
 					IndentCode = cfg.IndentCode,
 					Format = Encoding.UTF8.GetBytes(cfg.UseCustomFormat ? cfg.Format : TraceLoggerOptionTab.GetAutoFormat(cfg, cpuType)),
-					Condition = Encoding.UTF8.GetBytes(cfg.Condition)
+					Condition = Encoding.UTF8.GetBytes(cfg.Condition),
+					HistorySize = (uint)Config.HistorySize
 				};
 
 				Array.Resize(ref options.Condition, 1000);
@@ -273,7 +296,7 @@ namespace Mesen.Debugger.ViewModels
 			CodeLineData[] lines = GetCodeLines(ScrollPosition, VisibleRowCount);
 
 			Dispatcher.UIThread.Post(() => {
-				MinScrollPosition = Math.Min(MaxScrollPosition, DebugApi.TraceLogBufferSize - traceSize);
+				MinScrollPosition = Math.Min(MaxScrollPosition, Config.HistorySize - traceSize);
 				TraceLogLines = lines;
 
 				if(scrollToBottom) {
@@ -355,13 +378,13 @@ namespace Mesen.Debugger.ViewModels
 		public void ScrollToBottom()
 		{
 			ScrollPosition = MaxScrollPosition;
-			SetSelectedRow(DebugApi.TraceLogBufferSize - 1);
+			SetSelectedRow(Config.HistorySize - 1);
 		}
 
 		public void SelectAll()
 		{
 			SelectionStart = 0;
-			SelectionEnd = DebugApi.TraceLogBufferSize - 1;
+			SelectionEnd = Config.HistorySize - 1;
 			InvalidateVisual();
 		}
 
@@ -400,7 +423,7 @@ namespace Mesen.Debugger.ViewModels
 
 		private CodeLineData[] GetCodeLines(int startIndex, int rowCount)
 		{
-			TraceRow[] rows = DebugApi.GetExecutionTrace((uint)(DebugApi.TraceLogBufferSize - startIndex - rowCount), (uint)rowCount);
+			TraceRow[] rows = DebugApi.GetExecutionTrace((uint)(Config.HistorySize - startIndex - rowCount), (uint)rowCount);
 
 			List<CodeLineData> lines = new(rowCount);
 
@@ -425,7 +448,7 @@ namespace Mesen.Debugger.ViewModels
 
 		public AddressInfo? GetSelectedRowAddress()
 		{
-			TraceRow[] rows = DebugApi.GetExecutionTrace(DebugApi.TraceLogBufferSize - (uint)SelectedRow - 1, 1);
+			TraceRow[] rows = DebugApi.GetExecutionTrace((uint)(Config.HistorySize - SelectedRow - 1), 1);
 			if(rows.Length > 0) {
 				return new AddressInfo() {
 					Address = (int)rows[0].ProgramCounter,
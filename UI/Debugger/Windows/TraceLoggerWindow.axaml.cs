@@ -42,7 +42,7 @@ namespace Mesen.Debugger.Windows
 
 			viewer.GetPropertyChangedObservable(DisassemblyViewer.VisibleRowCountProperty).Subscribe(x => {
 				_model.VisibleRowCount = viewer.VisibleRowCount - 1;
-				_model.MaxScrollPosition = DebugApi.TraceLogBufferSize - _model.VisibleRowCount;
+				_model.MaxScrollPosition = _model.Config.HistorySize - _model.VisibleRowCount;
 			});
 
 			DataContext = model;
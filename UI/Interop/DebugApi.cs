@@ -27,6 +27,7 @@ namespace Mesen.Interop
 
 		[DllImport(DllPath)] public static extern void SetTraceOptions(CpuType cpuType, InteropTraceLoggerOptions options);
 
+		//Default number of rows kept by the trace logger (larger sizes are stored in a memory-mapped file)
 		public const int TraceLogBufferSize = 30000;
 		[DllImport(DllPath)] public static extern void ClearExecutionTrace();
 		[DllImport(DllPath, EntryPoint = "GetExecutionTrace")] private static extern UInt32 GetExecutionTraceWrapper(IntPtr output, UInt32 startOffset, UInt32 maxRowCount);
@@ -44,10 +45,7 @@ namespace Mesen.Interop
 			return rows;
 		}
 
-		public static UInt32 GetExecutionTraceSize()
-		{
-			return DebugApi.GetExecutionTraceWrapper(IntPtr.Zero, 0, DebugApi.TraceLogBufferSize);
-		}
+		[DllImport(DllPath)] public static extern UInt32 GetExecutionTraceSize();
 
 		[DllImport(DllPath, EntryPoint = "GetDebuggerLog")] private static extern void GetDebuggerLogWrapper(IntPtr outLog, Int32 maxLength);
 		public static string GetLog() { return Utf8Utilities.CallStringApi(GetDebuggerLogWrapper, 100000); }
@@ -1157,6 +1155,8 @@ namespace Mesen.Interop
 
 		[MarshalAs(UnmanagedType.ByValArray, SizeConst = 1000)]
 		public byte[] Format;
+
+		public UInt32 HistorySize;
 	}
 
 	public enum VectorType
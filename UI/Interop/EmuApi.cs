@@ -125,6 +125,11 @@ namespace Mesen.Interop
 			return null;
 		}
 
+		[DllImport(DllPath)] public static extern void SetPerformanceCountersEnabled([MarshalAs(UnmanagedType.I1)]bool enabled);
+		[DllImport(DllPath)] public static extern PerfCounterFrameStats GetPerformanceCounterStats(PerfCounterType type);
+		[DllImport(DllPath)] public static extern void StartPerformanceTrace();
+		[DllImport(DllPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool StopPerformanceTrace([MarshalAs(UnmanagedType.LPUTF8Str)]string filename);
+
 		[DllImport(DllPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool GetConvertedCheat([In]InteropCheatCode input, ref InteropInternalCheatCode output);
 		[DllImport(DllPath)] public static extern void SetCheats([In]InteropCheatCode[] cheats, UInt32 cheatCount);
 		[DllImport(DllPath)] public static extern void ClearCheats();
@@ -145,6 +150,31 @@ namespace Mesen.Interop
 		public UInt32 CycleCount;
 	}
 
+	public enum PerfCounterType
+	{
+		Frame,
+		RunFrame,
+		FrameWait,
+		RunAhead,
+		RewindCapture,
+		DecodeFrame,
+		Render,
+		PlayAudio,
+		AudioResample,
+		Serialize,
+		Deserialize,
+		Netplay
+	}
+
+	public struct PerfCounterFrameStats
+	{
+		public double Average;
+		public double P50;
+		public double P99;
+		public double Max;
+		public UInt32 SampleCount;
+	}
+
 	public struct FrameInfo
 	{
 		public UInt32 Width;
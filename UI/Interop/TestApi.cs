@@ -21,6 +21,8 @@ namespace Mesen.Interop
 	{
 		public RomTestState State;
 		public Int32 ErrorCode;
+		public UInt32 FrameCount;
+		public double ElapsedSeconds;
 	}
 
 	public enum RomTestState
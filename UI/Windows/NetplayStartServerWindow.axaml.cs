@@ -31,7 +31,7 @@ namespace Mesen.Windows
 			NetplayConfig cfg = (NetplayConfig)DataContext!;
 			ConfigManager.Config.Netplay = cfg.Clone();
 
-			NetplayApi.StartServer(cfg.ServerPort, cfg.ServerPassword);
+			NetplayApi.StartServer(cfg.ServerPort, cfg.ServerPassword, cfg.ServerRollback);
 		}
 
 		private void Cancel_OnClick(object sender, RoutedEventArgs e)
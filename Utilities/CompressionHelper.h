@@ -1,32 +1,71 @@
 #pragma once
 #include "pch.h"
 #include "miniz.h"
+#include "LzCompressor.h"
+
+enum class CompressionType
+{
+	//zlib/deflate - better ratio, used for data written to disk
+	Deflate,
+
+	//LZ4-style codec - much faster, used for data kept in memory (rewind history, etc.)
+	Lz
+};
 
 class CompressionHelper
 {
+private:
+	static constexpr uint32_t HeaderSize = sizeof(uint32_t) * 2;
+
+	//Bit 31 of the compressed size field is set when the data was compressed with the LZ codec
+	static constexpr uint32_t LzFlag = 0x80000000;
+
 public:
-	static void Compress(string data, int compressionLevel, vector<uint8_t>& output)
+	//Appends the compressed data to the end of output - no intermediate buffers are used, so reusing
+	//the same output vector avoids any memory allocations once it is large enough
+	static void Compress(const uint8_t* data, size_t dataSize, int compressionLevel, vector<uint8_t>& output, CompressionType type = CompressionType::Deflate)
 	{
-		unsigned long compressedSize = compressBound((unsigned long)data.size());
-		uint8_t* compressedData = new uint8_t[compressedSize];
-		compress2(compressedData, &compressedSize, (unsigned char*)data.c_str(), (unsigned long)data.size(), compressionLevel);
-
-		uint32_t size = (uint32_t)compressedSize;
-		uint32_t originalSize = (uint32_t)data.size();
-		output.insert(output.end(), (char*)&originalSize, (char*)&originalSize + sizeof(uint32_t));
-		output.insert(output.end(), (char*)&size, (char*)&size + sizeof(uint32_t));
-		output.insert(output.end(), (char*)compressedData, (char*)compressedData + compressedSize);
-		delete[] compressedData;
+		size_t start = output.size();
+		size_t maxSize = type == CompressionType::Lz ? LzCompressor::GetMaxCompressedSize(dataSize) : compressBound((unsigned long)dataSize);
+		output.resize(start + CompressionHelper::HeaderSize + maxSize);
+
+		uint8_t* dst = output.data() + start + CompressionHelper::HeaderSize;
+		uint32_t size;
+		if(type == CompressionType::Lz) {
+			size = (uint32_t)LzCompressor::Compress(data, dataSize, dst);
+		} else {
+			unsigned long compressedSize = (unsigned long)maxSize;
+			compress2(dst, &compressedSize, data, (unsigned long)dataSize, compressionLevel);
+			size = (uint32_t)compressedSize;
+		}
+
+		uint32_t originalSize = (uint32_t)dataSize;
+		uint32_t sizeField = size | (type == CompressionType::Lz ? CompressionHelper::LzFlag : 0);
+		memcpy(output.data() + start, &originalSize, sizeof(uint32_t));
+		memcpy(output.data() + start + sizeof(uint32_t), &sizeField, sizeof(uint32_t));
+		output.resize(start + CompressionHelper::HeaderSize + size);
 	}
 
-	static bool Decompress(vector<uint8_t>& input, vector<uint8_t>& output)
+	static void Compress(const string& data, int compressionLevel, vector<uint8_t>& output, CompressionType type = CompressionType::Deflate)
 	{
+		Compress((const uint8_t*)data.data(), data.size(), compressionLevel, output, type);
+	}
+
+	static bool Decompress(const vector<uint8_t>& input, vector<uint8_t>& output)
+	{
+		if(input.size() < CompressionHelper::HeaderSize) {
+			return false;
+		}
+
 		uint32_t decompressedSize;
 		uint32_t compressedSize;
 
 		memcpy(&decompressedSize, input.data(), sizeof(uint32_t));
 		memcpy(&compressedSize, input.data() + sizeof(uint32_t), sizeof(uint32_t));
 
+		bool isLz = (compressedSize & CompressionHelper::LzFlag) != 0;
+		compressedSize &= ~CompressionHelper::LzFlag;
+
 		if(decompressedSize >= 1024 * 1024 * 10 || compressedSize >= 1024 * 1024 * 10) {
 			//Limit to 10mb the data's size
 			return false;
@@ -34,11 +73,17 @@ public:
 
 		output.resize(decompressedSize, 0);
 
+		const uint8_t* src = input.data() + CompressionHelper::HeaderSize;
+		size_t srcSize = input.size() - CompressionHelper::HeaderSize;
+		if(isLz) {
+			return LzCompressor::Decompress(src, srcSize, output.data(), decompressedSize);
+		}
+
 		unsigned long decompSize = decompressedSize;
-		if(uncompress(output.data(), &decompSize, input.data() + sizeof(uint32_t)*2, (unsigned long)input.size() - sizeof(uint32_t) * 2) != MZ_OK) {
+		if(uncompress(output.data(), &decompSize, src, (unsigned long)srcSize) != MZ_OK) {
 			return false;
 		}
 
 		return true;
 	}
-};
\ No newline at end of file
+};
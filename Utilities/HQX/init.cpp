@@ -38,11 +38,11 @@ void HQX_CALLCONV hqxInit(void)
     }
 }
 
-void HQX_CALLCONV hqx(uint32_t scale, uint32_t * src, uint32_t * dest, int width, int height)
+void HQX_CALLCONV hqx(uint32_t scale, uint32_t * src, uint32_t * dest, int width, int height, int yFirst, int yLast)
 {
 	switch(scale) {
-		case 2: hq2x_32(src, dest, width, height); break;
-		case 3: hq3x_32(src, dest, width, height); break;
-		case 4: hq4x_32(src, dest, width, height); break;
+		case 2: hq2x_32(src, dest, width, height, yFirst, yLast); break;
+		case 3: hq3x_32(src, dest, width, height, yFirst, yLast); break;
+		case 4: hq4x_32(src, dest, width, height, yFirst, yLast); break;
 	}
 }
\ No newline at end of file
@@ -130,12 +130,23 @@
          out += 2
 #endif
 
-void twoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+void twoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride, unsigned yFirst, unsigned yLast)
 {
    unsigned finish;
-	int y = 0;
+	yLast = std::min(yLast, height);
+	if(yFirst >= yLast) {
+		return;
+	}
+
+	//Only process rows [yFirst, yLast) - the rows around the slice are still read as neighbors
+	src += yFirst * src_stride;
+	dst += yFirst * 2 * dst_stride;
+	height -= yFirst;
+	unsigned rowCount = yLast - yFirst;
+
+	int y = yFirst;
 	int x = 0;
-	for(; height; height--) {
+	for(; rowCount; rowCount--, height--) {
 		uint32_t *in = (uint32_t*)src;
 		uint32_t *out = (uint32_t*)dst;
 
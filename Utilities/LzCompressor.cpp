@@ -0,0 +1,174 @@
+#include "pch.h"
+#include "LzCompressor.h"
+
+static __forceinline uint32_t ReadU32(const uint8_t* ptr)
+{
+	uint32_t value;
+	memcpy(&value, ptr, sizeof(uint32_t));
+	return value;
+}
+
+static __forceinline uint32_t GetHash(uint32_t sequence, uint32_t hashBits)
+{
+	return (sequence * 2654435761U) >> (32 - hashBits);
+}
+
+uint8_t* LzCompressor::WriteLength(uint8_t* out, uint32_t length)
+{
+	while(length >= 255) {
+		*out++ = 255;
+		length -= 255;
+	}
+	*out++ = (uint8_t)length;
+	return out;
+}
+
+size_t LzCompressor::Compress(const uint8_t* src, size_t srcSize, uint8_t* dst)
+{
+	uint8_t* out = dst;
+	size_t anchor = 0;
+
+	if(srcSize > LzCompressor::MatchFindLimit) {
+		//Hash table of the last position where each 4-byte sequence was seen
+		uint32_t hashTable[1 << LzCompressor::HashBits] = {};
+
+		size_t matchStartLimit = srcSize - LzCompressor::MatchFindLimit;
+		size_t matchEndLimit = srcSize - LzCompressor::LastLiterals;
+		size_t pos = 1;
+		hashTable[GetHash(ReadU32(src), LzCompressor::HashBits)] = 0;
+
+		while(pos < matchStartLimit) {
+			uint32_t sequence = ReadU32(src + pos);
+			uint32_t hash = GetHash(sequence, LzCompressor::HashBits);
+			size_t ref = hashTable[hash];
+			hashTable[hash] = (uint32_t)pos;
+
+			if(pos - ref > LzCompressor::MaxOffset || ReadU32(src + ref) != sequence) {
+				//No match, skip ahead faster when no matches have been found in a while
+				pos += 1 + ((pos - anchor) >> 6);
+				continue;
+			}
+
+			//Extend match backwards & forwards
+			while(pos > anchor && ref > 0 && src[pos - 1] == src[ref - 1]) {
+				pos--;
+				ref--;
+			}
+
+			size_t matchLen = LzCompressor::MinMatch;
+			while(pos + matchLen < matchEndLimit && src[pos + matchLen] == src[ref + matchLen]) {
+				matchLen++;
+			}
+
+			//Token: literal length (high nibble), match length (low nibble)
+			uint32_t literalLen = (uint32_t)(pos - anchor);
+			uint32_t extraMatchLen = (uint32_t)(matchLen - LzCompressor::MinMatch);
+			uint8_t* token = out++;
+			*token = (uint8_t)((std::min<uint32_t>(literalLen, 15) << 4) | std::min<uint32_t>(extraMatchLen, 15));
+			if(literalLen >= 15) {
+				out = WriteLength(out, literalLen - 15);
+			}
+			memcpy(out, src + anchor, literalLen);
+			out += literalLen;
+
+			uint16_t offset = (uint16_t)(pos - ref);
+			*out++ = offset & 0xFF;
+			*out++ = offset >> 8;
+
+			if(extraMatchLen >= 15) {
+				out = WriteLength(out, extraMatchLen - 15);
+			}
+
+			pos += matchLen;
+			anchor = pos;
+
+			if(pos < matchStartLimit) {
+				hashTable[GetHash(ReadU32(src + pos - 2), LzCompressor::HashBits)] = (uint32_t)(pos - 2);
+			}
+		}
+	}
+
+	//Last literals
+	uint32_t literalLen = (uint32_t)(srcSize - anchor);
+	*out++ = (uint8_t)(std::min<uint32_t>(literalLen, 15) << 4);
+	if(literalLen >= 15) {
+		out = WriteLength(out, literalLen - 15);
+	}
+	memcpy(out, src + anchor, literalLen);
+	out += literalLen;
+
+	return out - dst;
+}
+
+bool LzCompressor::Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+	size_t in = 0;
+	size_t out = 0;
+
+	while(in < srcSize) {
+		uint8_t token = src[in++];
+
+		size_t literalLen = token >> 4;
+		if(literalLen == 15) {
+			uint8_t value;
+			do {
+				if(in >= srcSize) {
+					return false;
+				}
+				value = src[in++];
+				literalLen += value;
+			} while(value == 255);
+		}
+
+		if(in + literalLen > srcSize || out + literalLen > dstSize) {
+			return false;
+		}
+		memcpy(dst + out, src + in, literalLen);
+		in += literalLen;
+		out += literalLen;
+
+		if(in >= srcSize) {
+			//Last sequence only contains literals
+			break;
+		}
+
+		if(in + 2 > srcSize) {
+			return false;
+		}
+		size_t offset = src[in] | (src[in + 1] << 8);
+		in += 2;
+		if(offset == 0 || offset > out) {
+			return false;
+		}
+
+		size_t matchLen = token & 0x0F;
+		if(matchLen == 15) {
+			uint8_t value;
+			do {
+				if(in >= srcSize) {
+					return false;
+				}
+				value = src[in++];
+				matchLen += value;
+			} while(value == 255);
+		}
+		matchLen += LzCompressor::MinMatch;
+
+		if(out + matchLen > dstSize) {
+			return false;
+		}
+
+		uint8_t* match = dst + out - offset;
+		if(offset >= matchLen) {
+			memcpy(dst + out, match, matchLen);
+		} else {
+			//Overlapping copy (repeated pattern)
+			for(size_t i = 0; i < matchLen; i++) {
+				dst[out + i] = match[i];
+			}
+		}
+		out += matchLen;
+	}
+
+	return out == dstSize;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "pch.h"
+
+//Very fast LZ77 codec (LZ4 block format), used for data that is only kept in memory (rewind history, etc.)
+//Compression ratio is lower than deflate, but compression/decompression are an order of magnitude faster.
+class LzCompressor
+{
+private:
+	static constexpr uint32_t MinMatch = 4;
+	static constexpr uint32_t LastLiterals = 5;
+	static constexpr uint32_t MatchFindLimit = 12;
+	static constexpr uint32_t HashBits = 14;
+	static constexpr uint32_t MaxOffset = 0xFFFF;
+
+	static uint8_t* WriteLength(uint8_t* out, uint32_t length);
+
+public:
+	static size_t GetMaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+	//Returns the compressed size - dst must be at least GetMaxCompressedSize(srcSize) bytes long
+	static size_t Compress(const uint8_t* src, size_t srcSize, uint8_t* dst);
+
+	//Returns false if the data is invalid or does not decompress to exactly dstSize bytes
+	static bool Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+};
@@ -0,0 +1,104 @@
+#include "pch.h"
+#include "MemoryMappedFile.h"
+#include "UTF8Util.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool MemoryMappedFile::Open(string filepath, size_t size)
+{
+	Close();
+
+	HANDLE file = CreateFileW(utf8::utf8::decode(filepath).c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	_fileHandle = file;
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFF), nullptr);
+	if(!mapping) {
+		Close();
+		return false;
+	}
+	_mappingHandle = mapping;
+
+	_data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if(!_data) {
+		Close();
+		return false;
+	}
+
+	_size = size;
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if(_data) {
+		UnmapViewOfFile(_data);
+		_data = nullptr;
+	}
+	if(_mappingHandle) {
+		CloseHandle((HANDLE)_mappingHandle);
+		_mappingHandle = nullptr;
+	}
+	if(_fileHandle) {
+		//The file is deleted automatically (FILE_FLAG_DELETE_ON_CLOSE)
+		CloseHandle((HANDLE)_fileHandle);
+		_fileHandle = nullptr;
+	}
+	_size = 0;
+}
+#else
+bool MemoryMappedFile::Open(string filepath, size_t size)
+{
+	Close();
+
+	_fd = open(filepath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if(_fd < 0) {
+		return false;
+	}
+
+	//The file is only needed while it is mapped, remove it from the file system right away
+	unlink(filepath.c_str());
+
+	if(ftruncate(_fd, (off_t)size) != 0) {
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+	if(data == MAP_FAILED) {
+		Close();
+		return false;
+	}
+
+	_data = (uint8_t*)data;
+	_size = size;
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if(_data) {
+		munmap(_data, _size);
+		_data = nullptr;
+	}
+	if(_fd >= 0) {
+		close(_fd);
+		_fd = -1;
+	}
+	_size = 0;
+}
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+#include "pch.h"
+
+//Temporary file mapped in memory - used for buffers that can be larger than what can reasonably be allocated in RAM.
+//The OS pages the data in and out as needed, and the file is deleted when it is closed.
+class MemoryMappedFile
+{
+private:
+	uint8_t* _data = nullptr;
+	size_t _size = 0;
+
+#ifdef _WIN32
+	void* _fileHandle = nullptr;
+	void* _mappingHandle = nullptr;
+#else
+	int _fd = -1;
+#endif
+
+public:
+	~MemoryMappedFile();
+
+	//Creates (or replaces) the file and maps it in memory - the content is initialized to 0
+	bool Open(string filepath, size_t size);
+	void Close();
+
+	uint8_t* GetData() { return _data; }
+	size_t GetSize() { return _size; }
+};
@@ -235,6 +235,29 @@ void nes_ntsc_init( nes_ntsc_t* ntsc, nes_ntsc_setup_t const* setup )
 
 #ifndef NES_NTSC_NO_BLITTERS
 
+#include "ntsc_row.h"
+
+#if NES_NTSC_OUT_DEPTH != 32 && NES_NTSC_OUT_DEPTH != 24
+	#error "The blitters only support 32-bit output"
+#endif
+
+/* Rows are generated in segments of this many output pixels, which are then clamped & converted to RGB in one pass */
+enum { nes_ntsc_raw_row_size = 64 * nes_ntsc_out_chunk };
+
+/* Same as NES_NTSC_RGB_OUT, but outputs the unclamped value (clamping is done by ntsc_output_row) */
+#define NES_NTSC_UNCLAMPED_OUT( x, raw_out ) {\
+	raw_out =\
+		kernel0  [x       ] + kernel1  [(x+12)%7+14] + kernel2  [(x+10)%7+28] +\
+		kernelx0 [(x+7)%14] + kernelx1 [(x+ 5)%7+21] + kernelx2 [(x+ 3)%7+35];\
+}
+
+#define NES_NTSC_FLUSH_ROW( shift, alpha ) {\
+	int count_ = (int) (line_out - raw_row);\
+	ntsc_output_row( raw_row, out_row, count_, (shift), (alpha) );\
+	out_row += count_;\
+	line_out = raw_row;\
+}
+
 void nes_ntsc_blit( nes_ntsc_t const* ntsc, NES_NTSC_IN_T const* input, long in_row_width,
 		int burst_phase, int in_width, int in_height, void* rgb_out, long out_pitch )
 {
@@ -244,7 +267,9 @@ void nes_ntsc_blit( nes_ntsc_t const* ntsc, NES_NTSC_IN_T const* input, long in_
 		NES_NTSC_IN_T const* line_in = input;
 		NES_NTSC_BEGIN_ROW( ntsc, burst_phase,
 				nes_ntsc_black, nes_ntsc_black, NES_NTSC_ADJ_IN( *line_in ) );
-		nes_ntsc_out_t* restrict line_out = (nes_ntsc_out_t*) rgb_out;
+		nes_ntsc_out_t* out_row = (nes_ntsc_out_t*) rgb_out;
+		nes_ntsc_rgb_t raw_row [nes_ntsc_raw_row_size];
+		nes_ntsc_rgb_t* restrict line_out = raw_row;
 		int n;
 		++line_in;
 		
@@ -252,35 +277,40 @@ void nes_ntsc_blit( nes_ntsc_t const* ntsc, NES_NTSC_IN_T const* input, long in_
 		{
 			/* order of input and output pixels must not be altered */
 			NES_NTSC_COLOR_IN( 0, NES_NTSC_ADJ_IN( line_in [0] ) );
-			NES_NTSC_RGB_OUT( 0, line_out [0], NES_NTSC_OUT_DEPTH );
-			NES_NTSC_RGB_OUT( 1, line_out [1], NES_NTSC_OUT_DEPTH );
+			NES_NTSC_UNCLAMPED_OUT( 0, line_out [0] );
+			NES_NTSC_UNCLAMPED_OUT( 1, line_out [1] );
 			
 			NES_NTSC_COLOR_IN( 1, NES_NTSC_ADJ_IN( line_in [1] ) );
-			NES_NTSC_RGB_OUT( 2, line_out [2], NES_NTSC_OUT_DEPTH );
-			NES_NTSC_RGB_OUT( 3, line_out [3], NES_NTSC_OUT_DEPTH );
+			NES_NTSC_UNCLAMPED_OUT( 2, line_out [2] );
+			NES_NTSC_UNCLAMPED_OUT( 3, line_out [3] );
 			
 			NES_NTSC_COLOR_IN( 2, NES_NTSC_ADJ_IN( line_in [2] ) );
-			NES_NTSC_RGB_OUT( 4, line_out [4], NES_NTSC_OUT_DEPTH );
-			NES_NTSC_RGB_OUT( 5, line_out [5], NES_NTSC_OUT_DEPTH );
-			NES_NTSC_RGB_OUT( 6, line_out [6], NES_NTSC_OUT_DEPTH );
+			NES_NTSC_UNCLAMPED_OUT( 4, line_out [4] );
+			NES_NTSC_UNCLAMPED_OUT( 5, line_out [5] );
+			NES_NTSC_UNCLAMPED_OUT( 6, line_out [6] );
 			
 			line_in  += 3;
 			line_out += 7;
+			if ( line_out == raw_row + nes_ntsc_raw_row_size )
+				NES_NTSC_FLUSH_ROW( 0, 0 );
 		}
 		
 		/* finish final pixels */
 		NES_NTSC_COLOR_IN( 0, nes_ntsc_black );
-		NES_NTSC_RGB_OUT( 0, line_out [0], NES_NTSC_OUT_DEPTH );
-		NES_NTSC_RGB_OUT( 1, line_out [1], NES_NTSC_OUT_DEPTH );
+		NES_NTSC_UNCLAMPED_OUT( 0, line_out [0] );
+		NES_NTSC_UNCLAMPED_OUT( 1, line_out [1] );
 		
 		NES_NTSC_COLOR_IN( 1, nes_ntsc_black );
-		NES_NTSC_RGB_OUT( 2, line_out [2], NES_NTSC_OUT_DEPTH );
-		NES_NTSC_RGB_OUT( 3, line_out [3], NES_NTSC_OUT_DEPTH );
+		NES_NTSC_UNCLAMPED_OUT( 2, line_out [2] );
+		NES_NTSC_UNCLAMPED_OUT( 3, line_out [3] );
 		
 		NES_NTSC_COLOR_IN( 2, nes_ntsc_black );
-		NES_NTSC_RGB_OUT( 4, line_out [4], NES_NTSC_OUT_DEPTH );
-		NES_NTSC_RGB_OUT( 5, line_out [5], NES_NTSC_OUT_DEPTH );
-		NES_NTSC_RGB_OUT( 6, line_out [6], NES_NTSC_OUT_DEPTH );
+		NES_NTSC_UNCLAMPED_OUT( 4, line_out [4] );
+		NES_NTSC_UNCLAMPED_OUT( 5, line_out [5] );
+		NES_NTSC_UNCLAMPED_OUT( 6, line_out [6] );
+		
+		line_out += 7;
+		NES_NTSC_FLUSH_ROW( 0, 0 );
 		
 		burst_phase = (burst_phase + 1) % nes_ntsc_burst_count;
 		input += in_row_width;
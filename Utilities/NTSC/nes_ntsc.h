@@ -11,6 +11,7 @@
     #define EXPORT 
 #endif 
 
+#include <stdint.h>
 #include "nes_ntsc_config.h"
 
 #ifdef __cplusplus
@@ -114,7 +115,8 @@ statement in a block (unless you're using C++). */
 
 /* private */
 enum { nes_ntsc_entry_size = 128 };
-typedef unsigned long nes_ntsc_rgb_t;
+/* 32-bit on all platforms - unsigned long is 64-bit on Linux/macOS, which doubled the table's size */
+typedef uint32_t nes_ntsc_rgb_t;
 struct nes_ntsc_t {
 	nes_ntsc_rgb_t table [nes_ntsc_palette_size] [nes_ntsc_entry_size];
 };
@@ -0,0 +1,91 @@
+/* Clamping & packing of a row of raw NTSC output values (shared by nes_ntsc and snes_ntsc) */
+#ifndef NTSC_ROW_H
+#define NTSC_ROW_H
+
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define NTSC_ROW_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+	#define NTSC_ROW_NEON 1
+	#include <arm_neon.h>
+#endif
+
+enum {
+	ntsc_row_builder = (1 << 21) | (1 << 11) | (1 << 1),
+	ntsc_row_clamp_mask = ntsc_row_builder * 3 / 2,
+	ntsc_row_clamp_add = ntsc_row_builder * 0x101
+};
+
+/* Clamps each raw value (same as the *_NTSC_CLAMP_ macros) and converts it to 32-bit RGB.
+Uses SSE2/NEON when available - the output is identical to the scalar code. */
+static inline void ntsc_output_row( uint32_t const* raw, uint32_t* out, int count, int shift, uint32_t alpha )
+{
+	int i = 0;
+#if NTSC_ROW_SSE2
+	__m128i const clamp_shift = _mm_cvtsi32_si128( 9 - shift );
+	__m128i const r_shift = _mm_cvtsi32_si128( 5 - shift );
+	__m128i const g_shift = _mm_cvtsi32_si128( 3 - shift );
+	__m128i const b_shift = _mm_cvtsi32_si128( 1 - shift );
+	__m128i const clamp_mask = _mm_set1_epi32( ntsc_row_clamp_mask );
+	__m128i const clamp_add = _mm_set1_epi32( ntsc_row_clamp_add );
+	__m128i const r_mask = _mm_set1_epi32( 0xFF0000 );
+	__m128i const g_mask = _mm_set1_epi32( 0xFF00 );
+	__m128i const b_mask = _mm_set1_epi32( 0xFF );
+	__m128i const alpha_bits = _mm_set1_epi32( (int) alpha );
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		__m128i io = _mm_loadu_si128( (__m128i const*) (raw + i) );
+		__m128i sub = _mm_and_si128( _mm_srl_epi32( io, clamp_shift ), clamp_mask );
+		__m128i clamp = _mm_sub_epi32( clamp_add, sub );
+		io = _mm_or_si128( io, clamp );
+		clamp = _mm_sub_epi32( clamp, sub );
+		io = _mm_and_si128( io, clamp );
+
+		__m128i rgb = _mm_or_si128(
+			_mm_or_si128( alpha_bits, _mm_and_si128( _mm_srl_epi32( io, r_shift ), r_mask ) ),
+			_mm_or_si128( _mm_and_si128( _mm_srl_epi32( io, g_shift ), g_mask ), _mm_and_si128( _mm_srl_epi32( io, b_shift ), b_mask ) )
+		);
+		_mm_storeu_si128( (__m128i*) (out + i), rgb );
+	}
+#elif NTSC_ROW_NEON
+	int32x4_t const clamp_shift = vdupq_n_s32( shift - 9 );
+	int32x4_t const r_shift = vdupq_n_s32( shift - 5 );
+	int32x4_t const g_shift = vdupq_n_s32( shift - 3 );
+	int32x4_t const b_shift = vdupq_n_s32( shift - 1 );
+	uint32x4_t const clamp_mask = vdupq_n_u32( ntsc_row_clamp_mask );
+	uint32x4_t const clamp_add = vdupq_n_u32( ntsc_row_clamp_add );
+	uint32x4_t const r_mask = vdupq_n_u32( 0xFF0000 );
+	uint32x4_t const g_mask = vdupq_n_u32( 0xFF00 );
+	uint32x4_t const b_mask = vdupq_n_u32( 0xFF );
+	uint32x4_t const alpha_bits = vdupq_n_u32( alpha );
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		uint32x4_t io = vld1q_u32( raw + i );
+		uint32x4_t sub = vandq_u32( vshlq_u32( io, clamp_shift ), clamp_mask );
+		uint32x4_t clamp = vsubq_u32( clamp_add, sub );
+		io = vorrq_u32( io, clamp );
+		clamp = vsubq_u32( clamp, sub );
+		io = vandq_u32( io, clamp );
+
+		uint32x4_t rgb = vorrq_u32(
+			vorrq_u32( alpha_bits, vandq_u32( vshlq_u32( io, r_shift ), r_mask ) ),
+			vorrq_u32( vandq_u32( vshlq_u32( io, g_shift ), g_mask ), vandq_u32( vshlq_u32( io, b_shift ), b_mask ) )
+		);
+		vst1q_u32( out + i, rgb );
+	}
+#endif
+	for ( ; i < count; i++ )
+	{
+		uint32_t io = raw [i];
+		uint32_t sub = io >> (9 - shift) & ntsc_row_clamp_mask;
+		uint32_t clamp = ntsc_row_clamp_add - sub;
+		io |= clamp;
+		clamp -= sub;
+		io &= clamp;
+		out [i] = alpha | (io >> (5 - shift) & 0xFF0000) | (io >> (3 - shift) & 0xFF00) | (io >> (1 - shift) & 0xFF);
+	}
+}
+
+#endif
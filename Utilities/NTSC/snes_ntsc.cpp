@@ -130,6 +130,38 @@ void snes_ntsc_init( snes_ntsc_t* ntsc, snes_ntsc_setup_t const* setup )
 
 #ifndef SNES_NTSC_NO_BLITTERS
 
+#include "ntsc_row.h"
+
+#if SNES_NTSC_OUT_DEPTH != 32 && SNES_NTSC_OUT_DEPTH != 24
+	#error "The blitters only support 32-bit output"
+#endif
+
+/* Rows are generated in segments of this many output pixels, which are then clamped & converted to RGB in one pass */
+enum { snes_ntsc_raw_row_size = 64 * snes_ntsc_out_chunk };
+
+/* Same as SNES_NTSC_RGB_OUT, but outputs the unclamped value (clamping is done by ntsc_output_row) */
+#define SNES_NTSC_UNCLAMPED_OUT( x, raw_out ) {\
+	raw_out =\
+		kernel0  [x       ] + kernel1  [(x+12)%7+14] + kernel2  [(x+10)%7+28] +\
+		kernelx0 [(x+7)%14] + kernelx1 [(x+ 5)%7+21] + kernelx2 [(x+ 3)%7+35];\
+}
+
+/* Same as SNES_NTSC_HIRES_OUT, but outputs the unclamped value */
+#define SNES_NTSC_HIRES_UNCLAMPED_OUT( x, raw_out ) {\
+	raw_out =\
+		kernel0  [ x       ] + kernel2  [(x+5)%7+14] + kernel4  [(x+3)%7+28] +\
+		kernelx0 [(x+7)%7+7] + kernelx2 [(x+5)%7+21] + kernelx4 [(x+3)%7+35] +\
+		kernel1  [(x+6)%7  ] + kernel3  [(x+4)%7+14] + kernel5  [(x+2)%7+28] +\
+		kernelx1 [(x+6)%7+7] + kernelx3 [(x+4)%7+21] + kernelx5 [(x+2)%7+35];\
+}
+
+#define SNES_NTSC_FLUSH_ROW( shift, alpha ) {\
+	int count_ = (int) (line_out - raw_row);\
+	ntsc_output_row( raw_row, out_row, count_, (shift), (alpha) );\
+	out_row += count_;\
+	line_out = raw_row;\
+}
+
 void snes_ntsc_blit( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input, long in_row_width,
 		int burst_phase, int in_width, int in_height, void* rgb_out, long out_pitch )
 {
@@ -139,7 +171,9 @@ void snes_ntsc_blit( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input, long
 		SNES_NTSC_IN_T const* line_in = input;
 		SNES_NTSC_BEGIN_ROW( ntsc, burst_phase,
 				snes_ntsc_black, snes_ntsc_black, SNES_NTSC_ADJ_IN( *line_in ) );
-		snes_ntsc_out_t* restrict line_out = (snes_ntsc_out_t*) rgb_out;
+		snes_ntsc_out_t* out_row = (snes_ntsc_out_t*) rgb_out;
+		snes_ntsc_rgb_t raw_row [snes_ntsc_raw_row_size];
+		snes_ntsc_rgb_t* restrict line_out = raw_row;
 		int n;
 		++line_in;
 		
@@ -147,35 +181,40 @@ void snes_ntsc_blit( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input, long
 		{
 			/* order of input and output pixels must not be altered */
 			SNES_NTSC_COLOR_IN( 0, SNES_NTSC_ADJ_IN( line_in [0] ) );
-			SNES_NTSC_RGB_OUT( 0, line_out [0], SNES_NTSC_OUT_DEPTH );
-			SNES_NTSC_RGB_OUT( 1, line_out [1], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_UNCLAMPED_OUT( 0, line_out [0] );
+			SNES_NTSC_UNCLAMPED_OUT( 1, line_out [1] );
 			
 			SNES_NTSC_COLOR_IN( 1, SNES_NTSC_ADJ_IN( line_in [1] ) );
-			SNES_NTSC_RGB_OUT( 2, line_out [2], SNES_NTSC_OUT_DEPTH );
-			SNES_NTSC_RGB_OUT( 3, line_out [3], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_UNCLAMPED_OUT( 2, line_out [2] );
+			SNES_NTSC_UNCLAMPED_OUT( 3, line_out [3] );
 			
 			SNES_NTSC_COLOR_IN( 2, SNES_NTSC_ADJ_IN( line_in [2] ) );
-			SNES_NTSC_RGB_OUT( 4, line_out [4], SNES_NTSC_OUT_DEPTH );
-			SNES_NTSC_RGB_OUT( 5, line_out [5], SNES_NTSC_OUT_DEPTH );
-			SNES_NTSC_RGB_OUT( 6, line_out [6], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_UNCLAMPED_OUT( 4, line_out [4] );
+			SNES_NTSC_UNCLAMPED_OUT( 5, line_out [5] );
+			SNES_NTSC_UNCLAMPED_OUT( 6, line_out [6] );
 			
 			line_in  += 3;
 			line_out += 7;
+			if ( line_out == raw_row + snes_ntsc_raw_row_size )
+				SNES_NTSC_FLUSH_ROW( 1, 0xFF000000 );
 		}
 		
 		/* finish final pixels */
 		SNES_NTSC_COLOR_IN( 0, snes_ntsc_black );
-		SNES_NTSC_RGB_OUT( 0, line_out [0], SNES_NTSC_OUT_DEPTH );
-		SNES_NTSC_RGB_OUT( 1, line_out [1], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_UNCLAMPED_OUT( 0, line_out [0] );
+		SNES_NTSC_UNCLAMPED_OUT( 1, line_out [1] );
 		
 		SNES_NTSC_COLOR_IN( 1, snes_ntsc_black );
-		SNES_NTSC_RGB_OUT( 2, line_out [2], SNES_NTSC_OUT_DEPTH );
-		SNES_NTSC_RGB_OUT( 3, line_out [3], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_UNCLAMPED_OUT( 2, line_out [2] );
+		SNES_NTSC_UNCLAMPED_OUT( 3, line_out [3] );
 		
 		SNES_NTSC_COLOR_IN( 2, snes_ntsc_black );
-		SNES_NTSC_RGB_OUT( 4, line_out [4], SNES_NTSC_OUT_DEPTH );
-		SNES_NTSC_RGB_OUT( 5, line_out [5], SNES_NTSC_OUT_DEPTH );
-		SNES_NTSC_RGB_OUT( 6, line_out [6], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_UNCLAMPED_OUT( 4, line_out [4] );
+		SNES_NTSC_UNCLAMPED_OUT( 5, line_out [5] );
+		SNES_NTSC_UNCLAMPED_OUT( 6, line_out [6] );
+		
+		line_out += 7;
+		SNES_NTSC_FLUSH_ROW( 1, 0xFF000000 );
 		
 		burst_phase = (burst_phase + 1) % snes_ntsc_burst_count;
 		input += in_row_width;
@@ -194,7 +233,9 @@ void snes_ntsc_blit_hires( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input,
 				snes_ntsc_black, snes_ntsc_black, snes_ntsc_black,
 				SNES_NTSC_ADJ_IN( line_in [0] ),
 				SNES_NTSC_ADJ_IN( line_in [1] ) );
-		snes_ntsc_out_t* restrict line_out = (snes_ntsc_out_t*) rgb_out;
+		snes_ntsc_out_t* out_row = (snes_ntsc_out_t*) rgb_out;
+		snes_ntsc_rgb_t raw_row [snes_ntsc_raw_row_size];
+		snes_ntsc_rgb_t* restrict line_out = raw_row;
 		int n;
 		line_in += 2;
 		
@@ -202,46 +243,51 @@ void snes_ntsc_blit_hires( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input,
 		{
 			/* twice as many input pixels per chunk */
 			SNES_NTSC_COLOR_IN( 0, SNES_NTSC_ADJ_IN( line_in [0] ) );
-			SNES_NTSC_HIRES_OUT( 0, line_out [0], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_HIRES_UNCLAMPED_OUT( 0, line_out [0] );
 			
 			SNES_NTSC_COLOR_IN( 1, SNES_NTSC_ADJ_IN( line_in [1] ) );
-			SNES_NTSC_HIRES_OUT( 1, line_out [1], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_HIRES_UNCLAMPED_OUT( 1, line_out [1] );
 			
 			SNES_NTSC_COLOR_IN( 2, SNES_NTSC_ADJ_IN( line_in [2] ) );
-			SNES_NTSC_HIRES_OUT( 2, line_out [2], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_HIRES_UNCLAMPED_OUT( 2, line_out [2] );
 			
 			SNES_NTSC_COLOR_IN( 3, SNES_NTSC_ADJ_IN( line_in [3] ) );
-			SNES_NTSC_HIRES_OUT( 3, line_out [3], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_HIRES_UNCLAMPED_OUT( 3, line_out [3] );
 			
 			SNES_NTSC_COLOR_IN( 4, SNES_NTSC_ADJ_IN( line_in [4] ) );
-			SNES_NTSC_HIRES_OUT( 4, line_out [4], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_HIRES_UNCLAMPED_OUT( 4, line_out [4] );
 			
 			SNES_NTSC_COLOR_IN( 5, SNES_NTSC_ADJ_IN( line_in [5] ) );
-			SNES_NTSC_HIRES_OUT( 5, line_out [5], SNES_NTSC_OUT_DEPTH );
-			SNES_NTSC_HIRES_OUT( 6, line_out [6], SNES_NTSC_OUT_DEPTH );
+			SNES_NTSC_HIRES_UNCLAMPED_OUT( 5, line_out [5] );
+			SNES_NTSC_HIRES_UNCLAMPED_OUT( 6, line_out [6] );
 			
 			line_in  += 6;
 			line_out += 7;
+			if ( line_out == raw_row + snes_ntsc_raw_row_size )
+				SNES_NTSC_FLUSH_ROW( 0, 0xFF000000 );
 		}
 		
 		SNES_NTSC_COLOR_IN( 0, snes_ntsc_black );
-		SNES_NTSC_HIRES_OUT( 0, line_out [0], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_HIRES_UNCLAMPED_OUT( 0, line_out [0] );
 		
 		SNES_NTSC_COLOR_IN( 1, snes_ntsc_black );
-		SNES_NTSC_HIRES_OUT( 1, line_out [1], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_HIRES_UNCLAMPED_OUT( 1, line_out [1] );
 		
 		SNES_NTSC_COLOR_IN( 2, snes_ntsc_black );
-		SNES_NTSC_HIRES_OUT( 2, line_out [2], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_HIRES_UNCLAMPED_OUT( 2, line_out [2] );
 		
 		SNES_NTSC_COLOR_IN( 3, snes_ntsc_black );
-		SNES_NTSC_HIRES_OUT( 3, line_out [3], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_HIRES_UNCLAMPED_OUT( 3, line_out [3] );
 		
 		SNES_NTSC_COLOR_IN( 4, snes_ntsc_black );
-		SNES_NTSC_HIRES_OUT( 4, line_out [4], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_HIRES_UNCLAMPED_OUT( 4, line_out [4] );
 		
 		SNES_NTSC_COLOR_IN( 5, snes_ntsc_black );
-		SNES_NTSC_HIRES_OUT( 5, line_out [5], SNES_NTSC_OUT_DEPTH );
-		SNES_NTSC_HIRES_OUT( 6, line_out [6], SNES_NTSC_OUT_DEPTH );
+		SNES_NTSC_HIRES_UNCLAMPED_OUT( 5, line_out [5] );
+		SNES_NTSC_HIRES_UNCLAMPED_OUT( 6, line_out [6] );
+		
+		line_out += 7;
+		SNES_NTSC_FLUSH_ROW( 0, 0xFF000000 );
 		
 		burst_phase = (burst_phase + 1) % snes_ntsc_burst_count;
 		input += in_row_width;
@@ -4,6 +4,7 @@
 #ifndef SNES_NTSC_H
 #define SNES_NTSC_H
 
+#include <stdint.h>
 #include "snes_ntsc_config.h"
 
 #ifdef __cplusplus
@@ -133,7 +134,8 @@ statement in a block (unless you're using C++). */
 /* private */
 enum { snes_ntsc_entry_size = 128 };
 enum { snes_ntsc_palette_size = 0x2000 };
-typedef unsigned long snes_ntsc_rgb_t;
+/* 32-bit on all platforms - unsigned long is 64-bit on Linux/macOS, which doubled the table's size */
+typedef uint32_t snes_ntsc_rgb_t;
 struct snes_ntsc_t {
 	snes_ntsc_rgb_t table [snes_ntsc_palette_size] [snes_ntsc_entry_size];
 };
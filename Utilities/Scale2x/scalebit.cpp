@@ -471,3 +471,39 @@ void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_
 	}
 }
 
+
+/**
+ * Apply the Scale2x or Scale3x effect on a slice of rows of a bitmap.
+ * Each row is processed independently, so multiple threads can process
+ * separate slices of the same bitmap at the same time.
+ * The output is identical to calling ::scale() on the whole bitmap.
+ * \param scale Scale factor. 2 or 3 (Scale4x can be done with 2 Scale2x passes).
+ * \param y_first First source row to process.
+ * \param y_last Row after the last source row to process.
+ * Other parameters are the same as for ::scale().
+ */
+void scale_slice(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, unsigned y_first, unsigned y_last)
+{
+	const unsigned char* src = (const unsigned char*)void_src;
+	unsigned y;
+
+	if (y_last > height)
+		y_last = height;
+
+	for (y = y_first; y < y_last; ++y) {
+		/* the rows above/below the image's edges are replaced by the edge itself, like scale() does */
+		const unsigned char* src0 = src + (y > 0 ? y - 1 : 0) * src_slice;
+		const unsigned char* src1 = src + y * src_slice;
+		const unsigned char* src2 = src + (y + 1 < height ? y + 1 : y) * src_slice;
+		unsigned char* dst = (unsigned char*)void_dst + y * scale * dst_slice;
+
+		switch (scale) {
+		case 2 :
+			stage_scale2x(dst, dst + dst_slice, src0, src1, src2, pixel, width);
+			break;
+		case 3 :
+			stage_scale3x(dst, dst + dst_slice, dst + 2 * dst_slice, src0, src1, src2, pixel, width);
+			break;
+		}
+	}
+}
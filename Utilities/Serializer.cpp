@@ -14,10 +14,98 @@ Serializer::Serializer(uint32_t version, bool forSave, SerializeFormat format)
 			case SerializeFormat::Binary: _data.reserve(0x50000); break;
 			case SerializeFormat::Map: _mapValues.reserve(500); break;
 			case SerializeFormat::Text: _values.reserve(500); break;
+			case SerializeFormat::Raw:
+				//Reserve space for the header, it is written in SaveTo once all fields are known
+				_data.reserve(0x50000);
+				_data.resize(Serializer::RawHeaderSize);
+				break;
 		}
 	}
 }
 
+Serializer::Serializer(uint32_t version, bool forSave, SerializeFormat format, vector<uint8_t>& buffer)
+{
+	if(format != SerializeFormat::Raw) {
+		throw std::runtime_error("unsupported format");
+	}
+
+	_version = version;
+	_saving = forSave;
+	_format = format;
+	_externalBuffer = &buffer;
+	_data.swap(buffer);
+
+	if(forSave) {
+		_data.clear();
+		_data.resize(Serializer::RawHeaderSize);
+	} else {
+		_rawValid = LoadRawHeader();
+	}
+}
+
+Serializer::~Serializer()
+{
+	if(_externalBuffer) {
+		if(_saving) {
+			WriteRawHeader();
+		}
+		_data.swap(*_externalBuffer);
+	}
+}
+
+bool Serializer::IsValid()
+{
+	if(_format == SerializeFormat::Raw) {
+		return _rawValid;
+	}
+	return _values.size() > 0;
+}
+
+bool Serializer::LoadRawHeader()
+{
+	if(_data.size() < Serializer::RawHeaderSize) {
+		return false;
+	}
+
+	uint32_t header[3];
+	memcpy(header, _data.data(), sizeof(header));
+	if(header[0] != Serializer::RawSignature) {
+		return false;
+	}
+
+	_rawPos = Serializer::RawHeaderSize;
+	_rawValid = true;
+	return true;
+}
+
+void Serializer::WriteRawHeader()
+{
+	uint32_t header[3] = { Serializer::RawSignature, _rawFieldCount, _rawSchemaHash };
+	memcpy(_data.data(), header, sizeof(header));
+}
+
+bool Serializer::ValidateRawSchema()
+{
+	if(_format != SerializeFormat::Raw || _data.size() < Serializer::RawHeaderSize) {
+		return false;
+	}
+
+	uint32_t header[3];
+	memcpy(header, _data.data(), sizeof(header));
+	return _rawValid && _rawPos == _data.size() && header[1] == _rawFieldCount && header[2] == _rawSchemaHash;
+}
+
+uint64_t Serializer::GetRawHeaderSchema()
+{
+	if(_format != SerializeFormat::Raw || !_rawValid || _data.size() < Serializer::RawHeaderSize) {
+		return 0;
+	}
+
+	uint32_t header[3];
+	memcpy(header, _data.data(), sizeof(header));
+	return ((uint64_t)header[1] << 32) | header[2];
+}
+
 void Serializer::AddKeyPrefix(string prefix)
 {
 	vector<string> keys;
@@ -106,6 +194,10 @@ bool Serializer::LoadFrom(istream &file)
 		file.read((char*)_data.data(), stateSize);
 	}
 
+	if(_format == SerializeFormat::Raw) {
+		return LoadRawHeader();
+	}
+
 	uint32_t size = (uint32_t)_data.size();
 	uint32_t i = 0;
 	string key;
@@ -209,6 +301,10 @@ void Serializer::SaveTo(ostream& file, int compressionLevel)
 	if(_format == SerializeFormat::Text) {
 		file.write((char*)_data.data(), _data.size());
 	} else {
+		if(_format == SerializeFormat::Raw) {
+			WriteRawHeader();
+		}
+
 		bool isCompressed = compressionLevel > 0;
 		file.put((char)isCompressed);
 
@@ -269,12 +365,19 @@ string Serializer::NormalizeName(const char* name, int index)
 
 void Serializer::PushNamePrefix(const char* name, int index)
 {
+	if(_format == SerializeFormat::Raw) {
+		//Keys are not used in raw format
+		return;
+	}
 	_prefixes.push_back(NormalizeName(name, index));
 	UpdatePrefix();
 }
 
 void Serializer::PopNamePrefix()
 {
+	if(_format == SerializeFormat::Raw) {
+		return;
+	}
 	_prefixes.pop_back();
 	UpdatePrefix();
 }
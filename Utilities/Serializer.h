@@ -66,7 +66,11 @@ enum class SerializeFormat
 {
 	Binary,
 	Text,
-	Map
+	Map,
+
+	//In-memory only format (run-ahead, step back, etc.) - values are written in the order they are
+	//streamed, without any keys. The state can only be loaded by the same build/console that created it.
+	Raw
 };
 
 class Serializer
@@ -86,6 +90,18 @@ private:
 	bool _saving = false;
 	SerializeFormat _format = SerializeFormat::Binary;
 
+	//Raw format state - the schema hash is a hash of the size of every field, in the order they
+	//were streamed, and is used to validate that a raw state matches the layout of the console loading it
+	static constexpr uint32_t RawHeaderSize = 12;
+	static constexpr uint32_t RawSignature = 0x5741524D; //"MRAW"
+	uint32_t _rawPos = 0;
+	uint32_t _rawFieldCount = 0;
+	uint32_t _rawSchemaHash = 0x811C9DC5;
+	bool _rawValid = true;
+
+	//When set, _data uses this buffer's memory and is given back to it when the serializer is destroyed
+	vector<uint8_t>* _externalBuffer = nullptr;
+
 private:
 	bool LoadFromTextFormat(istream& file);
 	string NormalizeName(const char* name, int index);
@@ -203,6 +219,66 @@ private:
 		}
 	}
 
+	__forceinline void UpdateSchemaHash(uint32_t fieldSize)
+	{
+		_rawFieldCount++;
+		_rawSchemaHash = (_rawSchemaHash ^ fieldSize) * 0x01000193;
+	}
+
+	template<typename T>
+	__forceinline void StreamRawValue(T& value)
+	{
+		UpdateSchemaHash((uint32_t)sizeof(T));
+		if(_saving) {
+			size_t pos = _data.size();
+			_data.resize(pos + sizeof(T));
+			memcpy(_data.data() + pos, &value, sizeof(T));
+		} else if(_rawPos + sizeof(T) <= _data.size()) {
+			memcpy(&value, _data.data() + _rawPos, sizeof(T));
+			_rawPos += sizeof(T);
+		} else {
+			_rawValid = false;
+		}
+	}
+
+	//Variable-size blocks (arrays, vectors, strings) are prefixed with their size, in bytes
+	__forceinline void WriteRawBlock(const void* src, uint32_t size, uint32_t elementSize)
+	{
+		UpdateSchemaHash(elementSize | 0x80000000);
+		size_t pos = _data.size();
+		_data.resize(pos + sizeof(uint32_t) + size);
+		memcpy(_data.data() + pos, &size, sizeof(uint32_t));
+		if(size) {
+			memcpy(_data.data() + pos + sizeof(uint32_t), src, size);
+		}
+	}
+
+	__forceinline uint8_t* ReadRawBlock(uint32_t& size, uint32_t elementSize)
+	{
+		UpdateSchemaHash(elementSize | 0x80000000);
+		size = 0;
+		if(_rawPos + sizeof(uint32_t) > _data.size()) {
+			_rawValid = false;
+			return nullptr;
+		}
+
+		uint32_t blockSize;
+		memcpy(&blockSize, _data.data() + _rawPos, sizeof(uint32_t));
+		_rawPos += sizeof(uint32_t);
+		if(_rawPos + blockSize > _data.size()) {
+			_rawValid = false;
+			return nullptr;
+		}
+
+		uint8_t* ptr = _data.data() + _rawPos;
+		_rawPos += blockSize;
+		size = blockSize;
+		return ptr;
+	}
+
+	bool LoadRawHeader();
+	void WriteRawHeader();
+
 	__forceinline void CheckDuplicateKey(string& key)
 	{
 #ifndef MESENRELEASE
@@ -215,13 +291,25 @@ private:
 public:
 	Serializer(uint32_t version, bool forSave, SerializeFormat format = SerializeFormat::Binary);
 
+	//Raw format only - saves to/loads from the buffer directly, without any copies or stream operations.
+	//Once the buffer has grown to the size of a state, saving a state no longer allocates any memory.
+	Serializer(uint32_t version, bool forSave, SerializeFormat format, vector<uint8_t>& buffer);
+	~Serializer();
+
 	uint32_t GetVersion() { return _version; }
 	bool IsSaving() { return _saving; }
 	
 	SerializeFormat GetFormat() { return _format; }
 	unordered_map<string, SerializeMapValue>& GetMapValues() { return _mapValues; }
 
-	bool IsValid() { return _values.size() > 0; }
+	bool IsValid();
+	
+	//Returns true if all the fields of a raw state were read and the state's layout matches the loading console's
+	bool ValidateRawSchema();
+	//Layout of the fields streamed so far (field count + schema hash)
+	uint64_t GetRawSchema() { return ((uint64_t)_rawFieldCount << 32) | _rawSchemaHash; }
+	//Layout stored in the header of the raw state being loaded (0 if the header is invalid)
+	uint64_t GetRawHeaderSchema();
 	void AddKeyPrefix(string prefix);
 	void RemoveKeyPrefix(string prefix);
 	void RemoveKeys(vector<string>& keys);
@@ -241,6 +329,8 @@ public:
 		
 		if constexpr(std::is_base_of<ISerializable, T>::value) {
 			Stream((ISerializable&)value, name, index);
+		} else if(_format == SerializeFormat::Raw) {
+			StreamRawValue(value);
 		} else {
 			string key = GetKey(name, index);
 
@@ -262,6 +352,7 @@ public:
 
 					case SerializeFormat::Text: WriteTextFormat(key, value); break;
 					case SerializeFormat::Map: WriteMapFormat(key, value); break;
+					case SerializeFormat::Raw: break; //Handled above
 				}
 			} else {
 				switch(_format) {
@@ -295,6 +386,8 @@ public:
 					case SerializeFormat::Map:
 						ReadMapFormat(key, value);
 						break;
+
+					case SerializeFormat::Raw: break; //Handled above
 				}
 			}
 		}
@@ -343,6 +436,17 @@ public:
 	{
 		if(_format == SerializeFormat::Map) {
 			return;
+		} else if(_format == SerializeFormat::Raw) {
+			if(_saving) {
+				WriteRawBlock(arrayValues, elementCount * sizeof(T), sizeof(T));
+			} else {
+				uint32_t size;
+				uint8_t* src = ReadRawBlock(size, sizeof(T));
+				if(src) {
+					memcpy(arrayValues, src, std::min<uint32_t>(size, sizeof(T) * elementCount));
+				}
+			}
+			return;
 		}
 
 		string key = GetKey(name, -1);
@@ -392,6 +496,20 @@ public:
 	{
 		if(_format == SerializeFormat::Map) {
 			return;
+		} else if(_format == SerializeFormat::Raw) {
+			if(_saving) {
+				WriteRawBlock(values.data(), (uint32_t)(values.size() * sizeof(T)), sizeof(T));
+			} else {
+				uint32_t size;
+				uint8_t* src = ReadRawBlock(size, sizeof(T));
+				if(src) {
+					values.resize(size / sizeof(T));
+					if(values.size()) {
+						memcpy(values.data(), src, values.size() * sizeof(T));
+					}
+				}
+			}
+			return;
 		}
 
 		string key = GetKey(name, index);
@@ -438,6 +556,19 @@ public:
 
 template<> inline void Serializer::Stream(string& value, const char* name, int index)
 {
+	if(_format == SerializeFormat::Raw) {
+		if(_saving) {
+			WriteRawBlock(value.data(), (uint32_t)value.size(), 1);
+		} else {
+			uint32_t size;
+			uint8_t* src = ReadRawBlock(size, 1);
+			if(src) {
+				value = string(src, src + size);
+			}
+		}
+		return;
+	}
+
 	string key = GetKey(name, index);
 
 	CheckDuplicateKey(key);
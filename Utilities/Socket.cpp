@@ -244,6 +244,35 @@ int Socket::Send(char *buf, int len, int flags)
 	return returnVal;
 }
 
+void Socket::BufferedSend(char *buf, int len)
+{
+	_sendBuffer.insert(_sendBuffer.end(), buf, buf + len);
+}
+
+void Socket::SendBuffer()
+{
+	size_t sent = 0;
+	while(sent < _sendBuffer.size() && !_connectionError) {
+		int returnVal = send(_socket, (char*)_sendBuffer.data() + sent, (int)(_sendBuffer.size() - sent), 0);
+		if(returnVal > 0) {
+			sent += returnVal;
+		} else {
+			if(returnVal == SOCKET_ERROR) {
+				int nError = WSAGetLastError();
+				if(nError != 0 && !WouldBlock(nError)) {
+					SetConnectionErrorFlag();
+				}
+			}
+			//Socket's send buffer is full, the rest will be sent once the socket is writable again
+			break;
+		}
+	}
+
+	if(sent > 0) {
+		_sendBuffer.erase(_sendBuffer.begin(), _sendBuffer.begin() + sent);
+	}
+}
+
 int Socket::Recv(char *buf, int len, int flags)
 {
 	int returnVal = recv(_socket, buf, len, flags);
@@ -12,6 +12,7 @@ private:
 	uintptr_t _socket = (uintptr_t)~0;
 	bool _connectionError = false;
 	int32_t _UPnPPort = -1;
+	vector<uint8_t> _sendBuffer;
 
 public:
 	Socket();
@@ -29,8 +30,15 @@ public:
 	void Listen(int backlog);
 	unique_ptr<Socket> Accept();
 
+	uintptr_t GetHandle() { return _socket; }
+
 	int Send(char *buf, int len, int flags);
+
+	//Queues data to be sent by SendBuffer (does not block)
 	void BufferedSend(char *buf, int len);
+	//Sends as much of the queued data as the socket accepts without blocking
 	void SendBuffer();
+	size_t GetBufferedSize() { return _sendBuffer.size(); }
+
 	int Recv(char *buf, int len, int flags);
 };
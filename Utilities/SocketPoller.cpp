@@ -0,0 +1,162 @@
+#include "pch.h"
+#include <thread>
+#include "Utilities/SocketPoller.h"
+#include "Utilities/Socket.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <winsock2.h>
+	#include <Ws2tcpip.h>
+	#include <Windows.h>
+
+	typedef WSAPOLLFD PollFd;
+	#define poll WSAPoll
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <arpa/inet.h>
+	#include <poll.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	typedef pollfd PollFd;
+	#define INVALID_SOCKET (uintptr_t)-1
+	#define SOCKET_ERROR -1
+	#define SOCKADDR_IN sockaddr_in
+	#define SOCKADDR sockaddr
+	#define closesocket close
+#endif
+
+SocketPoller::SocketPoller()
+{
+	_wakePending = false;
+
+	#ifdef _WIN32
+		WSADATA wsaDat;
+		if(WSAStartup(MAKEWORD(2, 2), &wsaDat) != 0) {
+			return;
+		}
+		_cleanupWSA = true;
+	#endif
+
+	InitWakeSocket();
+}
+
+SocketPoller::~SocketPoller()
+{
+	if(_wakeSocket != INVALID_SOCKET) {
+		closesocket(_wakeSocket);
+	}
+
+	#ifdef _WIN32
+		if(_cleanupWSA) {
+			WSACleanup();
+		}
+	#endif
+}
+
+void SocketPoller::InitWakeSocket()
+{
+	uintptr_t wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if(wakeSocket == INVALID_SOCKET) {
+		return;
+	}
+
+	SOCKADDR_IN addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+
+	socklen_t addrSize = sizeof(addr);
+	bool result = (
+		::bind(wakeSocket, (SOCKADDR*)&addr, sizeof(addr)) != SOCKET_ERROR &&
+		getsockname(wakeSocket, (SOCKADDR*)&addr, &addrSize) != SOCKET_ERROR &&
+		connect(wakeSocket, (SOCKADDR*)&addr, sizeof(addr)) != SOCKET_ERROR
+	);
+
+	if(!result) {
+		closesocket(wakeSocket);
+		return;
+	}
+
+	//Non-blocking, to be able to empty the socket without waiting
+	#ifdef _WIN32
+		u_long iMode = 1;
+		ioctlsocket(wakeSocket, FIONBIO, &iMode);
+	#else
+		fcntl((int)wakeSocket, F_SETFL, fcntl((int)wakeSocket, F_GETFL, 0) | O_NONBLOCK);
+	#endif
+
+	_wakeSocket = wakeSocket;
+}
+
+void SocketPoller::Clear()
+{
+	_entries.clear();
+}
+
+size_t SocketPoller::Add(Socket* socket, bool checkWrite)
+{
+	_entries.push_back({ socket->GetHandle(), checkWrite, false, false });
+	return _entries.size() - 1;
+}
+
+bool SocketPoller::Wait(int timeoutMs)
+{
+	if(_wakeSocket == INVALID_SOCKET) {
+		//Could not create the wake socket, fall back to polling
+		std::this_thread::sleep_for(std::chrono::duration<int, std::milli>(1));
+		for(PollEntry& entry : _entries) {
+			entry.Readable = true;
+			entry.Writable = entry.CheckWrite;
+		}
+		return true;
+	}
+
+	vector<PollFd> fds;
+	fds.reserve(_entries.size() + 1);
+	for(PollEntry& entry : _entries) {
+		PollFd fd = {};
+		fd.fd = (decltype(fd.fd))entry.Handle;
+		fd.events = POLLIN | (entry.CheckWrite ? POLLOUT : 0);
+		fds.push_back(fd);
+	}
+
+	PollFd wakeFd = {};
+	wakeFd.fd = (decltype(wakeFd.fd))_wakeSocket;
+	wakeFd.events = POLLIN;
+	fds.push_back(wakeFd);
+
+	if(_wakePending) {
+		//Wake() was called since the last call, don't wait
+		timeoutMs = 0;
+	}
+
+	int result = poll(fds.data(), (uint32_t)fds.size(), timeoutMs);
+
+	//Reset the flag before emptying the socket - the caller processes its events after this returns,
+	//so calls to Wake() made after this point are never lost
+	_wakePending = false;
+	if(fds.back().revents & POLLIN) {
+		char buffer[64];
+		while(recv(_wakeSocket, buffer, sizeof(buffer), 0) > 0) {
+		}
+	}
+
+	for(size_t i = 0; i < _entries.size(); i++) {
+		//Errors/disconnections are reported as readable, Recv() will then flag the socket as closed
+		_entries[i].Readable = (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+		_entries[i].Writable = (fds[i].revents & POLLOUT) != 0;
+	}
+
+	return result > 0;
+}
+
+void SocketPoller::Wake()
+{
+	if(_wakeSocket != INVALID_SOCKET && !_wakePending.exchange(true)) {
+		char value = 0;
+		send(_wakeSocket, &value, 1, 0);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "pch.h"
+
+class Socket;
+
+//Waits until one of the sockets can be read from (or written to), or until Wake() is called from another thread
+class SocketPoller
+{
+private:
+	struct PollEntry
+	{
+		uintptr_t Handle;
+		bool CheckWrite;
+		bool Readable;
+		bool Writable;
+	};
+
+	#ifdef _WIN32
+	bool _cleanupWSA = false;
+	#endif
+
+	//UDP socket connected to itself - Wake() sends a byte to it, to interrupt Wait()
+	uintptr_t _wakeSocket = (uintptr_t)~0;
+	atomic<bool> _wakePending;
+
+	vector<PollEntry> _entries;
+
+	void InitWakeSocket();
+
+public:
+	SocketPoller();
+	~SocketPoller();
+
+	void Clear();
+	size_t Add(Socket* socket, bool checkWrite);
+
+	//Returns false if the timeout expired without any event
+	bool Wait(int timeoutMs);
+	void Wake();
+
+	bool IsReadable(size_t index) { return _entries[index].Readable; }
+	bool IsWritable(size_t index) { return _entries[index].Writable; }
+};
@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+	//The thread calling ParallelFor also processes work, so it counts as one of the threads
+	for(uint32_t i = 1; i < threadCount; i++) {
+		_threads.emplace_back(&ThreadPool::WorkerThread, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_stopFlag = true;
+	}
+	_signal.notify_all();
+
+	for(std::thread& thread : _threads) {
+		thread.join();
+	}
+}
+
+uint32_t ThreadPool::GetDefaultThreadCount()
+{
+	//Leave a core for the emulation thread
+	uint32_t coreCount = std::thread::hardware_concurrency();
+	return std::max<uint32_t>(1, std::min<uint32_t>(coreCount > 1 ? coreCount - 1 : 1, 16));
+}
+
+uint32_t ThreadPool::GetThreadCount()
+{
+	return (uint32_t)_threads.size() + 1;
+}
+
+void ThreadPool::WorkerThread()
+{
+	while(true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_signal.wait(lock, [this] { return _stopFlag || !_tasks.empty(); });
+			if(_tasks.empty()) {
+				//Stop flag is set and all tasks are done
+				return;
+			}
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_tasks.push_back(std::move(task));
+	}
+	_signal.notify_one();
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func)
+{
+	if(count == 0) {
+		return;
+	}
+
+	uint32_t helperCount = std::min<uint32_t>((uint32_t)_threads.size(), count - 1);
+	if(helperCount == 0) {
+		for(uint32_t i = 0; i < count; i++) {
+			func(i);
+		}
+		return;
+	}
+
+	atomic<uint32_t> nextIndex(0);
+	uint32_t activeHelpers = helperCount;
+	std::mutex doneMutex;
+	std::condition_variable doneSignal;
+
+	auto processItems = [&]() {
+		uint32_t i;
+		while((i = nextIndex++) < count) {
+			func(i);
+		}
+	};
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		for(uint32_t i = 0; i < helperCount; i++) {
+			_tasks.push_back([&]() {
+				processItems();
+
+				std::unique_lock<std::mutex> doneLock(doneMutex);
+				if(--activeHelpers == 0) {
+					doneSignal.notify_one();
+				}
+			});
+		}
+	}
+	_signal.notify_all();
+
+	processItems();
+
+	//The helper tasks reference this function's locals, wait for all of them to finish
+	std::unique_lock<std::mutex> doneLock(doneMutex);
+	doneSignal.wait(doneLock, [&] { return activeHelpers == 0; });
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+//Persistent pool of worker threads - avoids the cost of creating threads for work that runs every frame
+class ThreadPool
+{
+private:
+	vector<std::thread> _threads;
+	std::deque<std::function<void()>> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _signal;
+	bool _stopFlag = false;
+
+	void WorkerThread();
+
+public:
+	//threadCount is the total number of threads that run tasks, including the caller of ParallelFor
+	ThreadPool(uint32_t threadCount);
+	~ThreadPool();
+
+	//Returns the number of threads that can be used when the setting is set to "automatic" (0)
+	static uint32_t GetDefaultThreadCount();
+
+	uint32_t GetThreadCount();
+
+	void Enqueue(std::function<void()> task);
+
+	//Calls func(i) for each i in [0, count) and returns once all calls are done.
+	//The calling thread also runs some of the calls while waiting for the workers.
+	void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func);
+};